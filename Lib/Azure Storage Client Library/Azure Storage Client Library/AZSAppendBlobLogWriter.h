@@ -0,0 +1,140 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSAppendBlobLogWriter.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+@class AZSCloudAppendBlob;
+@class AZSCloudBlobContainer;
+@class AZSBlobRequestOptions;
+@class AZSOperationContext;
+
+/** The AZSAppendBlobLogWriter ships small log records to append blobs, batching many records into each Append Block request.
+ 
+ Any number of threads may append records concurrently.  appendRecord:error: never takes a lock or waits for the network: records
+ are pushed onto a lock-free queue, and a single background consumer drains it, concatenating queued records into one Append
+ Block request of up to maximumBatchSize bytes.  A batch is sent once maximumBatchSize bytes are queued, once the oldest queued
+ record has waited maximumLatency seconds, or when flushWithCompletionHandler is called.  One Append Block is in flight at a time,
+ so records from any one thread are stored in the order they were appended.  Records are stored exactly as given; include a
+ delimiter, such as a newline, in each record if the log needs to be split up again.
+ 
+ The log is written to a series of append blobs named blobNamePrefix followed by a six-digit index, starting at 000000.  Each
+ Append Block is conditional on the blob's current length and on maximumBlobSize, so the writer rolls over to the next blob
+ when the next batch would not fit, when the blob has maximumBlockCount blocks, or when another writer has grown the blob.  When
+ the writer is opened, or rolls over, it continues appending to the next blob in the series that exists and is not full,
+ creating it if needed.
+ */
+@interface AZSAppendBlobLogWriter : NSObject
+
+/** The container holding the log blobs.*/
+@property (strong, readonly) AZSCloudBlobContainer *container;
+
+/** The prefix of the log blob names.*/
+@property (copy, readonly) NSString *blobNamePrefix;
+
+/** The largest size a log blob is allowed to grow to before the writer rolls over to the next one.*/
+@property (readonly) unsigned long long maximumBlobSize;
+
+/** The largest number of bytes sent in a single Append Block request.  Values above 4 MB, which is the default, are treated as 4 MB, and
+ 0 is treated as 1.  No single record may be larger; lowering this below the size of a record already queued fails the writer.*/
+@property NSUInteger maximumBatchSize;
+
+/** The longest time a record is queued before it is sent, in seconds.  Default is 1 second.*/
+@property NSTimeInterval maximumLatency;
+
+/** The number of blocks a log blob may have before the writer rolls over to the next one.  Default is 50,000, the service limit.*/
+@property NSUInteger maximumBlockCount;
+
+/** The blob currently being appended to.  Nil until the writer has been opened.*/
+@property (strong, readonly, AZSNullable) AZSCloudAppendBlob *currentBlob;
+
+/** The number of bytes queued and not yet appended.*/
+@property (readonly) unsigned long long pendingBytes;
+
+/** The number of records appended to the log so far.*/
+@property (readonly) NSUInteger recordCount;
+
+/** The number of Append Block requests that have succeeded.*/
+@property (readonly) NSUInteger appendCount;
+
+/** The total number of bytes appended.*/
+@property (readonly) unsigned long long bytesAppended;
+
+/** The number of times the writer has rolled over to a new blob.*/
+@property (readonly) NSUInteger rolloverCount;
+
+/** Initializes a newly allocated AZSAppendBlobLogWriter object.
+ 
+ @param container The container holding the log blobs.
+ @param blobNamePrefix The prefix of the log blob names.
+ @param maximumBlobSize The largest size a log blob is allowed to grow to.
+ @param requestOptions The options to use for each request.
+ @param operationContext The operation context to use for each request.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithContainer:(AZSCloudBlobContainer *)container blobNamePrefix:(NSString *)blobNamePrefix maximumBlobSize:(unsigned long long)maximumBlobSize requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext AZS_DESIGNATED_INITIALIZER;
+
+/** Opens the writer.
+ 
+ This finds the first blob in the series that is not full, creating it if it does not exist, and downloads its attributes.
+ 
+ @param completionHandler The block of code to execute when the open call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)openWithCompletionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Queues a record to be appended to the log.
+ 
+ This may be called from any thread.  The data is retained, not copied, so it must not be mutated afterwards.  If an earlier
+ append has failed, the record is rejected with that append's error, and the writer should be discarded.
+ 
+ @param record The record.  Must be no larger than maximumBatchSize.
+ @param error Set to an error describing the failure, if the record was rejected.
+ @returns YES if the record was queued, NO otherwise.
+ */
+-(BOOL)appendRecord:(NSData *)record error:(NSError **)error;
+
+/** Appends all queued records.
+ 
+ The completion handler is called once every record queued before the call has been appended.
+ 
+ @param completionHandler The block of code to execute when the flush completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if every append succeeded, the error from the failed append otherwise.|
+ */
+-(void)flushWithCompletionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Returns a percentile of the flush latency of recently appended records.
+ 
+ The flush latency of a record is the time from when it was queued until the Append Block containing it completed.  The
+ percentile is taken over the last 4096 records appended.
+ 
+ @param percentile The percentile, between 0 and 100.  For example, 50 for the median, or 99.
+ @returns The latency in seconds, or 0 if no records have been appended yet.
+ */
+-(NSTimeInterval)flushLatencyAtPercentile:(double)percentile;
+
+@end
+
+AZS_ASSUME_NONNULL_END
@@ -0,0 +1,521 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSAppendBlobLogWriter.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+#import "AZSAppendBlobLogWriter.h"
+#import "AZSAccessCondition.h"
+#import "AZSBlobProperties.h"
+#import "AZSBlobRequestOptions.h"
+#import "AZSCloudAppendBlob.h"
+#import "AZSCloudBlobClient.h"
+#import "AZSCloudBlobContainer.h"
+#import "AZSConstants.h"
+#import "AZSErrors.h"
+#import "AZSOperationContext.h"
+
+// A queued record.  Producers push these onto a lock-free stack; the consumer takes the whole stack at once, and reverses it to
+// restore queue order.
+typedef struct AZSLogRecordNode
+{
+    struct AZSLogRecordNode *next;
+    const void *record;
+    NSUInteger length;
+    uint64_t queuedTime;
+} AZSLogRecordNode;
+
+static NSUInteger const AZSLogWriterLatencySampleCount = 4096;
+
+// Converts a mach_absolute_time interval to seconds.
+static NSTimeInterval AZSSecondsFromMachTime(uint64_t machTime)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    
+    return (double)machTime * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+static int AZSCompareLatencies(const void *first, const void *second)
+{
+    NSTimeInterval firstLatency = *(const NSTimeInterval *)first;
+    NSTimeInterval secondLatency = *(const NSTimeInterval *)second;
+    return (firstLatency < secondLatency) ? -1 : ((firstLatency > secondLatency) ? 1 : 0);
+}
+
+static void AZSFreeLogRecordNodes(AZSLogRecordNode *node)
+{
+    while (node)
+    {
+        AZSLogRecordNode *next = node->next;
+        CFRelease(node->record);
+        free(node);
+        node = next;
+    }
+}
+
+@interface AZSAppendBlobLogWriter()
+{
+    // Shared between producers and the consumer.
+    _Atomic(AZSLogRecordNode *) _queueHead;
+    atomic_ullong _queuedBytes;
+    atomic_ullong _recordsQueued;
+    atomic_bool _failed;
+    
+    // Only used on the consumer queue.  Records taken from the stack, in queue order, waiting to be appended.
+    AZSLogRecordNode *_pendingHead;
+    AZSLogRecordNode *_pendingTail;
+    
+    NSTimeInterval _latencies[AZSLogWriterLatencySampleCount];
+    NSUInteger _latencyCount;
+}
+
+@property (strong, AZSNullable) AZSCloudAppendBlob *currentBlob;
+@property (strong) AZSBlobRequestOptions *requestOptions;
+@property (strong) AZSOperationContext *operationContext;
+@property (strong) dispatch_queue_t consumerQueue;
+@property BOOL opened;
+@property NSUInteger blobIndex;
+@property unsigned long long blobLength;
+@property NSUInteger blockCount;
+@property BOOL appendInFlight;
+@property unsigned long long recordsAppended;
+@property (strong) NSMutableArray *flushHandlers;
+@property (strong) NSError *writeError;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSAppendBlobLogWriter
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithContainer:(AZSCloudBlobContainer *)container blobNamePrefix:(NSString *)blobNamePrefix maximumBlobSize:(unsigned long long)maximumBlobSize requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext
+{
+    self = [super init];
+    if (self)
+    {
+        _container = container;
+        _blobNamePrefix = [blobNamePrefix copy];
+        _maximumBlobSize = maximumBlobSize;
+        _maximumBatchSize = AZSCMaxBlockSize;
+        _maximumLatency = 1;
+        _maximumBlockCount = 50000;
+        _requestOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:container.client.defaultRequestOptions];
+        _operationContext = operationContext ?: [[AZSOperationContext alloc] init];
+        _consumerQueue = dispatch_queue_create("com.microsoft.azure.storage.appendbloblogwriter", DISPATCH_QUEUE_SERIAL);
+        _flushHandlers = [NSMutableArray array];
+        
+        atomic_init(&_queueHead, NULL);
+        atomic_init(&_queuedBytes, 0);
+        atomic_init(&_recordsQueued, 0);
+        atomic_init(&_failed, false);
+        _pendingHead = NULL;
+        _pendingTail = NULL;
+        _latencyCount = 0;
+    }
+    
+    return self;
+}
+
+-(void)dealloc
+{
+    AZSFreeLogRecordNodes(atomic_exchange(&_queueHead, NULL));
+    AZSFreeLogRecordNodes(_pendingHead);
+}
+
+-(unsigned long long)pendingBytes
+{
+    return atomic_load(&_queuedBytes);
+}
+
+-(NSUInteger)maximumBatchSize
+{
+    return _maximumBatchSize;
+}
+
+-(void)setMaximumBatchSize:(NSUInteger)maximumBatchSize
+{
+    // An Append Block can carry no more than the service maximum, and an empty batch would never make progress.
+    _maximumBatchSize = MAX(MIN(maximumBatchSize, (NSUInteger)AZSCMaxBlockSize), 1);
+}
+
+-(void)openWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    [self attachToBlobAtIndex:0 completionHandler:^(NSError *error) {
+        if (!error)
+        {
+            self.opened = YES;
+        }
+        completionHandler(error);
+    }];
+}
+
+// Makes the first blob in the series, at or after the given index, that is not full the current blob, creating it if needed.
+-(void)attachToBlobAtIndex:(NSUInteger)index completionHandler:(void (^)(NSError *))completionHandler
+{
+    AZSCloudAppendBlob *blob = [self.container appendBlobReferenceFromName:[NSString stringWithFormat:@"%@%06lu", self.blobNamePrefix, (unsigned long)index]];
+    
+    void (^attach)(unsigned long long, NSUInteger) = ^(unsigned long long blobLength, NSUInteger blockCount) {
+        if ((blobLength >= self.maximumBlobSize) || (blockCount >= self.maximumBlockCount))
+        {
+            [self attachToBlobAtIndex:index + 1 completionHandler:completionHandler];
+            return;
+        }
+        
+        [self.operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Appending log records to %@ at offset %llu.", blob.blobName, blobLength];
+        self.currentBlob = blob;
+        self.blobIndex = index;
+        self.blobLength = blobLength;
+        self.blockCount = blockCount;
+        completionHandler(nil);
+    };
+    
+    [blob createIfNotExistsWithAccessCondition:nil requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error, BOOL created) {
+        if (error)
+        {
+            completionHandler(error);
+            return;
+        }
+        
+        if (created)
+        {
+            attach(0, 0);
+            return;
+        }
+        
+        [blob downloadAttributesWithAccessCondition:nil requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error) {
+            if (error)
+            {
+                completionHandler(error);
+                return;
+            }
+            
+            attach(blob.properties.length.unsignedLongLongValue, blob.properties.appendBlobCommittedBlockCount.unsignedIntegerValue);
+        }];
+    }];
+}
+
+-(BOOL)appendRecord:(NSData *)record error:(NSError **)error
+{
+    NSString *failure = nil;
+    if (!self.opened)
+    {
+        failure = @"The writer must be opened before records can be appended.";
+    }
+    else if ((record.length > self.maximumBatchSize) || (record.length > self.maximumBlobSize))
+    {
+        failure = @"The record is larger than the maximum batch size or the maximum blob size.";
+    }
+    
+    if (failure)
+    {
+        if (error)
+        {
+            *error = [NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:failure}];
+        }
+        return NO;
+    }
+    
+    // The flag is checked first, so that the common path doesn't touch the error property's lock.
+    if (atomic_load(&_failed))
+    {
+        if (error)
+        {
+            *error = self.writeError;
+        }
+        return NO;
+    }
+    
+    if (record.length == 0)
+    {
+        return YES;
+    }
+    
+    AZSLogRecordNode *node = malloc(sizeof(AZSLogRecordNode));
+    node->record = CFBridgingRetain(record);
+    node->length = record.length;
+    node->queuedTime = mach_absolute_time();
+    
+    atomic_fetch_add(&_recordsQueued, 1);
+    unsigned long long previousBytes = atomic_fetch_add(&_queuedBytes, record.length);
+    
+    AZSLogRecordNode *head = atomic_load_explicit(&_queueHead, memory_order_relaxed);
+    do
+    {
+        node->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&_queueHead, &head, node, memory_order_release, memory_order_relaxed));
+    
+    if ((previousBytes < self.maximumBatchSize) && (previousBytes + record.length >= self.maximumBatchSize))
+    {
+        dispatch_async(self.consumerQueue, ^{
+            [self drain];
+        });
+    }
+    else if (!head)
+    {
+        // The first record pushed onto an empty stack starts the latency clock.
+        [self scheduleDrainAfter:self.maximumLatency];
+    }
+    
+    return YES;
+}
+
+-(void)flushWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    unsigned long long target = atomic_load(&_recordsQueued);
+    dispatch_async(self.consumerQueue, ^{
+        if (self.writeError)
+        {
+            completionHandler(self.writeError);
+            return;
+        }
+        if (self.recordsAppended >= target)
+        {
+            completionHandler(nil);
+            return;
+        }
+        
+        [self.flushHandlers addObject:@[[NSNumber numberWithUnsignedLongLong:target], [completionHandler copy]]];
+        [self drain];
+    });
+}
+
+-(NSTimeInterval)flushLatencyAtPercentile:(double)percentile
+{
+    NSTimeInterval *samples = malloc(AZSLogWriterLatencySampleCount * sizeof(NSTimeInterval));
+    NSUInteger count = 0;
+    @synchronized(self)
+    {
+        count = MIN(_latencyCount, AZSLogWriterLatencySampleCount);
+        memcpy(samples, _latencies, count * sizeof(NSTimeInterval));
+    }
+    
+    NSTimeInterval latency = 0;
+    if (count > 0)
+    {
+        // Nearest-rank percentile.
+        qsort(samples, count, sizeof(NSTimeInterval), AZSCompareLatencies);
+        NSUInteger rank = (NSUInteger)ceil(MIN(MAX(percentile, 0), 100) / 100 * count);
+        latency = samples[(rank > 0) ? rank - 1 : 0];
+    }
+    
+    free(samples);
+    return latency;
+}
+
+-(void)scheduleDrainAfter:(NSTimeInterval)delay
+{
+    AZSAppendBlobLogWriter * __weak weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), self.consumerQueue, ^{
+        [weakSelf drain];
+    });
+}
+
+// Must be called on the consumer queue.  Takes everything queued by producers, and starts the next append if one is due.
+-(void)drain
+{
+    AZSLogRecordNode *taken = atomic_exchange_explicit(&_queueHead, NULL, memory_order_acquire);
+    AZSLogRecordNode *takenTail = taken;
+    AZSLogRecordNode *reversed = NULL;
+    while (taken)
+    {
+        AZSLogRecordNode *next = taken->next;
+        taken->next = reversed;
+        reversed = taken;
+        taken = next;
+    }
+    if (reversed)
+    {
+        if (_pendingTail)
+        {
+            _pendingTail->next = reversed;
+        }
+        else
+        {
+            _pendingHead = reversed;
+        }
+        _pendingTail = takenTail;
+    }
+    
+    if (self.appendInFlight || self.writeError || !_pendingHead)
+    {
+        return;
+    }
+    
+    NSTimeInterval oldestAge = AZSSecondsFromMachTime(mach_absolute_time() - _pendingHead->queuedTime);
+    if ((self.flushHandlers.count == 0) && (atomic_load(&_queuedBytes) < self.maximumBatchSize) && (oldestAge < self.maximumLatency))
+    {
+        [self scheduleDrainAfter:self.maximumLatency - oldestAge];
+        return;
+    }
+    
+    if ((self.blockCount >= self.maximumBlockCount) || (self.blobLength + _pendingHead->length > self.maximumBlobSize))
+    {
+        [self rollOver];
+        return;
+    }
+    
+    NSUInteger batchLimit = (NSUInteger)MIN(self.maximumBatchSize, self.maximumBlobSize - self.blobLength);
+    NSMutableData *batch = [NSMutableData dataWithCapacity:MIN(batchLimit, (NSUInteger)atomic_load(&_queuedBytes))];
+    AZSLogRecordNode *batchHead = _pendingHead;
+    AZSLogRecordNode *batchTail = NULL;
+    NSUInteger batchRecordCount = 0;
+    while (_pendingHead && (batch.length + _pendingHead->length <= batchLimit))
+    {
+        [batch appendData:(__bridge NSData *)_pendingHead->record];
+        batchTail = _pendingHead;
+        _pendingHead = _pendingHead->next;
+        batchRecordCount++;
+    }
+    if (!batchTail)
+    {
+        // Records are checked against maximumBatchSize when they are appended, but it may have been lowered since.
+        [self failWithError:[NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"A queued record is larger than the maximum batch size."}]];
+        return;
+    }
+    batchTail->next = NULL;
+    if (!_pendingHead)
+    {
+        _pendingTail = NULL;
+    }
+    
+    self.appendInFlight = YES;
+    [self appendBatch:batch head:batchHead tail:batchTail recordCount:batchRecordCount];
+}
+
+-(void)appendBatch:(NSData *)batch head:(AZSLogRecordNode *)batchHead tail:(AZSLogRecordNode *)batchTail recordCount:(NSUInteger)batchRecordCount
+{
+    AZSCloudAppendBlob *blob = self.currentBlob;
+    AZSAccessCondition *accessCondition = [[AZSAccessCondition alloc] initWithIfMaxSizeLessThanOrEqualTo:[NSNumber numberWithUnsignedLongLong:self.maximumBlobSize]];
+    accessCondition.appendPosition = [NSNumber numberWithUnsignedLongLong:self.blobLength];
+    NSUInteger currentResultsCount = self.operationContext.requestResults.count;
+    
+    [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Appending %lu log records (%lu bytes) to %@.", (unsigned long)batchRecordCount, (unsigned long)batch.length, blob.blobName];
+    
+    [blob appendBlockWithData:batch contentMD5:nil accessCondition:accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *appendError, NSNumber *appendOffset) {
+        dispatch_async(self.consumerQueue, ^{
+            self.appendInFlight = NO;
+            
+            NSError *error = appendError;
+            NSString *errorCode = error.userInfo[AZSCXmlCode];
+            if ([errorCode isEqualToString:@"AppendPositionConditionNotMet"] && self.requestOptions.absorbConditionalErrorsOnRetry && (self.operationContext.requestResults.count - currentResultsCount > 1))
+            {
+                [self.operationContext logAtLevel:AZSLogLevelWarning withMessage:@"Pre-condition failure on a retry is being ignored as the request should have succeeded in the first attempt."];
+                error = nil;
+            }
+            else if ([errorCode isEqualToString:@"AppendPositionConditionNotMet"] || [errorCode isEqualToString:@"MaxBlobSizeConditionNotMet"] || [errorCode isEqualToString:@"BlockCountExceedsLimit"])
+            {
+                // The blob is full, or another writer has appended to it.  Put the batch back, and move on to the next blob.
+                [self.operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Append to %@ failed with %@, rolling over.", blob.blobName, errorCode];
+                batchTail->next = _pendingHead;
+                _pendingHead = batchHead;
+                if (!_pendingTail)
+                {
+                    _pendingTail = batchTail;
+                }
+                [self rollOver];
+                return;
+            }
+            
+            if (error)
+            {
+                AZSFreeLogRecordNodes(batchHead);
+                atomic_fetch_sub(&_queuedBytes, batch.length);
+                [self failWithError:error];
+                return;
+            }
+            
+            self.blobLength += batch.length;
+            self.blockCount++;
+            _appendCount++;
+            _bytesAppended += batch.length;
+            
+            uint64_t now = mach_absolute_time();
+            @synchronized(self)
+            {
+                for (AZSLogRecordNode *node = batchHead; node; node = node->next)
+                {
+                    _latencies[_latencyCount % AZSLogWriterLatencySampleCount] = AZSSecondsFromMachTime(now - node->queuedTime);
+                    _latencyCount++;
+                }
+                _recordCount += batchRecordCount;
+            }
+            AZSFreeLogRecordNodes(batchHead);
+            atomic_fetch_sub(&_queuedBytes, batch.length);
+            self.recordsAppended += batchRecordCount;
+            
+            NSMutableArray *completedFlushHandlers = [NSMutableArray array];
+            for (NSArray *flushHandler in [self.flushHandlers copy])
+            {
+                if (((NSNumber *)flushHandler[0]).unsignedLongLongValue <= self.recordsAppended)
+                {
+                    [completedFlushHandlers addObject:flushHandler[1]];
+                    [self.flushHandlers removeObject:flushHandler];
+                }
+            }
+            for (void (^completionHandler)(NSError *) in completedFlushHandlers)
+            {
+                completionHandler(nil);
+            }
+            
+            [self drain];
+        });
+    }];
+}
+
+// Must be called on the consumer queue.
+-(void)rollOver
+{
+    // Holding the in-flight flag keeps drain from starting an append until the next blob is ready.
+    self.appendInFlight = YES;
+    _rolloverCount++;
+    [self attachToBlobAtIndex:self.blobIndex + 1 completionHandler:^(NSError *error) {
+        dispatch_async(self.consumerQueue, ^{
+            self.appendInFlight = NO;
+            if (error)
+            {
+                [self failWithError:error];
+                return;
+            }
+            [self drain];
+        });
+    }];
+}
+
+// Must be called on the consumer queue.
+-(void)failWithError:(NSError *)error
+{
+    [self.operationContext logAtLevel:AZSLogLevelError withMessage:@"Appending log records failed, the writer can no longer be used."];
+    self.writeError = error;
+    atomic_store(&_failed, true);
+    
+    NSArray *failedFlushHandlers = [self.flushHandlers copy];
+    [self.flushHandlers removeAllObjects];
+    for (NSArray *flushHandler in failedFlushHandlers)
+    {
+        ((void (^)(NSError *))flushHandler[1])(error);
+    }
+}
+
+@end
@@ -46,9 +46,12 @@ AZS_ASSUME_NONNULL_BEGIN
  
  @warning Using a AZSBlobOutputStream will overwrite any existing data in the blob.
  @warning The call to close the stream will block until all uploads are complete and the block list has been committed.  As
- network operations, this make take a significant amount of time.  Do not call close on a critical thread.
- @bug Currently, if there are too many outstanding block uploads, a call to write will block.  This is a known
- issue.
+ network operations, this make take a significant amount of time.  Do not call close on a critical thread; use
+ closeWithCompletionHandler: instead, which returns immediately and calls back once the blob has been committed.
+ 
+ By default, if there are too many outstanding block uploads, a call to write will block until one completes.  Set nonBlockingWrites
+ to have write return the number of bytes it could take without waiting instead (0 if none), as for any other NSOutputStream that
+ is full.  NSStreamEventHasSpaceAvailable is fired when an upload completes.
  */
 @interface AZSBlobOutputStream : NSOutputStream <NSStreamDelegate>
 
@@ -62,6 +65,18 @@ AZS_ASSUME_NONNULL_BEGIN
 // Potential problem - this method will *block* until all blocks have successfully been uploaded, and the block list is successfully uploaded.
 -(void)close;
 
+/** Closes the stream without blocking.
+ 
+ Any remaining data is uploaded, and the blob is committed once the last block upload completes.  No data may be written after this call.
+ 
+ @param completionHandler The block of code to execute once the blob has been committed, or the upload has failed.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the upload completed successfully, or the error that caused it to fail.|
+ */
+-(void)closeWithCompletionHandler:(void (^)(NSError * __AZSNullable))completionHandler;
+
 -(void)scheduleInRunLoop:(NSRunLoop *)runLoop forMode:(NSString *)mode;
 -(void)removeFromRunLoop:(NSRunLoop *)runLoop forMode:(NSString *)mode;
 
@@ -71,6 +86,9 @@ AZS_ASSUME_NONNULL_BEGIN
 // NSOutputStream methods and properties:
 @property(readonly) BOOL hasSpaceAvailable;
 
+/** If YES, write returns early rather than waiting for an upload slot when too many block uploads are outstanding.  Defaults to NO.*/
+@property BOOL nonBlockingWrites;
+
 -(NSInteger)write:(const uint8_t *)buffer maxLength:(NSUInteger)length;
 
 // NSStreamDelegate:
@@ -159,6 +159,7 @@ void AZSBlobOutputStreamRunLoopSourcePerformRoutine (void *info)
         _runLoopSource = CFRunLoopSourceCreate(NULL, 0, &context);
         _runLoopsRegistered = [NSMutableArray arrayWithCapacity:1];
         _waitingOnCaller = NO;
+        _nonBlockingWrites = NO;
         _delegate = self;
         _hasStreamOpenEventFired = NO;
         _hasStreamErrorEventFired = NO;
@@ -259,7 +260,7 @@ void AZSBlobOutputStreamRunLoopSourcePerformRoutine (void *info)
     NSInteger dataCopied = 0;
     if (self.isStreamOpen)
     {
-        dataCopied = [self.blobUploadHelper write:buffer maxLength:length completionHandler:^{
+        dataCopied = [self.blobUploadHelper write:buffer maxLength:length blocking:!self.nonBlockingWrites completionHandler:^{
             [self fireStreamEvent];
         }];        
     }
@@ -289,6 +290,21 @@ void AZSBlobOutputStreamRunLoopSourcePerformRoutine (void *info)
     [self fireStreamEvent];
 }
 
+-(void)closeWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    [self.blobUploadHelper.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Called close with completion handler."];
+    self.isStreamClosing = YES;
+    self.isStreamOpen = NO;
+    [self.blobUploadHelper finishWithBlockCompletionHandler:^{
+        [self fireStreamEvent];
+    } completionHandler:^(NSError *error) {
+        self.isStreamClosed = YES;
+        self.isStreamClosing = NO;
+        [self fireStreamEvent];
+        completionHandler(error);
+    }];
+}
+
 // TODO: NSStreamStatusError
 -(NSStreamStatus) streamStatus
 {
@@ -0,0 +1,144 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlobRandomAccessReader.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+@class AZSCloudBlob;
+@class AZSBlobRequestOptions;
+@class AZSOperationContext;
+
+/** The AZSBlobRandomAccessReader provides random-access reads over the contents of a blob.
+
+ The blob is divided into fixed-size blocks, which are downloaded on demand and kept in a least-recently-used cache.  When reads
+ are detected to be sequential, the following blocks are downloaded ahead of time.  When the reader is opened, it records the blob's
+ ETag, and every subsequent download is conditional on that ETag, so all reads see the same version of the blob.  If the blob changes
+ after the reader is opened, reads that miss the cache will fail with a 412 error, unless refreshesWhenBlobChanges is set.
+ 
+ For a page blob, opening the reader also downloads the blob's page ranges.  Blocks are then only downloaded where pages are
+ populated: blocks that lie entirely within clear pages are filled with zeros without a request, and only the populated parts of
+ other blocks are downloaded.
+ */
+@interface AZSBlobRandomAccessReader : NSObject
+
+/** The blob being read.*/
+@property (strong, readonly) AZSCloudBlob *blob;
+
+/** The size of each cached block, in bytes.*/
+@property (readonly) NSUInteger blockSize;
+
+/** The maximum number of blocks held in the cache.*/
+@property (readonly) NSUInteger maximumCachedBlocks;
+
+/** The number of blocks to download ahead when reads are sequential.  0 disables read-ahead.  Default is 4.*/
+@property NSUInteger readAheadBlockCount;
+
+/** The ETag the reader is pinned to.  Nil until the reader has been opened.*/
+@property (copy, readonly, AZSNullable) NSString *eTag;
+
+/** The sequence number the reader is pinned to, for a page blob.  Nil until the reader has been opened, and for other blob types.*/
+@property (copy, readonly, AZSNullable) NSNumber *sequenceNumber;
+
+/** If YES, a read that fails because the blob has changed refreshes the reader (see refreshWithCompletionHandler:) and is retried
+ once against the new version.  Default is NO.
+ 
+ A change is only noticed when a read sends a request.  Reads served entirely from the cache, or from clear pages of a page blob,
+ keep returning the pinned version; call refreshWithCompletionHandler: to pick up changes to those.*/
+@property BOOL refreshesWhenBlobChanges;
+
+/** The length of the blob, as of when the reader was opened.*/
+@property (readonly) unsigned long long blobLength;
+
+/** The number of block lookups that were satisfied from the cache.*/
+@property (readonly) NSUInteger cacheHits;
+
+/** The number of block lookups that required a download.*/
+@property (readonly) NSUInteger cacheMisses;
+
+/** The total number of bytes downloaded from the service, including read-ahead.*/
+@property (readonly) unsigned long long bytesFetched;
+
+/** The total number of bytes in clear pages that were not downloaded, because the page ranges showed them to be zero.*/
+@property (readonly) unsigned long long bytesSkipped;
+
+/** Initializes a newly allocated AZSBlobRandomAccessReader object with a 1 MB block size and a 64-block cache.
+
+ @param blob The blob to read.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithBlob:(AZSCloudBlob *)blob;
+
+/** Initializes a newly allocated AZSBlobRandomAccessReader object.
+
+ @param blob The blob to read.
+ @param blockSize The size of each cached block, in bytes.
+ @param maximumCachedBlocks The maximum number of blocks to hold in the cache.
+ @param requestOptions The options to use for each download.
+ @param operationContext The operation context to use for each download.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithBlob:(AZSCloudBlob *)blob blockSize:(NSUInteger)blockSize maximumCachedBlocks:(NSUInteger)maximumCachedBlocks requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext AZS_DESIGNATED_INITIALIZER;
+
+/** Opens the reader.
+
+ This downloads the blob's attributes and pins the reader to the blob's current ETag.  The cache is cleared.
+
+ @param completionHandler The block of code to execute when the open call completes.
+
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)openWithCompletionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Reads data from the blob.
+
+ Blocks not already in the cache are downloaded; runs of adjacent missing blocks are downloaded with a single request.
+
+ @param offset The offset in the blob at which to start reading.
+ @param length The number of bytes to read.
+ @param completionHandler The block of code to execute when the read completes.
+
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ |NSData * | The data read.  This is shorter than the requested length if the read runs past the end of the blob.|
+ */
+-(void)readFromOffset:(unsigned long long)offset length:(NSUInteger)length completionHandler:(void (^)(NSError* __AZSNullable, NSData * __AZSNullable))completionHandler;
+
+/** Checks whether the blob has changed since the reader was opened or last refreshed.
+ 
+ This downloads the blob's attributes.  If the ETag, or the sequence number of a page blob, has changed, the cache is cleared and
+ the reader is pinned to the new version of the blob, reloading the page ranges of a page blob.
+ 
+ @param completionHandler The block of code to execute when the refresh completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ |BOOL | YES if the blob had changed, and the cache was cleared.|
+ */
+-(void)refreshWithCompletionHandler:(void (^)(NSError* __AZSNullable, BOOL))completionHandler;
+
+/** Removes all blocks from the cache.  Statistics are not reset.*/
+-(void)invalidateCache;
+
+@end
+
+AZS_ASSUME_NONNULL_END
@@ -0,0 +1,400 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlobRandomAccessReader.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSBlobRandomAccessReader.h"
+#import "AZSAccessCondition.h"
+#import "AZSBlobProperties.h"
+#import "AZSBlobRequestOptions.h"
+#import "AZSCloudBlob.h"
+#import "AZSCloudPageBlob.h"
+#import "AZSConstants.h"
+#import "AZSErrors.h"
+#import "AZSOperationContext.h"
+#import "AZSULLRange.h"
+#import "AZSULLRangeSet.h"
+
+@interface AZSBlobRandomAccessReader()
+
+@property (strong) AZSBlobRequestOptions *requestOptions;
+@property (strong) AZSOperationContext *operationContext;
+@property (strong) AZSAccessCondition *pinnedAccessCondition;
+@property (strong) NSMutableDictionary *cachedBlocks;
+@property (strong) NSMutableArray *leastRecentlyUsedBlocks;
+
+// The populated page ranges of a page blob.  Nil for other blob types.
+@property (strong) AZSULLRangeSet *pageRanges;
+// ULLONG_MAX until the first read, so that a first read at offset 0 doesn't count as sequential.
+@property unsigned long long lastReadEnd;
+@property NSUInteger sequentialReadCount;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSBlobRandomAccessReader
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithBlob:(AZSCloudBlob *)blob
+{
+    return [self initWithBlob:blob blockSize:(AZSCKilobyte * AZSCKilobyte) maximumCachedBlocks:64 requestOptions:nil operationContext:nil];
+}
+
+-(instancetype)initWithBlob:(AZSCloudBlob *)blob blockSize:(NSUInteger)blockSize maximumCachedBlocks:(NSUInteger)maximumCachedBlocks requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext
+{
+    self = [super init];
+    if (self)
+    {
+        _blob = blob;
+        _blockSize = MAX(blockSize, 1);
+        _maximumCachedBlocks = MAX(maximumCachedBlocks, 1);
+        _readAheadBlockCount = 4;
+        _requestOptions = requestOptions;
+        _operationContext = operationContext ?: [[AZSOperationContext alloc] init];
+        _cachedBlocks = [NSMutableDictionary dictionaryWithCapacity:_maximumCachedBlocks];
+        _leastRecentlyUsedBlocks = [NSMutableArray arrayWithCapacity:_maximumCachedBlocks];
+        _lastReadEnd = ULLONG_MAX;
+        _sequentialReadCount = 0;
+    }
+
+    return self;
+}
+
+-(void)openWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    [self.blob downloadAttributesWithAccessCondition:nil requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error) {
+        if (error)
+        {
+            completionHandler(error);
+            return;
+        }
+
+        [self pinToDownloadedAttributesWithCompletionHandler:completionHandler];
+    }];
+}
+
+-(void)refreshWithCompletionHandler:(void (^)(NSError *, BOOL))completionHandler
+{
+    [self.blob downloadAttributesWithAccessCondition:nil requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error) {
+        if (error)
+        {
+            completionHandler(error, NO);
+            return;
+        }
+
+        BOOL changed = NO;
+        @synchronized(self)
+        {
+            NSNumber *sequenceNumber = self.pageRanges ? self.blob.properties.sequenceNumber : nil;
+            changed = ![self.blob.properties.eTag isEqualToString:self.eTag] || ((sequenceNumber != self.sequenceNumber) && ![sequenceNumber isEqualToNumber:self.sequenceNumber]);
+        }
+        if (!changed)
+        {
+            completionHandler(nil, NO);
+            return;
+        }
+
+        [self.operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Blob changed since the random access reader was pinned, clearing the cache."];
+        [self pinToDownloadedAttributesWithCompletionHandler:^(NSError *error) {
+            completionHandler(error, YES);
+        }];
+    }];
+}
+
+// Pins the reader to the version of the blob whose attributes were just downloaded, loading its page ranges if it is a page blob.
+// The page ranges are downloaded conditional on the same ETag, so that they describe the same version.
+-(void)pinToDownloadedAttributesWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    NSString *eTag = self.blob.properties.eTag;
+    NSNumber *sequenceNumber = self.blob.properties.sequenceNumber;
+    unsigned long long blobLength = self.blob.properties.length.unsignedLongLongValue;
+    AZSAccessCondition *accessCondition = [[AZSAccessCondition alloc] initWithIfMatchCondition:eTag];
+
+    void (^pin)(AZSULLRangeSet *) = ^(AZSULLRangeSet *pageRanges) {
+        @synchronized(self)
+        {
+            _eTag = eTag;
+            _sequenceNumber = pageRanges ? sequenceNumber : nil;
+            _blobLength = blobLength;
+            self.pageRanges = pageRanges;
+            self.pinnedAccessCondition = accessCondition;
+            self.lastReadEnd = ULLONG_MAX;
+            self.sequentialReadCount = 0;
+            [self invalidateCache];
+        }
+    };
+
+    if (![self.blob isKindOfClass:[AZSCloudPageBlob class]])
+    {
+        pin(nil);
+        completionHandler(nil);
+        return;
+    }
+
+    [(AZSCloudPageBlob *)self.blob downloadPageRangeSetWithAZSULLRange:AZSULLMakeRange(0, 0) accessCondition:accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error, AZSULLRangeSet *pageRanges) {
+        if (!error)
+        {
+            pin(pageRanges ?: [[AZSULLRangeSet alloc] init]);
+        }
+        completionHandler(error);
+    }];
+}
+
+// Must be called while synchronized on self.  Returns the parts of the range that lie in populated pages.
+-(NSArray *)populatedRangesInRange:(AZSULLRange)range
+{
+    if (!self.pageRanges)
+    {
+        return @[[NSValue valueWithAZSULLRange:range]];
+    }
+
+    return [self.pageRanges rangeSetByIntersectingRange:range].rangeValues;
+}
+
+-(void)invalidateCache
+{
+    @synchronized(self)
+    {
+        [self.cachedBlocks removeAllObjects];
+        [self.leastRecentlyUsedBlocks removeAllObjects];
+    }
+}
+
+// Must be called while synchronized on self.
+-(void)touchBlock:(NSNumber *)blockIndex
+{
+    [self.leastRecentlyUsedBlocks removeObject:blockIndex];
+    [self.leastRecentlyUsedBlocks addObject:blockIndex];
+}
+
+// Must be called while synchronized on self.
+-(void)cacheBlock:(NSData *)blockData atIndex:(NSNumber *)blockIndex
+{
+    self.cachedBlocks[blockIndex] = blockData;
+    [self touchBlock:blockIndex];
+    while (self.leastRecentlyUsedBlocks.count > self.maximumCachedBlocks)
+    {
+        [self.cachedBlocks removeObjectForKey:self.leastRecentlyUsedBlocks[0]];
+        [self.leastRecentlyUsedBlocks removeObjectAtIndex:0];
+    }
+}
+
+-(void)readFromOffset:(unsigned long long)offset length:(NSUInteger)length completionHandler:(void (^)(NSError *, NSData *))completionHandler
+{
+    if (!self.refreshesWhenBlobChanges)
+    {
+        [self readFromOffset:offset length:length pinnedCompletionHandler:completionHandler];
+        return;
+    }
+
+    [self readFromOffset:offset length:length pinnedCompletionHandler:^(NSError *error, NSData *data) {
+        if (((NSNumber *)error.userInfo[AZSCHttpStatusCode]).integerValue != 412)
+        {
+            completionHandler(error, data);
+            return;
+        }
+
+        [self refreshWithCompletionHandler:^(NSError *refreshError, BOOL changed) {
+            if (refreshError || !changed)
+            {
+                completionHandler(refreshError ?: error, nil);
+                return;
+            }
+
+            [self readFromOffset:offset length:length pinnedCompletionHandler:completionHandler];
+        }];
+    }];
+}
+
+// Reads from the version of the blob the reader is pinned to.
+-(void)readFromOffset:(unsigned long long)offset length:(NSUInteger)length pinnedCompletionHandler:(void (^)(NSError *, NSData *))completionHandler
+{
+    if (!self.pinnedAccessCondition)
+    {
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"The reader must be opened before it can be read from."}], nil);
+        return;
+    }
+
+    if (length == 0 || offset >= self.blobLength)
+    {
+        completionHandler(nil, [NSData data]);
+        return;
+    }
+
+    unsigned long long end = MIN(offset + length, self.blobLength);
+    unsigned long long firstBlock = offset / self.blockSize;
+    unsigned long long lastBlock = (end - 1) / self.blockSize;
+
+    // Hold references to the blocks for this read here, so that they can't be evicted before the result is assembled.
+    NSMutableDictionary *blocksForRead = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)(lastBlock - firstBlock + 1)];
+    NSMutableArray *blocksToFetch = [NSMutableArray array];
+    AZSAccessCondition *accessCondition = nil;
+
+    @synchronized(self)
+    {
+        accessCondition = self.pinnedAccessCondition;
+        if (offset == self.lastReadEnd)
+        {
+            self.sequentialReadCount++;
+        }
+        else
+        {
+            self.sequentialReadCount = 0;
+        }
+        self.lastReadEnd = end;
+
+        for (unsigned long long block = firstBlock; block <= lastBlock; block++)
+        {
+            NSNumber *blockIndex = [NSNumber numberWithUnsignedLongLong:block];
+            NSData *blockData = self.cachedBlocks[blockIndex];
+            if (blockData)
+            {
+                _cacheHits++;
+                blocksForRead[blockIndex] = blockData;
+                [self touchBlock:blockIndex];
+            }
+            else
+            {
+                _cacheMisses++;
+                [blocksToFetch addObject:blockIndex];
+            }
+        }
+
+        // Only read ahead once at least two reads in a row have been sequential, so that a single small read doesn't trigger it.
+        if (self.sequentialReadCount > 0 && blocksToFetch.count > 0)
+        {
+            for (unsigned long long block = lastBlock + 1; (block <= lastBlock + self.readAheadBlockCount) && (block * self.blockSize < self.blobLength); block++)
+            {
+                NSNumber *blockIndex = [NSNumber numberWithUnsignedLongLong:block];
+                if (!self.cachedBlocks[blockIndex])
+                {
+                    [blocksToFetch addObject:blockIndex];
+                }
+            }
+        }
+    }
+
+    void (^assembleResult)(void) = ^{
+        NSMutableData *result = [NSMutableData dataWithCapacity:(NSUInteger)(end - offset)];
+        for (unsigned long long block = firstBlock; block <= lastBlock; block++)
+        {
+            NSData *blockData = blocksForRead[[NSNumber numberWithUnsignedLongLong:block]];
+            unsigned long long blockStart = block * self.blockSize;
+            unsigned long long copyStart = MAX(offset, blockStart) - blockStart;
+            unsigned long long copyEnd = MIN(end, blockStart + blockData.length) - blockStart;
+            if (copyEnd > copyStart)
+            {
+                [result appendBytes:((const uint8_t *)blockData.bytes) + copyStart length:(NSUInteger)(copyEnd - copyStart)];
+            }
+        }
+        completionHandler(nil, result);
+    };
+
+    if (blocksToFetch.count == 0)
+    {
+        assembleResult();
+        return;
+    }
+
+    // Only the populated parts of each block are downloaded; for blobs other than page blobs, that is the whole block.
+    NSMutableArray *ranges = [NSMutableArray arrayWithCapacity:blocksToFetch.count];
+    NSMutableArray *blockRanges = [NSMutableArray arrayWithCapacity:blocksToFetch.count];
+    @synchronized(self)
+    {
+        for (NSNumber *blockIndex in blocksToFetch)
+        {
+            AZSULLRange blockRange = AZSULLMakeRange(blockIndex.unsignedLongLongValue * self.blockSize, self.blockSize);
+            NSArray *populatedRanges = [self populatedRangesInRange:blockRange];
+            [ranges addObjectsFromArray:populatedRanges];
+            [blockRanges addObject:populatedRanges];
+        }
+    }
+
+    [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Random access read at offset %llu fetching %lu blocks in %lu ranges.", offset, (unsigned long)blocksToFetch.count, (unsigned long)ranges.count];
+
+    void (^cacheFetchedBlocks)(NSArray *) = ^(NSArray *slices) {
+        @synchronized(self)
+        {
+            NSUInteger sliceIndex = 0;
+            for (NSUInteger i = 0; i < blocksToFetch.count; i++)
+            {
+                NSNumber *blockIndex = blocksToFetch[i];
+                NSArray *populatedRanges = blockRanges[i];
+                unsigned long long blockStart = blockIndex.unsignedLongLongValue * self.blockSize;
+                NSData *blockData = nil;
+                if (!self.pageRanges)
+                {
+                    blockData = slices[sliceIndex];
+                }
+                else
+                {
+                    // Clear pages read as zeros.
+                    NSUInteger blockLength = (NSUInteger)(MIN(blockStart + self.blockSize, self.blobLength) - blockStart);
+                    NSMutableData *filledBlock = [NSMutableData dataWithLength:blockLength];
+                    NSUInteger populatedLength = 0;
+                    for (NSUInteger j = 0; j < populatedRanges.count; j++)
+                    {
+                        AZSULLRange populatedRange = ((NSValue *)populatedRanges[j]).AZSULLRangeValue;
+                        NSData *slice = slices[sliceIndex + j];
+                        memcpy(((uint8_t *)filledBlock.mutableBytes) + (populatedRange.location - blockStart), slice.bytes, MIN(slice.length, blockLength - (NSUInteger)(populatedRange.location - blockStart)));
+                        populatedLength += slice.length;
+                    }
+                    _bytesSkipped += blockLength - MIN(populatedLength, blockLength);
+                    blockData = filledBlock;
+                }
+                sliceIndex += populatedRanges.count;
+
+                [self cacheBlock:blockData atIndex:blockIndex];
+                if (blockIndex.unsignedLongLongValue <= lastBlock)
+                {
+                    blocksForRead[blockIndex] = blockData;
+                }
+            }
+        }
+
+        assembleResult();
+    };
+
+    if (ranges.count == 0)
+    {
+        // Every block is in clear pages.
+        cacheFetchedBlocks(@[]);
+        return;
+    }
+
+    [self.blob downloadRanges:ranges gapThreshold:0 accessCondition:accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error, NSArray *slices) {
+        if (error)
+        {
+            completionHandler(error, nil);
+            return;
+        }
+
+        @synchronized(self)
+        {
+            for (NSData *slice in slices)
+            {
+                _bytesFetched += slice.length;
+            }
+        }
+        cacheFetchedBlocks(slices);
+    }];
+}
+
+@end
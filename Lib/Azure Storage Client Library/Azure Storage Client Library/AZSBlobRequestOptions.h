@@ -16,6 +16,8 @@
 // -----------------------------------------------------------------------------------------
 
 #import "AZSRequestOptions.h"
+#import "AZSEnums.h"
+@class AZSTransformChain;
 AZS_ASSUME_NONNULL_BEGIN
 
 /** AZSBlobRequestOptions contains options used for requests to the blob service.
@@ -38,6 +40,42 @@ AZS_ASSUME_NONNULL_BEGIN
 /** If YES, the library will not calculate and validate the MD5 when downloading a blob.*/
 @property BOOL disableContentMD5Validation;
 
+/** If YES, uploads from streams (and through an AZSBlobOutputStream) that write an entire blob store a CRC64 of the blob in its
+ metadata, and downloads of an entire blob that carries one validate the downloaded data against it.
+ 
+ A checksum is stored for block blobs, for new append blobs, and for new page blobs that are written up to their full size.  The
+ service does not know about the checksum, so changing the blob by other means (such as appending blocks) leaves a stale checksum,
+ and later downloads with this option set will fail with AZSECRC64Mismatch.
+ 
+ A CRC64 is much cheaper to calculate than an MD5, and the checksums of each block are calculated in parallel and then combined
+ into the checksum for the blob.  The checksum is stored in the metadata under AZSCContentCRC64MetadataKey, as the base64 encoding
+ of its 8 little-endian bytes.  This is independent of the MD5 options, which may be used at the same time.
+ */
+@property BOOL useContentCRC64;
+
+/** The compression to apply to block blob uploads from streams and through an AZSBlobOutputStream.  Defaults to AZSContentCompressionNone.
+ 
+ The data is compressed as it is buffered into blocks, so the whole blob is never held in memory, and the blob's contentEncoding
+ property is set to match.  Any MD5 or CRC64 describes the compressed data, as stored.
+ 
+ Downloads need no option: the URL loading system decodes any response whose Content-Encoding is gzip or deflate.  Because the
+ compressed bytes are never seen, the blob's MD5 and CRC64 are not validated on such downloads.
+ */
+@property AZSContentCompression contentCompression;
+
+/** The transform chain that uploads from streams and through an AZSBlobOutputStream pass each block through before sending it.  Can be nil.
+ 
+ The chain is shared, not copied, when options are copied, and must only be used for one transfer at a time.
+ */
+@property (strong, AZSNullable) AZSTransformChain *uploadTransformChain;
+
+/** The transform chain that downloads of entire blobs, to streams and sinks, pass received data through.  Can be nil.
+ 
+ The chain is shared, not copied, when options are copied, and must only be used for one transfer at a time.  Once a transformed
+ download has received data, it is not retried.
+ */
+@property (strong, AZSNullable) AZSTransformChain *downloadTransformChain;
+
 /** The number of simultaneous outstanding block uploads to permit when uploading a blob as a series of blocks.*/
 @property NSInteger parallelismFactor;
 
@@ -49,8 +87,21 @@ AZS_ASSUME_NONNULL_BEGIN
  */
 @property BOOL absorbConditionalErrorsOnRetry;
 
-// TODO: Implement logic to upload a blob as a single Put Blob call if below the below threshold.
-//@property NSInteger *singleBlobUploadThreshold;
+/** The size of each block (or page or append block) when uploading a blob as a series of blocks.
+ 
+ Values larger than the service maximum of 4 MB are treated as 4 MB.  For page blobs, this must be a multiple of 512 bytes, or the
+ upload fails with AZSEInvalidArgument.  Set to 0 to have the library choose the size: it starts from the length of the source when
+ known (files and NSData), and then grows or shrinks the size based on the measured time taken to upload each block.  Defaults to 4 MB.
+ */
+@property NSUInteger blockSize;
+
+/** Block blob uploads of at most this many bytes are sent as a single Put Blob request, rather than as blocks and a block list.
+ 
+ For uploads from streams and files, the decision is made once the data is known to fit in a single block, so thresholds larger than
+ the block size only apply to uploads from NSData or text.  The service limits a single Put Blob request to 64 MB; larger values are
+ treated as 64 MB.  Set to 0 to always upload in blocks.  Defaults to 4 MB.
+ */
+@property NSUInteger singleBlobUploadThreshold;
 
 /** Initializes a new AZSBlobRequestOptions object.
  Once the object is initialized, individual properties can be set.*/
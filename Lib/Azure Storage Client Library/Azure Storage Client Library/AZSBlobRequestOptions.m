@@ -16,14 +16,21 @@
 // -----------------------------------------------------------------------------------------
 
 #import "AZSBlobRequestOptions.h"
+#import "AZSConstants.h"
 
 @interface AZSBlobRequestOptions()
 {
     BOOL _useTransactionalMD5Set;
     BOOL _storeBlobContentMD5Set;
     BOOL _disableContentMD5ValidationSet;
+    BOOL _useContentCRC64Set;
+    BOOL _contentCompressionSet;
+    BOOL _uploadTransformChainSet;
+    BOOL _downloadTransformChainSet;
     BOOL _parallelismFactorSet;
     BOOL _absorbConditionalErrorsOnRetrySet;
+    BOOL _singleBlobUploadThresholdSet;
+    BOOL _blockSizeSet;
 }
 
 @end
@@ -33,8 +40,14 @@
 @synthesize useTransactionalMD5 = _useTransactionalMD5;
 @synthesize storeBlobContentMD5 = _storeBlobContentMD5;
 @synthesize disableContentMD5Validation = _disableContentMD5Validation;
+@synthesize useContentCRC64 = _useContentCRC64;
+@synthesize contentCompression = _contentCompression;
+@synthesize uploadTransformChain = _uploadTransformChain;
+@synthesize downloadTransformChain = _downloadTransformChain;
 @synthesize parallelismFactor = _parallelismFactor;
 @synthesize absorbConditionalErrorsOnRetry = _absorbConditionalErrorsOnRetry;
+@synthesize singleBlobUploadThreshold = _singleBlobUploadThreshold;
+@synthesize blockSize = _blockSize;
 
 -(instancetype)init
 {
@@ -48,10 +61,22 @@
         _storeBlobContentMD5Set = NO;
         _disableContentMD5Validation = NO;
         _disableContentMD5ValidationSet = NO;
+        _useContentCRC64 = NO;
+        _useContentCRC64Set = NO;
+        _contentCompression = AZSContentCompressionNone;
+        _contentCompressionSet = NO;
+        _uploadTransformChain = nil;
+        _uploadTransformChainSet = NO;
+        _downloadTransformChain = nil;
+        _downloadTransformChainSet = NO;
         _parallelismFactor = 3;
         _parallelismFactorSet = NO;
         _absorbConditionalErrorsOnRetry = NO;
         _absorbConditionalErrorsOnRetrySet = NO;
+        _singleBlobUploadThreshold = AZSCMaxBlockSize;
+        _singleBlobUploadThresholdSet = NO;
+        _blockSize = AZSCMaxBlockSize;
+        _blockSizeSet = NO;
     }
     
     return self;
@@ -86,6 +111,26 @@
             self.disableContentMD5Validation = sourceOptions.disableContentMD5Validation;
         }
         
+        if (sourceOptions->_useContentCRC64Set)
+        {
+            self.useContentCRC64 = sourceOptions.useContentCRC64;
+        }
+        
+        if (sourceOptions->_contentCompressionSet)
+        {
+            self.contentCompression = sourceOptions.contentCompression;
+        }
+        
+        if (sourceOptions->_uploadTransformChainSet)
+        {
+            self.uploadTransformChain = sourceOptions.uploadTransformChain;
+        }
+        
+        if (sourceOptions->_downloadTransformChainSet)
+        {
+            self.downloadTransformChain = sourceOptions.downloadTransformChain;
+        }
+        
         if (sourceOptions->_parallelismFactorSet)
         {
             self.parallelismFactor = sourceOptions.parallelismFactor;
@@ -95,6 +140,16 @@
         {
             self.absorbConditionalErrorsOnRetry = sourceOptions.absorbConditionalErrorsOnRetry;
         }
+        
+        if (sourceOptions->_singleBlobUploadThresholdSet)
+        {
+            self.singleBlobUploadThreshold = sourceOptions.singleBlobUploadThreshold;
+        }
+        
+        if (sourceOptions->_blockSizeSet)
+        {
+            self.blockSize = sourceOptions.blockSize;
+        }
     }
     
     return self;
@@ -146,6 +201,50 @@
     _disableContentMD5ValidationSet = YES;
 }
 
+-(BOOL)useContentCRC64
+{
+    return _useContentCRC64;
+}
+
+-(void)setUseContentCRC64:(BOOL)useContentCRC64
+{
+    _useContentCRC64 = useContentCRC64;
+    _useContentCRC64Set = YES;
+}
+
+-(AZSContentCompression)contentCompression
+{
+    return _contentCompression;
+}
+
+-(void)setContentCompression:(AZSContentCompression)contentCompression
+{
+    _contentCompression = contentCompression;
+    _contentCompressionSet = YES;
+}
+
+-(AZSTransformChain *)uploadTransformChain
+{
+    return _uploadTransformChain;
+}
+
+-(void)setUploadTransformChain:(AZSTransformChain *)uploadTransformChain
+{
+    _uploadTransformChain = uploadTransformChain;
+    _uploadTransformChainSet = YES;
+}
+
+-(AZSTransformChain *)downloadTransformChain
+{
+    return _downloadTransformChain;
+}
+
+-(void)setDownloadTransformChain:(AZSTransformChain *)downloadTransformChain
+{
+    _downloadTransformChain = downloadTransformChain;
+    _downloadTransformChainSet = YES;
+}
+
 -(NSInteger)parallelismFactor
 {
     return _parallelismFactor;
@@ -168,4 +267,26 @@
     _absorbConditionalErrorsOnRetrySet = YES;
 }
 
+-(NSUInteger)singleBlobUploadThreshold
+{
+    return _singleBlobUploadThreshold;
+}
+
+-(void)setSingleBlobUploadThreshold:(NSUInteger)singleBlobUploadThreshold
+{
+    _singleBlobUploadThreshold = singleBlobUploadThreshold;
+    _singleBlobUploadThresholdSet = YES;
+}
+
+-(NSUInteger)blockSize
+{
+    return _blockSize;
+}
+
+-(void)setBlockSize:(NSUInteger)blockSize
+{
+    _blockSize = blockSize;
+    _blockSizeSet = YES;
+}
+
 @end
@@ -17,6 +17,8 @@
 
 #import <Foundation/Foundation.h>
 #import "AZSEnums.h"
+
+@class AZSULLRangeSet;
 @class AZSBlobContainerProperties;
 @class AZSBlobProperties;
 @class AZSCopyState;
@@ -71,7 +73,7 @@
 
 @interface AZSGetPageRangesResponse : NSObject
 
-+(NSArray *)parseGetPageRangesResponseWithData:(NSData *)data operationContext:(AZSOperationContext *)operationContext error:(NSError **)error;
++(AZSULLRangeSet *)parseGetPageRangesResponseWithData:(NSData *)data operationContext:(AZSOperationContext *)operationContext error:(NSError **)error;
 
 @end
 
@@ -29,6 +29,7 @@
 #import "AZSSharedAccessSignatureHelper.h"
 #import "AZSErrors.h"
 #import "AZSULLRange.h"
+#import "AZSULLRangeSet.h"
 
 @implementation AZSContainerListItem
 
@@ -689,14 +690,15 @@
 
 @implementation AZSGetPageRangesResponse
 
-+(NSArray *)parseGetPageRangesResponseWithData:(NSData *)data operationContext:(AZSOperationContext *)operationContext error:(NSError *__autoreleasing *)error
++(AZSULLRangeSet *)parseGetPageRangesResponseWithData:(NSData *)data operationContext:(AZSOperationContext *)operationContext error:(NSError *__autoreleasing *)error
 {
     AZSStorageXMLParserDelegate *parserDelegate = [[AZSStorageXMLParserDelegate alloc] init];
     
     NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
     parser.shouldProcessNamespaces = NO;
 
-    __block NSMutableArray *rangeList = [NSMutableArray arrayWithCapacity:10];
+    // The service returns ranges in order, so each one is appended to the set without a search.
+    __block AZSULLRangeSet *rangeList = [[AZSULLRangeSet alloc] init];
     __block uint64_t currentLocation = 0;
     __block uint64_t currentMax = 0;
     __block NSMutableArray *elementStack = [NSMutableArray arrayWithCapacity:10];
@@ -740,7 +742,7 @@
         }
         else if ([parentNode isEqualToString:AZSCXmlPageList])
         {
-            [rangeList addObject:[NSValue valueWithAZSULLRange:(AZSULLMakeRange(currentLocation, currentMax - currentLocation + 1))]];
+            [rangeList addRange:AZSULLMakeRange(currentLocation, currentMax - currentLocation + 1)];
             currentMax = 0;
             currentLocation = 0;
         }
@@ -35,11 +35,21 @@ AZS_ASSUME_NONNULL_BEGIN
 @property (strong) NSError *streamingError;
 @property AZSBlobType blobType;
 
+// The total number of bytes that will be written, if known, or 0.  Used to choose the block size when blockSize is 0.
+@property unsigned long long expectedLength;
+
 -(instancetype)initToBlockBlob:(AZSCloudBlockBlob *)blockBlob accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^ __AZSNullable)(NSError* __AZSNullable))completionHandler AZS_DESIGNATED_INITIALIZER;
 -(instancetype)initToPageBlob:(AZSCloudPageBlob *)pageBlob totalBlobSize:(AZSNullable NSNumber *)totalBlobSize initialSequenceNumber:(AZSNullable NSNumber *)initialSequenceNumber accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^ __AZSNullable)(NSError * __AZSNullable))completionHandler AZS_DESIGNATED_INITIALIZER;
 -(instancetype)initToAppendBlob:(AZSCloudAppendBlob *)appendBlob createNew:(BOOL)createNew accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^ __AZSNullable)(NSError* __AZSNullable))completionHandler AZS_DESIGNATED_INITIALIZER;
--(NSInteger)write:(const uint8_t *)buffer maxLength:(NSUInteger)length completionHandler:(void(^)())completionHandler;
+// The block size to use for an upload of the given length (0 if unknown), honoring requestOptions.blockSize.
++(NSUInteger)blockSizeForLength:(unsigned long long)length requestOptions:(AZSBlobRequestOptions *)requestOptions;
+// Copies data into block buffers, uploading each as it fills.  If blocking is NO and every upload slot is in use, this returns
+// the number of bytes taken so far (possibly 0) instead of waiting for an upload to complete.
+-(NSInteger)write:(const uint8_t *)buffer maxLength:(NSUInteger)length blocking:(BOOL)blocking completionHandler:(void(^)())completionHandler;
 -(void)openWithCompletionHandler:(void(^)(BOOL))completionHandler;
+// Uploads any remaining data, then commits the blob once the last block upload completes, without blocking the caller.
+-(void)finishWithBlockCompletionHandler:(void(^)())blockCompletionHandler completionHandler:(void(^)(NSError * __AZSNullable))completionHandler;
+// Synchronous form of finishWithBlockCompletionHandler:completionHandler:.
 -(BOOL)closeWithCompletionHandler:(void(^)())completionHandler;
 -(BOOL)hasSpaceAvailable;
 -(BOOL)allDataUploaded;
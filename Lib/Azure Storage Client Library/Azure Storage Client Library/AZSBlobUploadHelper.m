@@ -16,6 +16,7 @@
 // -----------------------------------------------------------------------------------------
 
 #import <CommonCrypto/CommonDigest.h>
+#import <zlib.h>
 #import "AZSConstants.h"
 #import "AZSErrors.h"
 #import "AZSBlobUploadHelper.h"
@@ -27,25 +28,49 @@
 #import "AZSOperationContext.h"
 #import "AZSBlobProperties.h"
 #import "AZSAccessCondition.h"
+#import "AZSMemoryGovernor.h"
+#import "AZSBlockBufferPool.h"
+#import "AZSUtil.h"
+#import "AZSCRC64.h"
+#import "AZSTransformChain.h"
 
 @interface AZSBlobUploadHelper()
 {
     CC_MD5_CTX _md5Context;
+    z_stream _deflateStream;
 }
 
 @property (strong) AZSCloudBlob *underlyingBlob;
 @property (strong) NSMutableData *dataBuffer;
+@property NSUInteger dataBufferSize;
+@property NSUInteger dataBufferLength;
+@property NSUInteger dataBufferReservation;
+@property NSUInteger autoBlockSize;
+@property NSUInteger blocksAllocated;
 @property dispatch_semaphore_t blockUploadSemaphore;
+@property dispatch_queue_t blobHashQueue;
+@property dispatch_group_t blockCRC64Group;
+@property (strong) NSMutableDictionary *blockCRC64s;
 @property (strong) NSMutableArray *blockIDs;
 @property NSUInteger chunksTotal;
 @property NSUInteger chunksUploaded;
 @property NSUInteger blobOffset;
+@property NSUInteger appendedOffset;
+@property (strong) NSCondition *appendCondition;
+@property (strong) NSMutableDictionary *completedAppendLengths;
 @property NSInteger maxOpenUploads;
 @property BOOL streamWaiting;
 @property (strong) NSObject *uploadLock;
 @property (strong) AZSAccessCondition *accessCondition;
 @property (strong) AZSBlobRequestOptions *requestOptions;
 @property (copy) void (^completionHandler)(NSError*);
+@property (copy) void (^blockCompletionHandler)();
+@property (copy) void (^finishHandler)(NSError*);
+@property BOOL committing;
+@property BOOL compressing;
+@property BOOL compressionFinished;
+@property (strong) NSMutableData *compressionInputBuffer;
+@property BOOL transformFinished;
 @property BOOL createNew;
 @property NSNumber *totalPageBlobSize;
 @property NSNumber *initialPageBlobSequenceNumber;
@@ -65,6 +90,14 @@
     return nil;
 }
 
+-(void)dealloc
+{
+    if (_compressing)
+    {
+        deflateEnd(&_deflateStream);
+    }
+}
+
 -(instancetype)initToBlockBlob:(AZSCloudBlockBlob *)blockBlob accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^  __AZSNullable)(NSError*))completionHandler
 {
     self = [super init];
@@ -72,8 +105,21 @@
     {
         _underlyingBlob = blockBlob;
         _blobType = AZSBlobTypeBlockBlob;
-        _dataBuffer = [NSMutableData dataWithCapacity:AZSCMaxBlockSize];  //TODO: This should be user-settable.
+        _dataBuffer = nil;
         _blockIDs = [NSMutableArray arrayWithCapacity:10];
+        _compressing = NO;
+        if (requestOptions.contentCompression != AZSContentCompressionNone)
+        {
+            // windowBits above 15 asks zlib for a gzip wrapper instead of a zlib one.
+            BOOL gzip = (requestOptions.contentCompression == AZSContentCompressionGzip);
+            _compressing = (deflateInit2(&_deflateStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzip ? (MAX_WBITS + 16) : MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+            if (_compressing)
+            {
+                blockBlob.properties.contentEncoding = gzip ? AZSCContentEncodingGzip : AZSCContentEncodingDeflate;
+            }
+        }
+        _compressionFinished = NO;
+        _transformFinished = NO;
         _maxOpenUploads = requestOptions.parallelismFactor;
         _blockUploadSemaphore = dispatch_semaphore_create(self.maxOpenUploads);
         _streamWaiting = NO;
@@ -85,8 +131,11 @@
         if (requestOptions.storeBlobContentMD5)
         {
             CC_MD5_Init(&_md5Context);
+            _blobHashQueue = dispatch_queue_create("com.microsoft.azure.storage.blobhash", DISPATCH_QUEUE_SERIAL);
         }
         _streamingError = nil;
+        _blockCRC64Group = dispatch_group_create();
+        _blockCRC64s = [NSMutableDictionary dictionary];
         _createNew = NO;
     }
     return self;
@@ -99,7 +148,7 @@
     {
         _underlyingBlob = pageBlob;
         _blobType = AZSBlobTypePageBlob;
-        _dataBuffer = [NSMutableData dataWithCapacity:AZSCMaxBlockSize];  //TODO: This should be user-settable.
+        _dataBuffer = nil;
         _maxOpenUploads = requestOptions.parallelismFactor;
         _blockUploadSemaphore = dispatch_semaphore_create(self.maxOpenUploads);
         _streamWaiting = NO;
@@ -111,8 +160,22 @@
         if (requestOptions.storeBlobContentMD5)
         {
             CC_MD5_Init(&_md5Context);
+            _blobHashQueue = dispatch_queue_create("com.microsoft.azure.storage.blobhash", DISPATCH_QUEUE_SERIAL);
         }
         _streamingError = nil;
+        _blockCRC64Group = dispatch_group_create();
+        _blockCRC64s = [NSMutableDictionary dictionary];
+        
+        // Page blob writes must be page-aligned, so every block (including one cut short by the memory governor) must be whole pages.
+        if ((requestOptions.blockSize % 512) != 0)
+        {
+            _streamingError = [NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"For page blobs, the block size must be a multiple of 512 bytes."}];
+        }
+        else if (requestOptions.memoryGovernor && (requestOptions.memoryGovernor.maximumBytes < 512))
+        {
+            _streamingError = [NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"For page blobs, the memory governor must allow at least 512 bytes."}];
+        }
+        
         if (totalBlobSize)
         {
             _createNew = YES;
@@ -130,9 +193,13 @@
     {
         _underlyingBlob = appendBlob;
         _blobType = AZSBlobTypeAppendBlob;
-        _dataBuffer = [NSMutableData dataWithCapacity:AZSCMaxBlockSize];  //TODO: This should be the user-settable.
-        _maxOpenUploads = 1; //TODO: Investigate if this should always be 1, or if we should use the value in requestOptions.parallelismFactor.
+        _dataBuffer = nil;
+        _maxOpenUploads = MAX(requestOptions.parallelismFactor, 1);
         _blockUploadSemaphore = dispatch_semaphore_create(self.maxOpenUploads);
+        _blobOffset = accessCondition.appendPosition.unsignedIntegerValue;
+        _appendedOffset = _blobOffset;
+        _appendCondition = [[NSCondition alloc] init];
+        _completedAppendLengths = [NSMutableDictionary dictionary];
         _streamWaiting = NO;
         _uploadLock = [[NSObject alloc] init];
         _accessCondition = accessCondition ?: [[AZSAccessCondition alloc] init];
@@ -142,8 +209,11 @@
         if (requestOptions.storeBlobContentMD5)
         {
             CC_MD5_Init(&_md5Context);
+            _blobHashQueue = dispatch_queue_create("com.microsoft.azure.storage.blobhash", DISPATCH_QUEUE_SERIAL);
         }
         _streamingError = nil;
+        _blockCRC64Group = dispatch_group_create();
+        _blockCRC64s = [NSMutableDictionary dictionary];
         _createNew = createNew;
     }
     return self;
@@ -169,50 +239,400 @@
     }
 }
 
--(NSInteger)write:(const uint8_t *)buffer maxLength:(NSUInteger)maxLength completionHandler:(void(^)())completionHandler
+// The smallest and largest block sizes chosen automatically.  Below the minimum, per-request overhead dominates.
+static const NSUInteger AZSMinimumAutoBlockSize = 256 * 1024;
+
+// In automatic mode, blocks that upload faster than this are too small to amortize latency, and the block size is doubled.
+static const NSTimeInterval AZSFastBlockUploadTime = 1.0;
+
+// In automatic mode, blocks that take longer than this make retries expensive, and the block size is halved.
+static const NSTimeInterval AZSSlowBlockUploadTime = 10.0;
+
+// The service limits a blob to 50,000 blocks.
+static const NSUInteger AZSMaxBlockCount = 50000;
+
++(NSUInteger)blockSizeForLength:(unsigned long long)length requestOptions:(AZSBlobRequestOptions *)requestOptions
+{
+    if (requestOptions.blockSize != 0)
+    {
+        return MIN(requestOptions.blockSize, (NSUInteger)AZSCMaxBlockSize);
+    }
+    
+    if (length == 0)
+    {
+        return AZSCKilobyte * AZSCKilobyte;
+    }
+    
+    // Aim for enough blocks to keep every parallel upload busy a few times over, but never so many that the block limit is hit.
+    unsigned long long targetBlockCount = MAX(requestOptions.parallelismFactor, 1) * 4;
+    unsigned long long blockSize = (length + targetBlockCount - 1) / targetBlockCount;
+    blockSize = MAX(blockSize, (length + AZSMaxBlockCount - 1) / AZSMaxBlockCount);
+    return [AZSBlobUploadHelper clampedAutoBlockSize:blockSize];
+}
+
+// Rounds up to a power of two (so that the size is page-aligned), within the automatic range.
++(NSUInteger)clampedAutoBlockSize:(unsigned long long)blockSize
+{
+    NSUInteger clampedSize = AZSMinimumAutoBlockSize;
+    while ((clampedSize < blockSize) && (clampedSize < AZSCMaxBlockSize))
+    {
+        clampedSize *= 2;
+    }
+    return MIN(clampedSize, (NSUInteger)AZSCMaxBlockSize);
+}
+
+-(NSUInteger)nextBlockSize
+{
+    NSUInteger blockSize = self.requestOptions.blockSize;
+    if (blockSize != 0)
+    {
+        return MIN(blockSize, (NSUInteger)AZSCMaxBlockSize);
+    }
+    
+    @synchronized(self)
+    {
+        if (self.autoBlockSize == 0)
+        {
+            self.autoBlockSize = [AZSBlobUploadHelper blockSizeForLength:self.expectedLength requestOptions:self.requestOptions];
+        }
+        
+        // With an unknown length, switch to the largest blocks well before the block limit is reached.
+        if ((self.blobType == AZSBlobTypeBlockBlob) && (self.blocksAllocated >= AZSMaxBlockCount / 2))
+        {
+            self.autoBlockSize = AZSCMaxBlockSize;
+        }
+        
+        self.blocksAllocated++;
+        return self.autoBlockSize;
+    }
+}
+
+// In automatic mode, adjusts the block size based on how long a full block took to upload.
+-(void)recordBlockUploadWithLength:(NSUInteger)length duration:(NSTimeInterval)duration
+{
+    if ((self.requestOptions.blockSize != 0) || (length < self.autoBlockSize))
+    {
+        return;
+    }
+    
+    @synchronized(self)
+    {
+        if ((duration < AZSFastBlockUploadTime) && (self.autoBlockSize < AZSCMaxBlockSize))
+        {
+            self.autoBlockSize = [AZSBlobUploadHelper clampedAutoBlockSize:(self.autoBlockSize * 2)];
+            [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Block uploaded in %.2f seconds, increasing block size to %lu.", duration, (unsigned long)self.autoBlockSize];
+        }
+        else if ((duration > AZSSlowBlockUploadTime) && (self.autoBlockSize > AZSMinimumAutoBlockSize) && (self.blocksAllocated < AZSMaxBlockCount / 2))
+        {
+            self.autoBlockSize = self.autoBlockSize / 2;
+            [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Block uploaded in %.2f seconds, decreasing block size to %lu.", duration, (unsigned long)self.autoBlockSize];
+        }
+    }
+}
+
+// Allocates the buffer for the next block.  If there is a memory governor, the buffer is reserved from it; when memory is
+// short, a smaller block is used rather than waiting for a full-size one.
+-(void)allocateDataBuffer
+{
+    NSUInteger desiredBlockSize = [self nextBlockSize];
+    NSUInteger blockSize = desiredBlockSize;
+    NSUInteger reservation = 0;
+    AZSMemoryGovernor *memoryGovernor = self.requestOptions.memoryGovernor;
+    if (memoryGovernor)
+    {
+        // The minimum must stay a multiple of 512 bytes, as page blob writes must be page-aligned.
+        reservation = [memoryGovernor reserveBytes:desiredBlockSize minimumBytes:MIN(64 * AZSCKilobyte, desiredBlockSize)];
+        blockSize = reservation - (reservation % 512);
+        if (blockSize == 0)
+        {
+            // The governor's total budget is smaller than a page; use it all rather than failing.  Page blob uploads reject such a
+            // budget when they are created, so this only happens for block and append blobs.
+            blockSize = reservation;
+        }
+        [memoryGovernor releaseBytes:(reservation - blockSize)];
+        reservation = blockSize;
+        
+        if (blockSize < desiredBlockSize)
+        {
+            [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Memory governor budget is low, using a block size of %lu.", (unsigned long)blockSize];
+        }
+    }
+    
+    self.dataBuffer = [[AZSBlockBufferPool sharedPool] bufferWithLength:blockSize];
+    self.dataBufferSize = blockSize;
+    self.dataBufferLength = 0;
+    self.dataBufferReservation = reservation;
+}
+
+-(NSInteger)write:(const uint8_t *)buffer maxLength:(NSUInteger)maxLength blocking:(BOOL)blocking completionHandler:(void(^)())completionHandler
 {
     if (self.streamingError)
     {
         return -1;
     }
     
-    // TODO: Make this configurable.
-    NSUInteger maxSizePerBlock = AZSCMaxBlockSize;
-    int bytesCopied = 0;
+    if (self.compressing)
+    {
+        return [self compressBytes:buffer length:maxLength finish:NO blocking:blocking completionHandler:completionHandler];
+    }
+    
+    NSUInteger bytesCopied = 0;
     
     while (bytesCopied < maxLength)
     {
-        NSUInteger bytesToAppend = MIN(maxLength - bytesCopied, maxSizePerBlock - [self.dataBuffer length]);
-        [self.dataBuffer appendBytes:(buffer + bytesCopied) length:bytesToAppend];
+        if (!self.dataBuffer)
+        {
+            [self allocateDataBuffer];
+        }
+        
+        // A full buffer here was left by a non-blocking write that found no free upload slot.
+        if ((self.dataBufferSize == self.dataBufferLength) && ![self uploadBufferBlocking:blocking completionHandler:completionHandler])
+        {
+            break;
+        }
+        if (!self.dataBuffer)
+        {
+            continue;
+        }
+        
+        NSUInteger bytesToAppend = MIN(maxLength - bytesCopied, self.dataBufferSize - self.dataBufferLength);
+        memcpy(((uint8_t *)self.dataBuffer.mutableBytes) + self.dataBufferLength, buffer + bytesCopied, bytesToAppend);
+        self.dataBufferLength += bytesToAppend;
         bytesCopied += bytesToAppend;
         
-        if (maxSizePerBlock == [self.dataBuffer length])
+        if (self.dataBufferSize == self.dataBufferLength)
         {
-            [self uploadBufferWithCompletionHandler:completionHandler];
+            [self uploadBufferBlocking:blocking completionHandler:completionHandler];
         }
     }
     
-    return maxLength;
+    return bytesCopied;
 }
 
-// TODO: Consider having this method fail, rather than block, in the cannot-acquire-semaphore case.
--(BOOL) uploadBufferWithCompletionHandler:(void(^)())completionHandler
+// Reads from the stream straight into the current block buffer, as much as the buffer has room for.
+-(NSInteger)readFromStream:(NSInputStream *)inputStream completionHandler:(void(^)())completionHandler
 {
-    [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Uploading buffer, buffer size = %ld", (unsigned long)[self.dataBuffer length]];
-    dispatch_semaphore_wait(self.blockUploadSemaphore, DISPATCH_TIME_FOREVER);
+    if (self.streamingError)
+    {
+        return -1;
+    }
+    
+    if (self.compressing)
+    {
+        // Data read from the stream is staged, then compressed into the block buffers.
+        if (!self.compressionInputBuffer)
+        {
+            self.compressionInputBuffer = [NSMutableData dataWithLength:(64 * AZSCKilobyte)];
+        }
+        NSInteger bytesRead = [inputStream read:self.compressionInputBuffer.mutableBytes maxLength:self.compressionInputBuffer.length];
+        if (bytesRead > 0)
+        {
+            [self compressBytes:self.compressionInputBuffer.bytes length:bytesRead finish:NO blocking:YES completionHandler:completionHandler];
+        }
+        return bytesRead;
+    }
+    
+    if (!self.dataBuffer)
+    {
+        [self allocateDataBuffer];
+    }
+    
+    NSInteger bytesRead = [inputStream read:(((uint8_t *)self.dataBuffer.mutableBytes) + self.dataBufferLength) maxLength:(self.dataBufferSize - self.dataBufferLength)];
+    if (bytesRead > 0)
+    {
+        self.dataBufferLength += bytesRead;
+        if (self.dataBufferSize == self.dataBufferLength)
+        {
+            [self uploadBufferBlocking:YES completionHandler:completionHandler];
+        }
+    }
+    
+    return bytesRead;
+}
+
+// Compresses data into the block buffers, uploading each as it fills.  With finish set, the input is the end of the data, and
+// compression finishes (compressionFinished is set) once all of the compressed output has been buffered.  Returns the number of
+// input bytes consumed, which is less than length only if blocking is NO and every upload slot is in use, or -1 on error.
+-(NSInteger)compressBytes:(const uint8_t *)bytes length:(NSUInteger)length finish:(BOOL)finish blocking:(BOOL)blocking completionHandler:(void(^)())completionHandler
+{
+    NSUInteger bytesConsumed = 0;
+    while (!self.compressionFinished)
+    {
+        if (!self.dataBuffer)
+        {
+            [self allocateDataBuffer];
+        }
+        
+        if ((self.dataBufferSize == self.dataBufferLength) && ![self uploadBufferBlocking:blocking completionHandler:completionHandler])
+        {
+            break;
+        }
+        if (!self.dataBuffer)
+        {
+            continue;
+        }
+        
+        _deflateStream.next_in = (Bytef *)(bytes + bytesConsumed);
+        _deflateStream.avail_in = (uInt)(length - bytesConsumed);
+        _deflateStream.next_out = ((Bytef *)self.dataBuffer.mutableBytes) + self.dataBufferLength;
+        _deflateStream.avail_out = (uInt)(self.dataBufferSize - self.dataBufferLength);
+        int result = deflate(&_deflateStream, finish ? Z_FINISH : Z_NO_FLUSH);
+        bytesConsumed = length - _deflateStream.avail_in;
+        self.dataBufferLength = self.dataBufferSize - _deflateStream.avail_out;
+        
+        if (result == Z_STREAM_END)
+        {
+            self.compressionFinished = YES;
+        }
+        else if ((result != Z_OK) && (result != Z_BUF_ERROR))
+        {
+            [self.operationContext logAtLevel:AZSLogLevelError withMessage:@"Compression failed, zlib error = %d.", result];
+            self.streamingError = [NSError errorWithDomain:AZSErrorDomain code:AZSEOutputStreamError userInfo:@{NSLocalizedDescriptionKey:@"Compressing the blob data failed."}];
+            return -1;
+        }
+        
+        // Without finish, deflate is done for now once it has taken all the input and still has room to spare.
+        if (!finish && (bytesConsumed == length) && (_deflateStream.avail_out > 0))
+        {
+            break;
+        }
+    }
+    
+    return bytesConsumed;
+}
+
+// Runs a buffer through the upload transform chain, in place where the stages allow it.  Returns the data to send instead, or nil
+// if the chain failed, in which case streamingError is set.
+-(NSData *)transformBuffer:(NSMutableData *)buffer length:(NSUInteger)length final:(BOOL)final maximumLength:(NSUInteger)maximumLength
+{
+    NSMutableData *slice = buffer ? buffer : [NSMutableData data];
+    [slice setLength:length];
+    if (final)
+    {
+        self.transformFinished = YES;
+    }
+    
+    AZSTransformChain *transformChain = self.requestOptions.uploadTransformChain;
+    NSError *error = nil;
+    NSData *transformedData = [transformChain transformData:slice mutable:YES final:final error:&error];
+    if (transformedData && (self.blobType == AZSBlobTypePageBlob) && (transformedData.length != length))
+    {
+        error = [NSError errorWithDomain:AZSErrorDomain code:AZSETransformError userInfo:@{NSLocalizedDescriptionKey:@"Transform stages must not change the length of page blob data."}];
+    }
+    else if (transformedData.length > maximumLength)
+    {
+        error = [NSError errorWithDomain:AZSErrorDomain code:AZSETransformError userInfo:@{NSLocalizedDescriptionKey:@"Transformed data is larger than the service allows in a single request."}];
+    }
+    
+    if (error)
+    {
+        if (transformedData)
+        {
+            [transformChain recycleBuffer:transformedData];
+        }
+        self.streamingError = error;
+        return nil;
+    }
+    
+    return transformedData;
+}
+
+-(BOOL) uploadBufferBlocking:(BOOL)blocking completionHandler:(void(^)())completionHandler
+{
+    return [self uploadBufferBlocking:blocking final:NO completionHandler:completionHandler];
+}
+
+// Starts uploading the current buffer.  If every upload slot is in use, this waits for one, or, if blocking is NO, returns NO
+// and leaves the buffer in place.  final marks the last buffer of the upload, for the transform chain.
+-(BOOL) uploadBufferBlocking:(BOOL)blocking final:(BOOL)final completionHandler:(void(^)())completionHandler
+{
+    if (dispatch_semaphore_wait(self.blockUploadSemaphore, blocking ? DISPATCH_TIME_FOREVER : DISPATCH_TIME_NOW) != 0)
+    {
+        return NO;
+    }
+    [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Uploading buffer, buffer size = %ld", (unsigned long)self.dataBufferLength];
+    
+    // The block is sent straight from the pooled buffer, which goes back to the pool once the upload completes.
+    NSMutableData *poolBuffer = self.dataBuffer;
+    NSUInteger poolBufferSize = self.dataBufferSize;
+    NSData *blockData = poolBuffer ? [NSData dataWithBytesNoCopy:poolBuffer.mutableBytes length:self.dataBufferLength freeWhenDone:NO] : [NSData data];
+    AZSBlockBufferPool *bufferPool = [AZSBlockBufferPool sharedPool];
+    NSUInteger blockReservation = self.dataBufferReservation;
+    AZSMemoryGovernor *memoryGovernor = self.requestOptions.memoryGovernor;
+    AZSTransformChain *transformChain = self.requestOptions.uploadTransformChain;
+    NSUInteger dataLength = self.dataBufferLength;
+    self.dataBuffer = nil;
+    self.dataBufferLength = 0;
+    self.dataBufferReservation = 0;
+    
+    if (transformChain)
+    {
+        // Blocks pass through the chain in write order, before they are hashed and sent.
+        blockData = [self transformBuffer:poolBuffer length:dataLength final:final maximumLength:AZSCMaxBlockSize];
+        if (blockData.length == 0)
+        {
+            // Nothing to send: the chain failed, or is holding the data back.
+            if (blockData)
+            {
+                [transformChain recycleBuffer:blockData];
+            }
+            [memoryGovernor releaseBytes:blockReservation];
+            if (poolBuffer)
+            {
+                [poolBuffer setLength:poolBufferSize];
+                [bufferPool returnBuffer:poolBuffer];
+            }
+            dispatch_semaphore_signal(self.blockUploadSemaphore);
+            return YES;
+        }
+    }
+    
+    NSUInteger blockIndex = 0;
     @synchronized(self)
     {
+        blockIndex = self.chunksTotal;
         self.chunksTotal++;
     }
     
-    NSData *blockData = self.dataBuffer;
-    self.dataBuffer = [NSMutableData dataWithCapacity:AZSCMaxBlockSize];
-    
+    // The whole-blob MD5 is fed on a serial queue, in the order the blocks were written, while the block uploads.  The buffer
+    // can't be reused until both are done with it.
+    dispatch_group_t blobHashGroup = dispatch_group_create();
     if (self.requestOptions.storeBlobContentMD5)
     {
-        CC_MD5_Update(&_md5Context, blockData.bytes, (unsigned int) blockData.length);
+        dispatch_group_async(blobHashGroup, self.blobHashQueue, ^{
+            CC_MD5_Update(&_md5Context, blockData.bytes, (unsigned int) blockData.length);
+        });
+    }
+    if (self.requestOptions.useContentCRC64)
+    {
+        // Block checksums don't depend on each other, so they are calculated in parallel and combined at commit.
+        dispatch_group_enter(self.blockCRC64Group);
+        dispatch_group_async(blobHashGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            uint64_t crc = [AZSCRC64 crc64FromData:blockData];
+            @synchronized(self.blockCRC64s)
+            {
+                self.blockCRC64s[[NSNumber numberWithUnsignedInteger:blockIndex]] = @[[NSNumber numberWithUnsignedLongLong:crc], [NSNumber numberWithUnsignedInteger:blockData.length]];
+            }
+            dispatch_group_leave(self.blockCRC64Group);
+        });
     }
+    void (^releaseBuffer)() = ^{
+        dispatch_group_notify(blobHashGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [memoryGovernor releaseBytes:blockReservation];
+            if (transformChain)
+            {
+                [transformChain recycleBuffer:blockData];
+                [poolBuffer setLength:poolBufferSize];
+            }
+            if (poolBuffer)
+            {
+                [bufferPool returnBuffer:poolBuffer];
+            }
+        });
+    };
     
+    // Offsets and block IDs are assigned here, in write order; only sending the block waits for its hash.
+    void (^sendBlock)(NSString *) = nil;
     switch (self.blobType)
     {
         case AZSBlobTypeBlockBlob:
@@ -221,19 +641,28 @@
             [self.blockIDs addObject:[[AZSBlockListItem alloc] initWithBlockID:blockID blockListMode:AZSBlockListModeLatest size:blockData.length]];
             
             AZSCloudBlockBlob *blob = (AZSCloudBlockBlob *)self.underlyingBlob;
-            [blob uploadBlockFromData:blockData blockID:blockID contentMD5:nil accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * error)
-             {
-                 if (error)
-                 {
-                     self.streamingError = error;
-                 }
-                 @synchronized(self)
+            sendBlock = ^(NSString *contentMD5) {
+                NSDate *uploadStartTime = [NSDate date];
+                [blob uploadBlockFromData:blockData blockID:blockID contentMD5:contentMD5 accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * error)
                  {
-                     self.chunksUploaded++;
-                 }
-                 dispatch_semaphore_signal(self.blockUploadSemaphore);
-                 completionHandler();
-             }];
+                     if (error)
+                     {
+                         self.streamingError = error;
+                     }
+                     else
+                     {
+                         [self recordBlockUploadWithLength:blockData.length duration:-[uploadStartTime timeIntervalSinceNow]];
+                     }
+                     releaseBuffer();
+                     @synchronized(self)
+                     {
+                         self.chunksUploaded++;
+                     }
+                     dispatch_semaphore_signal(self.blockUploadSemaphore);
+                     completionHandler();
+                     [self advanceFinish];
+                 }];
+            };
             break;
         }
         case AZSBlobTypePageBlob:
@@ -245,23 +674,32 @@
             }
             
             AZSCloudPageBlob *blob = (AZSCloudPageBlob *)self.underlyingBlob;
-            [blob uploadPagesWithData:blockData startOffset:[NSNumber numberWithUnsignedInteger:currentOffset] contentMD5:nil accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * _Nullable error) {
-                if (error)
-                {
-                    self.streamingError = error;
-                }
-                @synchronized(self)
-                {
-                    self.chunksUploaded++;
-                }
-                dispatch_semaphore_signal(self.blockUploadSemaphore);
-                completionHandler();
-            }];
+            sendBlock = ^(NSString *contentMD5) {
+                NSDate *uploadStartTime = [NSDate date];
+                [blob uploadPagesWithData:blockData startOffset:[NSNumber numberWithUnsignedInteger:currentOffset] contentMD5:contentMD5 accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * _Nullable error) {
+                    if (error)
+                    {
+                        self.streamingError = error;
+                    }
+                    else
+                    {
+                        [self recordBlockUploadWithLength:blockData.length duration:-[uploadStartTime timeIntervalSinceNow]];
+                    }
+                    releaseBuffer();
+                    @synchronized(self)
+                    {
+                        self.chunksUploaded++;
+                    }
+                    dispatch_semaphore_signal(self.blockUploadSemaphore);
+                    completionHandler();
+                    [self advanceFinish];
+                }];
+            };
             break;
         }
         case AZSBlobTypeAppendBlob:
         {
-            // Here we worry about simultaneous uploads.
+            // Offsets are handed out in the order the data was written, which is the order the appends must be applied in.
             NSUInteger currentOffset = 0;
             @synchronized(self) {
                 currentOffset = self.blobOffset;
@@ -271,40 +709,43 @@
             if ((self.accessCondition.maxSize) && (self.accessCondition.maxSize.unsignedIntegerValue < self.blobOffset))
             {
                 // TODO: improve this error
+                [self.appendCondition lock];
                 self.streamingError = [NSError errorWithDomain:AZSErrorDomain code:AZSEOutputStreamError userInfo:nil];
+                [self.appendCondition broadcast];
+                [self.appendCondition unlock];
+                releaseBuffer();
+                @synchronized(self)
+                {
+                    self.chunksUploaded++;
+                }
                 dispatch_semaphore_signal(self.blockUploadSemaphore);
 
                 completionHandler();
+                [self advanceFinish];
             }
             else
             {
-                AZSCloudAppendBlob *blob = (AZSCloudAppendBlob *)self.underlyingBlob;
-                
-                self.accessCondition.appendPosition = [NSNumber numberWithUnsignedInteger:currentOffset];
-                
-                NSUInteger currentResultsCount = self.operationContext.requestResults.count;
-                
-                [blob appendBlockWithData:blockData contentMD5:nil accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * _Nullable error, NSNumber * _Nonnull appendOffset) {
-                    if (error)
-                    {
-                        // check for stuff
-                        
-                        if (self.requestOptions.absorbConditionalErrorsOnRetry && (error.userInfo[AZSCHttpStatusCode] == [NSNumber numberWithInt:412]) && ([error.userInfo[AZSCXmlCode] isEqualToString:@"AppendPositionConditionNotMet"] || [error.userInfo[AZSCXmlCode] isEqualToString:@"MaxBlobSizeConditionNotMet"]) && (self.operationContext.requestResults.count - currentResultsCount > 1))
+                sendBlock = ^(NSString *contentMD5) {
+                    NSDate *uploadStartTime = [NSDate date];
+                    [self appendBlockData:blockData contentMD5:contentMD5 atOffset:currentOffset resent:NO completionHandler:^(NSError *error) {
+                        if (error)
                         {
-                            [self.operationContext logAtLevel:AZSLogLevelWarning withMessage:@"Pre-condition failure on a retry is being ignored as the request should have succeeded in the first attempt."];
+                            self.streamingError = error;
                         }
                         else
                         {
-                            self.streamingError = error;
+                            [self recordBlockUploadWithLength:blockData.length duration:-[uploadStartTime timeIntervalSinceNow]];
                         }
-                    }
-                    @synchronized(self)
-                    {
-                        self.chunksUploaded++;
-                    }
-                    dispatch_semaphore_signal(self.blockUploadSemaphore);
-                    completionHandler();
-                }];
+                        releaseBuffer();
+                        @synchronized(self)
+                        {
+                            self.chunksUploaded++;
+                        }
+                        dispatch_semaphore_signal(self.blockUploadSemaphore);
+                        completionHandler();
+                        [self advanceFinish];
+                    }];
+                };
             }
 
             break;
@@ -313,10 +754,126 @@
             break;
     }
     
+    if (sendBlock)
+    {
+        if (self.requestOptions.useTransactionalMD5)
+        {
+            // Blocks are hashed in parallel on worker threads, each going out as soon as its hash is ready.
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                sendBlock([AZSUtil calculateMD5FromData:blockData]);
+            });
+        }
+        else
+        {
+            sendBlock(nil);
+        }
+    }
     
     return YES;
 }
 
+// Appends one block at the given offset.  Up to maxOpenUploads appends are in flight at once, each conditional on its own append
+// position, so the service only applies them in order.  One that reaches the service before its predecessors fails that condition,
+// and is resent once they have all completed.
+-(void)appendBlockData:(NSData *)blockData contentMD5:(NSString *)contentMD5 atOffset:(NSUInteger)offset resent:(BOOL)resent completionHandler:(void (^)(NSError *))completionHandler
+{
+    AZSCloudAppendBlob *blob = (AZSCloudAppendBlob *)self.underlyingBlob;
+    AZSAccessCondition *accessCondition = [[AZSAccessCondition alloc] init];
+    accessCondition.leaseId = self.accessCondition.leaseId;
+    accessCondition.maxSize = self.accessCondition.maxSize;
+    accessCondition.appendPosition = [NSNumber numberWithUnsignedInteger:offset];
+    
+    // Whether this append could overtake an earlier one has to be decided when it is sent.  By the time its response arrives,
+    // the earlier appends may have completed, even though they had not reached the service when this one did.
+    [self.appendCondition lock];
+    BOOL predecessorsPending = self.appendedOffset < offset;
+    [self.appendCondition unlock];
+    
+    [blob appendBlockWithData:blockData contentMD5:contentMD5 accessCondition:accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * _Nullable error, NSNumber * _Nonnull appendOffset) {
+        if (error && ([error.userInfo[AZSCHttpStatusCode] isEqual:[NSNumber numberWithInt:412]]) && ([error.userInfo[AZSCXmlCode] isEqualToString:@"AppendPositionConditionNotMet"] || [error.userInfo[AZSCXmlCode] isEqualToString:@"MaxBlobSizeConditionNotMet"]))
+        {
+            if (!resent && predecessorsPending && [error.userInfo[AZSCXmlCode] isEqualToString:@"AppendPositionConditionNotMet"])
+            {
+                // Wait off the callback thread, since waiting holds the thread until the earlier appends complete.
+                dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                    [self.appendCondition lock];
+                    while (self.appendedOffset < offset && !self.streamingError)
+                    {
+                        [self.appendCondition wait];
+                    }
+                    [self.appendCondition unlock];
+                    
+                    if (self.streamingError)
+                    {
+                        completionHandler(self.streamingError);
+                        return;
+                    }
+                    
+                    [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Append block at offset %lu arrived before an earlier block, resending.", (unsigned long)offset];
+                    [self appendBlockData:blockData contentMD5:contentMD5 atOffset:offset resent:YES completionHandler:completionHandler];
+                });
+                return;
+            }
+            
+            if (self.requestOptions.absorbConditionalErrorsOnRetry)
+            {
+                // The other appends share the operation context, so its results can't tell whether this request was retried.
+                // Only absorb the failure if the blob really does hold this block at this offset.
+                [self verifyAppendedBlockData:blockData atOffset:offset conditionError:error completionHandler:^(NSError *verifiedError) {
+                    [self completeAppendOfLength:blockData.length atOffset:offset error:verifiedError completionHandler:completionHandler];
+                }];
+                return;
+            }
+        }
+        
+        [self completeAppendOfLength:blockData.length atOffset:offset error:error completionHandler:completionHandler];
+    }];
+}
+
+// Reads back the range an append was meant to write, after a pre-condition failure that may have been caused by a retry of an
+// attempt the service had already applied.  Completes with nil if the block is there, and with the original error otherwise.
+-(void)verifyAppendedBlockData:(NSData *)blockData atOffset:(NSUInteger)offset conditionError:(NSError *)conditionError completionHandler:(void (^)(NSError *))completionHandler
+{
+    [self.underlyingBlob downloadRanges:@[[NSValue valueWithAZSULLRange:AZSULLMakeRange(offset, blockData.length)]] gapThreshold:0 accessCondition:nil requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error, NSArray *slices) {
+        if (!error && [slices.firstObject isEqualToData:blockData])
+        {
+            [self.operationContext logAtLevel:AZSLogLevelWarning withMessage:@"Pre-condition failure on a retry is being ignored as the request should have succeeded in the first attempt."];
+            completionHandler(nil);
+        }
+        else
+        {
+            completionHandler(conditionError);
+        }
+    }];
+}
+
+-(void)completeAppendOfLength:(NSUInteger)length atOffset:(NSUInteger)offset error:(NSError *)error completionHandler:(void (^)(NSError *))completionHandler
+{
+    [self.appendCondition lock];
+    if (error)
+    {
+        // Wake any appends waiting on this one, so that they fail rather than wait forever.
+        if (!self.streamingError)
+        {
+            self.streamingError = error;
+        }
+    }
+    else
+    {
+        self.completedAppendLengths[[NSNumber numberWithUnsignedInteger:offset]] = [NSNumber numberWithUnsignedInteger:length];
+        NSNumber *nextLength = nil;
+        while ((nextLength = self.completedAppendLengths[[NSNumber numberWithUnsignedInteger:self.appendedOffset]]))
+        {
+            [self.completedAppendLengths removeObjectForKey:[NSNumber numberWithUnsignedInteger:self.appendedOffset]];
+            self.appendedOffset += nextLength.unsignedIntegerValue;
+        }
+    }
+    [self.appendCondition broadcast];
+    [self.appendCondition unlock];
+    
+    completionHandler(error);
+}
+
 -(BOOL)allDataUploaded
 {
     BOOL allDataUploaded = NO;
@@ -329,99 +886,277 @@
 
 -(BOOL)closeWithCompletionHandler:(void (^)())completionHandler
 {
-    // TODO: If there have been no put block calls yet, just call put blob, rather than put block / put block list.
-    if ((!self.streamingError) && (self.dataBuffer.length > 0))
+    // NSOutputStream's close is synchronous, so this waits for the asynchronous finish.
+    dispatch_semaphore_t finishedSemaphore = dispatch_semaphore_create(0);
+    [self finishWithBlockCompletionHandler:completionHandler completionHandler:^(NSError *error) {
+        dispatch_semaphore_signal(finishedSemaphore);
+    }];
+    dispatch_semaphore_wait(finishedSemaphore, DISPATCH_TIME_FOREVER);
+    return YES;
+}
+
+-(void)finishWithBlockCompletionHandler:(void (^)())blockCompletionHandler completionHandler:(void (^)(NSError *))completionHandler
+{
+    if (self.compressing && !self.streamingError)
     {
-        if (![self uploadBufferWithCompletionHandler:completionHandler])
+        // Usually the rest of the compressed data fits in the current buffer; if not, advanceFinish carries on once a slot is free.
+        @synchronized(self)
         {
-            return NO;
+            [self compressBytes:NULL length:0 finish:YES blocking:NO completionHandler:blockCompletionHandler];
+        }
+    }
+    
+    // If no blocks have been uploaded and the data is small enough, a single Put Blob replaces Put Block and Put Block List.
+    BOOL singleRequest = NO;
+    if ((self.blobType == AZSBlobTypeBlockBlob) && !self.streamingError && (!self.compressing || self.compressionFinished))
+    {
+        @synchronized(self)
+        {
+            singleRequest = (self.chunksTotal == 0) && (self.dataBufferLength <= MIN(self.requestOptions.singleBlobUploadThreshold, (NSUInteger)AZSCMaxSingleBlobUploadSize));
         }
     }
     
-    BOOL finished = NO;
+    if (singleRequest)
+    {
+        [self uploadBufferInSingleRequestWithCompletionHandler:completionHandler];
+        return;
+    }
+    
     @synchronized(self)
     {
-        finished = self.chunksTotal == self.chunksUploaded;
+        self.blockCompletionHandler = blockCompletionHandler;
+        self.finishHandler = completionHandler;
+    }
+    [self advanceFinish];
+}
+
+// Moves a finishing upload along without waiting: called when finishing starts and after each block upload completes.  Starts
+// the final block once an upload slot is free, and commits the blob once every block has been uploaded.
+-(void)advanceFinish
+{
+    BOOL commit = NO;
+    @synchronized(self)
+    {
+        if (!self.finishHandler || self.committing)
+        {
+            return;
+        }
+        
+        if (self.compressing && !self.compressionFinished && !self.streamingError)
+        {
+            [self compressBytes:NULL length:0 finish:YES blocking:NO completionHandler:self.blockCompletionHandler];
+            if (!self.compressionFinished && !self.streamingError)
+            {
+                return;
+            }
+        }
+        
+        BOOL transformPending = (self.requestOptions.uploadTransformChain != nil) && !self.transformFinished;
+        if ((!self.streamingError) && ((self.dataBufferLength > 0) || transformPending) && ![self uploadBufferBlocking:NO final:YES completionHandler:self.blockCompletionHandler])
+        {
+            // Every slot is in use; the next block to complete will try again.
+            return;
+        }
+        
+        // Starting the last block may have completed it inline (and committed), so check again.
+        if (!self.committing && (self.chunksTotal == self.chunksUploaded))
+        {
+            self.committing = YES;
+            commit = YES;
+        }
     }
     
-    while (!finished)
+    if (commit)
     {
-        // Spin until all blocks have been uploaded.
-        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
-        @synchronized(self)
+        [self commit];
+    }
+}
+
+-(void)commit
+{
+    // Release any buffer that won't be uploaded (empty, or abandoned due to an error.)
+    [self.requestOptions.memoryGovernor releaseBytes:self.dataBufferReservation];
+    if (self.dataBuffer)
+    {
+        [[AZSBlockBufferPool sharedPool] returnBuffer:self.dataBuffer];
+    }
+    self.dataBuffer = nil;
+    self.dataBufferLength = 0;
+    self.dataBufferReservation = 0;
+    
+    void (^finishHandler)(NSError *) = self.finishHandler;
+    self.finishHandler = nil;
+    self.blockCompletionHandler = nil;
+    void (^commitCompleted)(NSError *) = ^(NSError *error) {
+        if (!self.streamingError && error)
         {
-            finished = self.chunksTotal == self.chunksUploaded;
+            self.streamingError = error;
         }
+        finishHandler(self.streamingError);
+    };
+    
+    // A failed block would make the commit fail anyway, and committing would expose a partial blob.
+    if (self.streamingError)
+    {
+        commitCompleted(nil);
+        return;
     }
     
     if (self.requestOptions.storeBlobContentMD5)
     {
-        unsigned char md5Bytes[CC_MD5_DIGEST_LENGTH];
-        CC_MD5_Final(md5Bytes, &_md5Context);
-        self.underlyingBlob.properties.contentMD5 = [[[NSData alloc] initWithBytes:md5Bytes length:CC_MD5_DIGEST_LENGTH] base64EncodedStringWithOptions:0];
+        // Every block has been queued for hashing by now; wait for the hashing to drain.
+        NSData * __block md5 = nil;
+        dispatch_sync(self.blobHashQueue, ^{
+            unsigned char md5Bytes[CC_MD5_DIGEST_LENGTH];
+            CC_MD5_Final(md5Bytes, &_md5Context);
+            md5 = [[NSData alloc] initWithBytes:md5Bytes length:CC_MD5_DIGEST_LENGTH];
+        });
+        self.underlyingBlob.properties.contentMD5 = [md5 base64EncodedStringWithOptions:0];
+    }
+    
+    if ([self storesContentCRC64])
+    {
+        dispatch_group_notify(self.blockCRC64Group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            uint64_t crc = 0;
+            for (NSUInteger i = 0; i < self.chunksTotal; i++)
+            {
+                NSArray *blockCRC64 = self.blockCRC64s[[NSNumber numberWithUnsignedInteger:i]];
+                crc = [AZSCRC64 crc64ByCombiningCRC64:crc withCRC64:((NSNumber *)blockCRC64[0]).unsignedLongLongValue secondLength:((NSNumber *)blockCRC64[1]).unsignedLongLongValue];
+            }
+            self.underlyingBlob.metadata[AZSCContentCRC64MetadataKey] = [AZSCRC64 stringFromCRC64:crc];
+            [self commitBlobWithCompletionHandler:commitCompleted];
+        });
+        return;
     }
     
+    [self commitBlobWithCompletionHandler:commitCompleted];
+}
+
+// The CRC64 describes the whole blob, so it is only stored when this upload writes all of it.
+-(BOOL)storesContentCRC64
+{
+    if (!self.requestOptions.useContentCRC64)
+    {
+        return NO;
+    }
+    
+    switch (self.blobType)
+    {
+        case AZSBlobTypeBlockBlob:
+            return YES;
+        case AZSBlobTypePageBlob:
+            return self.createNew && (self.blobOffset == self.totalPageBlobSize.unsignedIntegerValue);
+        case AZSBlobTypeAppendBlob:
+            return self.createNew;
+        default:
+            return NO;
+    }
+}
+
+-(void)commitBlobWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    BOOL storeContentCRC64 = [self storesContentCRC64];
     switch (self.blobType) {
         case AZSBlobTypeBlockBlob:
         {
-            dispatch_semaphore_t blockListSemaphore = dispatch_semaphore_create(0);
-            
+            // The block list carries the blob's metadata, including any CRC64.  Drop a CRC64 left over from an earlier download,
+            // since it would no longer match.
+            if (!storeContentCRC64)
+            {
+                [self.underlyingBlob.metadata removeObjectForKey:AZSCContentCRC64MetadataKey];
+            }
             AZSCloudBlockBlob *blob = (AZSCloudBlockBlob *)self.underlyingBlob;
-            [blob uploadBlockListFromArray:self.blockIDs accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * error) {
-                if (!self.streamingError && error)
-                {
-                    self.streamingError = error;
-                }
-                
-                dispatch_semaphore_signal(blockListSemaphore);
-            }];
-            
-            dispatch_semaphore_wait(blockListSemaphore, DISPATCH_TIME_FOREVER);
+            [blob uploadBlockListFromArray:self.blockIDs accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:completionHandler];
             break;
         }
         case AZSBlobTypePageBlob:
+        case AZSBlobTypeAppendBlob:
         {
+            void (^uploadMetadata)(NSError *) = ^(NSError *error) {
+                if (!error && storeContentCRC64)
+                {
+                    [self.underlyingBlob uploadMetadataWithAccessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:completionHandler];
+                }
+                else
+                {
+                    completionHandler(error);
+                }
+            };
+            
             if (self.requestOptions.storeBlobContentMD5)
             {
-                dispatch_semaphore_t setPropertiesSemaphore = dispatch_semaphore_create(0);
-                
-                [self.underlyingBlob uploadPropertiesWithAccessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * _Nullable error) {
-                    if (!self.streamingError && error)
-                    {
-                        self.streamingError = error;
-                    }
-                    
-                    dispatch_semaphore_signal(setPropertiesSemaphore);
-                }];
-                
-                dispatch_semaphore_wait(setPropertiesSemaphore, DISPATCH_TIME_FOREVER);
+                [self.underlyingBlob uploadPropertiesWithAccessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:uploadMetadata];
             }
-            break;
-        }
-        case AZSBlobTypeAppendBlob:
-        {
-            if (self.requestOptions.storeBlobContentMD5)
+            else
             {
-                dispatch_semaphore_t setPropertiesSemaphore = dispatch_semaphore_create(0);
-                
-                [self.underlyingBlob uploadPropertiesWithAccessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * _Nullable error) {
-                    if (!self.streamingError && error)
-                    {
-                        self.streamingError = error;
-                    }
-                    
-                    dispatch_semaphore_signal(setPropertiesSemaphore);
-                }];
-                
-                dispatch_semaphore_wait(setPropertiesSemaphore, DISPATCH_TIME_FOREVER);
-            }            break;
+                uploadMetadata(nil);
+            }
+            break;
         }
-            
         default:
-            return NO;
+            completionHandler(nil);
             break;
     }
-    return YES;
+}
+
+-(void)uploadBufferInSingleRequestWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    NSMutableData *poolBuffer = self.dataBuffer;
+    NSUInteger poolBufferSize = self.dataBufferSize;
+    NSData * __block blobData = poolBuffer ? [NSData dataWithBytesNoCopy:poolBuffer.mutableBytes length:self.dataBufferLength freeWhenDone:NO] : [NSData data];
+    NSUInteger blobReservation = self.dataBufferReservation;
+    AZSMemoryGovernor *memoryGovernor = self.requestOptions.memoryGovernor;
+    AZSTransformChain *transformChain = self.requestOptions.uploadTransformChain;
+    NSUInteger dataLength = self.dataBufferLength;
+    self.dataBuffer = nil;
+    self.dataBufferLength = 0;
+    self.dataBufferReservation = 0;
+    
+    void (^releaseBuffer)() = ^{
+        [memoryGovernor releaseBytes:blobReservation];
+        if (transformChain)
+        {
+            [transformChain recycleBuffer:blobData];
+            [poolBuffer setLength:poolBufferSize];
+        }
+        if (poolBuffer)
+        {
+            [[AZSBlockBufferPool sharedPool] returnBuffer:poolBuffer];
+        }
+    };
+    
+    if (transformChain)
+    {
+        blobData = [self transformBuffer:poolBuffer length:dataLength final:YES maximumLength:AZSCMaxSingleBlobUploadSize];
+        if (!blobData)
+        {
+            releaseBuffer();
+            completionHandler(self.streamingError);
+            return;
+        }
+    }
+    
+    [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Uploading blob in a single request, size = %ld", (unsigned long)blobData.length];
+    if (self.requestOptions.useContentCRC64)
+    {
+        // Put Blob carries the blob's metadata.
+        self.underlyingBlob.metadata[AZSCContentCRC64MetadataKey] = [AZSCRC64 stringFromCRC64:[AZSCRC64 crc64FromData:blobData]];
+    }
+    else
+    {
+        [self.underlyingBlob.metadata removeObjectForKey:AZSCContentCRC64MetadataKey];
+    }
+    
+    AZSCloudBlockBlob *blob = (AZSCloudBlockBlob *)self.underlyingBlob;
+    [blob uploadFromDataInSingleRequest:blobData accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError * error) {
+        if (error)
+        {
+            self.streamingError = error;
+        }
+        
+        releaseBuffer();
+        completionHandler(self.streamingError);
+    }];
 }
 
 -(void)writeFromStreamCallbackWithStream:(NSInputStream *)inputStream;
@@ -430,24 +1165,33 @@
     {
         if (self.streamWaiting && [self hasSpaceAvailable])
         {
-            uint8_t buf[AZSCKilobyte];
-            NSUInteger len = 0;
-            
-            len = [inputStream read:buf maxLength:AZSCKilobyte];
-            if (len)
-            {
-                [self write:buf maxLength:len completionHandler:^{
-                    [self writeFromStreamCallbackWithStream:inputStream];
-                }];
-            }
+            [self readFromStream:inputStream completionHandler:^{
+                [self writeFromStreamCallbackWithStream:inputStream];
+            }];
             self.streamWaiting = NO;
         }
     }
 }
 
+// The upload completes on a network callback thread; the caller's handler expects the thread the source stream is scheduled on.
+-(void)callCompletionHandlerWithError:(NSError *)error onRunLoop:(CFRunLoopRef)runLoop
+{
+    if (!self.completionHandler)
+    {
+        return;
+    }
+    
+    void (^completionHandler)(NSError *) = self.completionHandler;
+    CFRunLoopPerformBlock(runLoop, kCFRunLoopCommonModes, ^{
+        completionHandler(error);
+    });
+    CFRunLoopWakeUp(runLoop);
+}
+
 - (void)stream:(NSStream *)stream handleEvent:(NSStreamEvent)eventCode
 {
     NSInputStream *inputStream = (NSInputStream *)stream;
+    CFRunLoopRef streamRunLoop = CFRunLoopGetCurrent();
     switch (eventCode) {
         case NSStreamEventHasBytesAvailable:
             // TODO: Stop reading if there was a error in uploading the blob?  Not sure if this is possible.
@@ -455,16 +1199,10 @@
             {
                 if ([self hasSpaceAvailable])
                 {
-                    uint8_t buf[AZSCKilobyte];
-                    NSUInteger len = 0;
-                
-                    len = [inputStream read:buf maxLength:AZSCKilobyte];  // The 0 and -1 case should be handled by the EndEncountered and ErrorOccurred events.
-                    if (len > 0)
-                    {
-                        [self write:buf maxLength:len completionHandler:^{
-                            [self writeFromStreamCallbackWithStream:inputStream];
-                        }];
-                    }
+                    // The 0 and -1 case should be handled by the EndEncountered and ErrorOccurred events.
+                    [self readFromStream:inputStream completionHandler:^{
+                        [self writeFromStreamCallbackWithStream:inputStream];
+                    }];
                 }
                 else
                 {
@@ -473,29 +1211,25 @@
             }
             break;
         case NSStreamEventEndEncountered:
-            // Note that the below method is syncronous for the time being.
-            [self closeWithCompletionHandler:^{
+            // The commit is started by the last block upload to complete, so this does not hold up the stream's thread.
+            [self finishWithBlockCompletionHandler:^{
                 ;
+            } completionHandler:^(NSError *error) {
+                [self callCompletionHandlerWithError:error onRunLoop:streamRunLoop];
             }];
-            
-            if (self.completionHandler)
-            {
-                self.completionHandler(self.streamingError);
-            }
             break;
         case NSStreamEventErrorOccurred:
         {
             NSError *error = inputStream.streamError;
             [self.operationContext logAtLevel:AZSLogLevelError withMessage:@"Error in stream callback.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo];
-            // Note that the below method is syncronous for the time being.
-            [self closeWithCompletionHandler:^{
+            
+            // Wait for outstanding uploads, but don't commit what was read before the error.
+            self.streamingError = error;
+            [self finishWithBlockCompletionHandler:^{
                 ;
+            } completionHandler:^(NSError *finishError) {
+                [self callCompletionHandlerWithError:error onRunLoop:streamRunLoop];
             }];
-            
-            if (self.completionHandler)
-            {
-                self.completionHandler(error);
-            }
             break;
         }
         default:
@@ -505,7 +1239,11 @@
 
 -(void)openWithCompletionHandler:(void (^)(BOOL))completionHandler
 {
-    if (!self.createNew)
+    if (self.streamingError)
+    {
+        completionHandler(NO);
+    }
+    else if (!self.createNew)
     {
         completionHandler(YES);
     }
@@ -0,0 +1,52 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlobUploadJournal.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+// This class is reserved for internal use.
+// A small on-disk record of a resumable block blob upload: the identity of the source and target, the block size, a prefix
+// that makes block IDs deterministic, and the index of each block staged so far (one line per block, appended as they finish.)
+@interface AZSBlobUploadJournal : NSObject
+
+@property (copy, readonly) NSString *journalPath;
+@property (readonly) NSUInteger blockSize;
+@property (copy, readonly) NSString *blockIDPrefix;
+
+// YES if the journal was loaded from a previous attempt, NO if it was just created.
+@property (readonly) BOOL resumed;
+
+// The blocks the journal recorded as staged when it was loaded.
+@property (strong, readonly) NSIndexSet *recordedBlocks;
+
+// Describes an upload of the given file to the given blob.  A journal only applies to an upload with the same identity.
++(NSDictionary *)sourceIdentityForFilePath:(NSString *)filePath attributes:(NSDictionary *)fileAttributes blobURL:(NSURL *)blobURL;
+
+// Loads the journal at journalPath if it describes the same source identity, or otherwise starts a new one there with the given block size.
++(AZSNullable AZSBlobUploadJournal *)journalAtPath:(NSString *)journalPath sourceIdentity:(NSDictionary *)sourceIdentity blockSize:(NSUInteger)blockSize error:(NSError **)error;
+
+// The block ID for the given block index.  All IDs have the same length.
+-(NSString *)blockIDForIndex:(NSUInteger)index;
+
+-(BOOL)recordBlock:(NSUInteger)index error:(NSError **)error;
+-(BOOL)removeWithError:(NSError **)error;
+
+@end
+
+AZS_ASSUME_NONNULL_END
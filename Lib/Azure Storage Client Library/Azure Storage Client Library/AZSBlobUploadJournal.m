@@ -0,0 +1,186 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlobUploadJournal.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSBlobUploadJournal.h"
+#import "AZSConstants.h"
+#import "AZSErrors.h"
+
+static NSString *const AZSJournalSourceKey = @"source";
+static NSString *const AZSJournalBlockSizeKey = @"blockSize";
+static NSString *const AZSJournalBlockIDPrefixKey = @"blockIDPrefix";
+
+@interface AZSBlobUploadJournal()
+
+@property (strong) NSFileHandle *fileHandle;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+-(instancetype)initWithPath:(NSString *)journalPath blockSize:(NSUInteger)blockSize blockIDPrefix:(NSString *)blockIDPrefix resumed:(BOOL)resumed recordedBlocks:(NSIndexSet *)recordedBlocks AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSBlobUploadJournal
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithPath:(NSString *)journalPath blockSize:(NSUInteger)blockSize blockIDPrefix:(NSString *)blockIDPrefix resumed:(BOOL)resumed recordedBlocks:(NSIndexSet *)recordedBlocks
+{
+    self = [super init];
+    if (self)
+    {
+        _journalPath = [journalPath copy];
+        _blockSize = blockSize;
+        _blockIDPrefix = [blockIDPrefix copy];
+        _resumed = resumed;
+        _recordedBlocks = recordedBlocks;
+    }
+
+    return self;
+}
+
+-(void)dealloc
+{
+    [_fileHandle closeFile];
+}
+
++(NSError *)journalErrorWithDescription:(NSString *)description innerError:(NSError *)innerError
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey];
+    if (innerError)
+    {
+        userInfo[AZSInnerErrorString] = innerError;
+    }
+    return [NSError errorWithDomain:AZSErrorDomain code:AZSEOutputStreamError userInfo:userInfo];
+}
+
++(NSDictionary *)sourceIdentityForFilePath:(NSString *)filePath attributes:(NSDictionary *)fileAttributes blobURL:(NSURL *)blobURL
+{
+    // The modification time is stored in whole nanoseconds, because a double need not survive the journal's JSON round trip exactly.
+    long long modified = llround([fileAttributes.fileModificationDate timeIntervalSince1970] * NSEC_PER_SEC);
+    return @{@"path":filePath, @"length":[NSNumber numberWithUnsignedLongLong:fileAttributes.fileSize], @"modified":[NSNumber numberWithLongLong:modified], @"blob":blobURL.absoluteString};
+}
+
++(AZSBlobUploadJournal *)journalAtPath:(NSString *)journalPath sourceIdentity:(NSDictionary *)sourceIdentity blockSize:(NSUInteger)blockSize error:(NSError **)error
+{
+    // The first line is a JSON header; each following complete line is the index of a staged block.  A trailing partial line,
+    // left by a crash mid-write, is ignored.
+    NSData *journalData = [NSData dataWithContentsOfFile:journalPath];
+    if (journalData)
+    {
+        NSString *journalText = [[NSString alloc] initWithData:journalData encoding:NSUTF8StringEncoding];
+        NSArray *lines = [journalText componentsSeparatedByString:@"\n"];
+        NSDictionary *header = nil;
+        if (lines.count > 1)
+        {
+            header = [NSJSONSerialization JSONObjectWithData:[lines[0] dataUsingEncoding:NSUTF8StringEncoding] options:0 error:nil];
+        }
+
+        // A header that doesn't describe this source, or that has been damaged, starts a new journal.
+        BOOL headerValid = [header isKindOfClass:[NSDictionary class]] && [header[AZSJournalSourceKey] isEqual:sourceIdentity] && [header[AZSJournalBlockIDPrefixKey] isKindOfClass:[NSString class]] && [header[AZSJournalBlockSizeKey] isKindOfClass:[NSNumber class]];
+        if (headerValid)
+        {
+            long long journalBlockSize = [header[AZSJournalBlockSizeKey] longLongValue];
+            headerValid = (journalBlockSize > 0) && (journalBlockSize <= AZSCMaxBlockSize);
+        }
+
+        if (headerValid)
+        {
+            NSMutableIndexSet *recordedBlocks = [NSMutableIndexSet indexSet];
+            for (NSUInteger i = 1; i < lines.count - 1; i++)
+            {
+                NSString *line = lines[i];
+                if (line.length > 0)
+                {
+                    [recordedBlocks addIndex:(NSUInteger)[line longLongValue]];
+                }
+            }
+
+            return [[AZSBlobUploadJournal alloc] initWithPath:journalPath blockSize:[header[AZSJournalBlockSizeKey] unsignedIntegerValue] blockIDPrefix:header[AZSJournalBlockIDPrefixKey] resumed:YES recordedBlocks:recordedBlocks];
+        }
+    }
+
+    NSString *blockIDPrefix = [[[[NSUUID UUID] UUIDString] stringByReplacingOccurrencesOfString:@"-" withString:@""] substringToIndex:16];
+    NSDictionary *header = @{AZSJournalSourceKey:sourceIdentity, AZSJournalBlockSizeKey:[NSNumber numberWithUnsignedInteger:blockSize], AZSJournalBlockIDPrefixKey:blockIDPrefix};
+    NSError *innerError = nil;
+    NSMutableData *headerData = [[NSJSONSerialization dataWithJSONObject:header options:0 error:&innerError] mutableCopy];
+    [headerData appendData:[@"\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    if (![headerData writeToFile:journalPath options:NSDataWritingAtomic error:&innerError])
+    {
+        if (error)
+        {
+            *error = [AZSBlobUploadJournal journalErrorWithDescription:@"Could not create the upload journal." innerError:innerError];
+        }
+        return nil;
+    }
+
+    return [[AZSBlobUploadJournal alloc] initWithPath:journalPath blockSize:blockSize blockIDPrefix:blockIDPrefix resumed:NO recordedBlocks:[NSIndexSet indexSet]];
+}
+
+-(NSString *)blockIDForIndex:(NSUInteger)index
+{
+    // A blob has at most 50,000 blocks, so six digits keep every ID the same length.
+    return [[[NSString stringWithFormat:@"%@-%06lu", self.blockIDPrefix, (unsigned long)index] dataUsingEncoding:NSUTF8StringEncoding] base64EncodedStringWithOptions:0];
+}
+
+-(BOOL)recordBlock:(NSUInteger)index error:(NSError **)error
+{
+    @synchronized(self)
+    {
+        if (!self.fileHandle)
+        {
+            self.fileHandle = [NSFileHandle fileHandleForWritingAtPath:self.journalPath];
+            if (!self.fileHandle)
+            {
+                if (error)
+                {
+                    *error = [AZSBlobUploadJournal journalErrorWithDescription:@"Could not open the upload journal." innerError:nil];
+                }
+                return NO;
+            }
+        }
+
+        [self.fileHandle seekToEndOfFile];
+        [self.fileHandle writeData:[[NSString stringWithFormat:@"%lu\n", (unsigned long)index] dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+
+    return YES;
+}
+
+-(BOOL)removeWithError:(NSError **)error
+{
+    @synchronized(self)
+    {
+        [self.fileHandle closeFile];
+        self.fileHandle = nil;
+    }
+
+    NSError *innerError = nil;
+    if (![[NSFileManager defaultManager] removeItemAtPath:self.journalPath error:&innerError])
+    {
+        if (error)
+        {
+            *error = [AZSBlobUploadJournal journalErrorWithDescription:@"Could not remove the upload journal." innerError:innerError];
+        }
+        return NO;
+    }
+
+    return YES;
+}
+
+@end
@@ -0,0 +1,125 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlockBlobMultipartWriter.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+@class AZSCloudBlockBlob;
+@class AZSAccessCondition;
+@class AZSBlobRequestOptions;
+@class AZSOperationContext;
+@class AZSBlockBlobMultipartWriter;
+
+/** An AZSBlockBlobPartWriter writes one part of a block blob being assembled by an AZSBlockBlobMultipartWriter.
+ 
+ Data written to a part is cut into blocks of the request options' blockSize, and each block is staged with Put Block as soon as it
+ is full, with up to parallelismFactor blocks of the part in flight at once.  When that many are in flight, writeData:error: blocks
+ until one completes.  Parts are independent of each other, so each part can be written by its own thread.  A single part must
+ not be written from more than one thread at once.
+ */
+@interface AZSBlockBlobPartWriter : NSObject
+
+/** The position of this part in the blob.  Parts are assembled in increasing order of index.*/
+@property (readonly) NSUInteger partIndex;
+
+/** The number of bytes written to this part.*/
+@property (readonly) unsigned long long bytesWritten;
+
+/** The number of blocks staged, or being staged, for this part.*/
+@property (readonly) NSUInteger blockCount;
+
+/** YES once the part has been closed.*/
+@property (readonly) BOOL closed;
+
+/** Writes data to the part.
+ 
+ The data is copied into a block buffer, so it may be reused once this returns.  If an earlier block of this part has failed to
+ stage, the write fails with that error.
+ 
+ @param data The data to write.
+ @param error Set to an error describing the failure, if the write failed.
+ @returns YES if the write was accepted, NO otherwise.
+ */
+-(BOOL)writeData:(NSData *)data error:(NSError **)error;
+
+/** Closes the part, staging its last, partial, block.
+ 
+ @param completionHandler The block of code to execute once all the part's blocks have been staged.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if every block was staged, error with details about the first failure otherwise.|
+ */
+-(void)closeWithCompletionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+@end
+
+/** The AZSBlockBlobMultipartWriter assembles a single block blob from parts written in parallel by independent writers.
+ 
+ Each part is written through its own AZSBlockBlobPartWriter, which stages its blocks concurrently with every other part.  Once
+ every part has been closed, commitWithCompletionHandler: commits the block IDs of all parts, in order of part index, and within
+ each part in the order they were written, in a single Put Block List.  Until then, none of the data is visible in the blob.
+ 
+ If useContentCRC64 is set, each part computes the CRC64 of its own data as its blocks are staged, and the commit combines them,
+ in order of part index, into the CRC64 of the whole blob.  An MD5 cannot be combined that way, so the Content-MD5 of the whole
+ blob is not stored, even if storeBlobContentMD5 is set.
+ */
+@interface AZSBlockBlobMultipartWriter : NSObject
+
+/** The blob being written.*/
+@property (strong, readonly) AZSCloudBlockBlob *blob;
+
+/** The parts created so far, in order of part index.*/
+@property (strong, readonly) NSArray *parts;
+
+/** Initializes a newly allocated AZSBlockBlobMultipartWriter object.
+ 
+ @param blob The blob to write.
+ @param accessCondition The access condition for each request.  A lease ID applies to every request; other conditions only matter for the final commit.
+ @param requestOptions The options to use for each request.
+ @param operationContext The operation context to use for each request.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithBlob:(AZSCloudBlockBlob *)blob accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext AZS_DESIGNATED_INITIALIZER;
+
+/** Returns the writer for a part, creating it if necessary.
+ 
+ This may be called from any thread.  Part indexes need not be contiguous, or requested in order; parts are committed in order
+ of index regardless.
+ 
+ @param partIndex The position of the part in the blob.
+ @returns The part's writer.
+ */
+-(AZSBlockBlobPartWriter *)partWriterAtIndex:(NSUInteger)partIndex;
+
+/** Commits every part, in order of part index, as the content of the blob.
+ 
+ Every part must have been closed, and its close must have completed, before this is called.
+ 
+ @param completionHandler The block of code to execute when the commit completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)commitWithCompletionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+@end
+
+AZS_ASSUME_NONNULL_END
@@ -0,0 +1,335 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlockBlobMultipartWriter.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSBlockBlobMultipartWriter.h"
+#import "AZSAccessCondition.h"
+#import "AZSBlobRequestOptions.h"
+#import "AZSBlockBufferPool.h"
+#import "AZSBlockListItem.h"
+#import "AZSCloudBlobClient.h"
+#import "AZSCloudBlockBlob.h"
+#import "AZSConstants.h"
+#import "AZSCRC64.h"
+#import "AZSErrors.h"
+#import "AZSOperationContext.h"
+
+@interface AZSBlockBlobPartWriter()
+
+@property (strong) AZSCloudBlockBlob *blob;
+@property (strong) AZSAccessCondition *accessCondition;
+@property (strong) AZSBlobRequestOptions *requestOptions;
+@property (strong) AZSOperationContext *operationContext;
+@property NSUInteger blockSize;
+
+// The CRC64 of the part's data, if the blob's CRC64 is to be stored.
+@property BOOL calculateContentCRC64;
+@property uint64_t contentCRC64;
+
+// The block currently being filled, and how much of it has been.
+@property (strong) NSMutableData *buffer;
+@property NSUInteger bufferedLength;
+
+// The part's blocks, in the order they were written.
+@property (strong) NSMutableArray *blockList;
+@property (strong) NSError *stagingError;
+@property BOOL closeCompleted;
+@property (strong) dispatch_semaphore_t uploadSemaphore;
+@property (strong) dispatch_group_t uploadGroup;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+-(instancetype)initWithBlob:(AZSCloudBlockBlob *)blob partIndex:(NSUInteger)partIndex blockSize:(NSUInteger)blockSize parallelismFactor:(NSInteger)parallelismFactor calculateContentCRC64:(BOOL)calculateContentCRC64 accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSBlockBlobPartWriter
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithBlob:(AZSCloudBlockBlob *)blob partIndex:(NSUInteger)partIndex blockSize:(NSUInteger)blockSize parallelismFactor:(NSInteger)parallelismFactor calculateContentCRC64:(BOOL)calculateContentCRC64 accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext
+{
+    self = [super init];
+    if (self)
+    {
+        _blob = blob;
+        _partIndex = partIndex;
+        _blockSize = blockSize;
+        _calculateContentCRC64 = calculateContentCRC64;
+        _contentCRC64 = 0;
+        _accessCondition = accessCondition;
+        _requestOptions = requestOptions;
+        _operationContext = operationContext;
+        _bytesWritten = 0;
+        _blockCount = 0;
+        _closed = NO;
+        _bufferedLength = 0;
+        _blockList = [NSMutableArray array];
+        _closeCompleted = NO;
+        _uploadSemaphore = dispatch_semaphore_create(MAX(parallelismFactor, 1));
+        _uploadGroup = dispatch_group_create();
+    }
+    
+    return self;
+}
+
+-(BOOL)writeData:(NSData *)data error:(NSError **)error
+{
+    NSError *failure = nil;
+    @synchronized(self)
+    {
+        if (self.closed)
+        {
+            failure = [NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"The part has already been closed."}];
+        }
+        else
+        {
+            failure = self.stagingError;
+        }
+    }
+    
+    if (failure)
+    {
+        if (error)
+        {
+            *error = failure;
+        }
+        return NO;
+    }
+    
+    const uint8_t *bytes = data.bytes;
+    NSUInteger remaining = data.length;
+    while (remaining > 0)
+    {
+        if (!self.buffer)
+        {
+            self.buffer = [[AZSBlockBufferPool sharedPool] bufferWithLength:self.blockSize];
+            self.bufferedLength = 0;
+        }
+        
+        NSUInteger copyLength = MIN(self.blockSize - self.bufferedLength, remaining);
+        memcpy(((uint8_t *)self.buffer.mutableBytes) + self.bufferedLength, bytes, copyLength);
+        self.bufferedLength += copyLength;
+        bytes += copyLength;
+        remaining -= copyLength;
+        
+        if (self.bufferedLength == self.blockSize)
+        {
+            [self stageBuffer];
+        }
+    }
+    
+    @synchronized(self)
+    {
+        _bytesWritten += data.length;
+    }
+    return YES;
+}
+
+-(void)closeWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    @synchronized(self)
+    {
+        if (self.closed)
+        {
+            completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"The part has already been closed."}]);
+            return;
+        }
+        _closed = YES;
+    }
+    
+    if (self.bufferedLength > 0)
+    {
+        [self stageBuffer];
+    }
+    else if (self.buffer)
+    {
+        [[AZSBlockBufferPool sharedPool] returnBuffer:self.buffer];
+        self.buffer = nil;
+    }
+    
+    dispatch_group_notify(self.uploadGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSError *error = nil;
+        @synchronized(self)
+        {
+            self.closeCompleted = YES;
+            error = self.stagingError;
+        }
+        completionHandler(error);
+    });
+}
+
+// Stages the current buffer as the part's next block, waiting first if the part already has parallelismFactor blocks in flight.
+-(void)stageBuffer
+{
+    NSMutableData *buffer = self.buffer;
+    NSUInteger length = self.bufferedLength;
+    self.buffer = nil;
+    self.bufferedLength = 0;
+    
+    // Blocks are staged in the order they were written, so the part's CRC64 can simply be continued with each one.
+    if (self.calculateContentCRC64)
+    {
+        self.contentCRC64 = [AZSCRC64 crc64OfBytes:buffer.mutableBytes length:length crc:self.contentCRC64];
+    }
+    
+    NSString *blockID = [[[[NSString stringWithFormat:@"blockid%@",[[[NSUUID UUID] UUIDString] stringByReplacingOccurrencesOfString:@"-" withString:AZSCEmptyString]] lowercaseString] dataUsingEncoding:NSUTF8StringEncoding] base64EncodedStringWithOptions:0];
+    @synchronized(self)
+    {
+        [self.blockList addObject:[[AZSBlockListItem alloc] initWithBlockID:blockID blockListMode:AZSBlockListModeLatest size:length]];
+        _blockCount++;
+    }
+    
+    dispatch_semaphore_wait(self.uploadSemaphore, DISPATCH_TIME_FOREVER);
+    dispatch_group_enter(self.uploadGroup);
+    
+    // The request sends straight from the pooled buffer, which goes back to the pool once the request has completed.
+    NSData *blockData = [NSData dataWithBytesNoCopy:buffer.mutableBytes length:length freeWhenDone:NO];
+    [self.blob uploadBlockFromData:blockData blockID:blockID contentMD5:nil accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error) {
+        if (error)
+        {
+            @synchronized(self)
+            {
+                if (!self.stagingError)
+                {
+                    self.stagingError = error;
+                }
+            }
+        }
+        
+        [[AZSBlockBufferPool sharedPool] returnBuffer:buffer];
+        dispatch_semaphore_signal(self.uploadSemaphore);
+        dispatch_group_leave(self.uploadGroup);
+    }];
+}
+
+@end
+
+@interface AZSBlockBlobMultipartWriter()
+
+@property (strong) AZSAccessCondition *accessCondition;
+@property (strong) AZSBlobRequestOptions *requestOptions;
+@property (strong) AZSOperationContext *operationContext;
+@property NSUInteger blockSize;
+@property NSInteger parallelismFactor;
+@property BOOL useContentCRC64;
+@property (strong) NSMutableDictionary *partWriters;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSBlockBlobMultipartWriter
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithBlob:(AZSCloudBlockBlob *)blob accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext
+{
+    self = [super init];
+    if (self)
+    {
+        _blob = blob;
+        _accessCondition = accessCondition;
+        _requestOptions = requestOptions;
+        _operationContext = operationContext ?: [[AZSOperationContext alloc] init];
+        _partWriters = [NSMutableDictionary dictionary];
+        
+        AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:blob.client.defaultRequestOptions];
+        _blockSize = MAX(MIN(modifiedOptions.blockSize, AZSCMaxBlockSize), 1);
+        _parallelismFactor = modifiedOptions.parallelismFactor;
+        _useContentCRC64 = modifiedOptions.useContentCRC64;
+    }
+    
+    return self;
+}
+
+-(NSArray *)parts
+{
+    @synchronized(self)
+    {
+        NSArray *sortedIndexes = [self.partWriters.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        return [self.partWriters objectsForKeys:sortedIndexes notFoundMarker:[NSNull null]];
+    }
+}
+
+-(AZSBlockBlobPartWriter *)partWriterAtIndex:(NSUInteger)partIndex
+{
+    NSNumber *key = [NSNumber numberWithUnsignedInteger:partIndex];
+    @synchronized(self)
+    {
+        AZSBlockBlobPartWriter *partWriter = self.partWriters[key];
+        if (!partWriter)
+        {
+            partWriter = [[AZSBlockBlobPartWriter alloc] initWithBlob:self.blob partIndex:partIndex blockSize:self.blockSize parallelismFactor:self.parallelismFactor calculateContentCRC64:self.useContentCRC64 accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext];
+            self.partWriters[key] = partWriter;
+        }
+        
+        return partWriter;
+    }
+}
+
+-(void)commitWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    NSMutableArray *blockList = [NSMutableArray array];
+    uint64_t contentCRC64 = 0;
+    for (AZSBlockBlobPartWriter *partWriter in self.parts)
+    {
+        @synchronized(partWriter)
+        {
+            if (!partWriter.closeCompleted)
+            {
+                completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:[NSString stringWithFormat:@"Part %lu has not finished closing.", (unsigned long)partWriter.partIndex]}]);
+                return;
+            }
+            if (partWriter.stagingError)
+            {
+                completionHandler(partWriter.stagingError);
+                return;
+            }
+            
+            [blockList addObjectsFromArray:partWriter.blockList];
+            
+            // Each part's CRC64 covers only its own data; combined in part order, they give the CRC64 of the whole blob.
+            contentCRC64 = [AZSCRC64 crc64ByCombiningCRC64:contentCRC64 withCRC64:partWriter.contentCRC64 secondLength:partWriter.bytesWritten];
+        }
+    }
+    
+    if (blockList.count > 50000)
+    {
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"The parts have more than 50,000 blocks between them; use a larger block size."}]);
+        return;
+    }
+    
+    // The block list carries the blob's metadata, so a CRC64 left over from an earlier download must be replaced or dropped.
+    if (self.useContentCRC64)
+    {
+        self.blob.metadata[AZSCContentCRC64MetadataKey] = [AZSCRC64 stringFromCRC64:contentCRC64];
+    }
+    else
+    {
+        [self.blob.metadata removeObjectForKey:AZSCContentCRC64MetadataKey];
+    }
+    
+    [self.operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Committing %lu blocks from %lu parts.", (unsigned long)blockList.count, (unsigned long)self.partWriters.count];
+    [self.blob uploadBlockListFromArray:blockList accessCondition:self.accessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:completionHandler];
+}
+
+@end
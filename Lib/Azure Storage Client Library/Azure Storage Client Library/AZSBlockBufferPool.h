@@ -0,0 +1,41 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlockBufferPool.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+// This class is reserved for internal use.
+// Keeps idle block buffers for reuse, so that uploads do not allocate (and zero) a fresh multi-megabyte buffer for every block.
+@interface AZSBlockBufferPool : NSObject
+
+// The total size of the idle buffers currently held.
+@property (readonly) NSUInteger pooledBytes;
+
++(AZSBlockBufferPool *)sharedPool;
+-(instancetype)initWithMaximumPooledBytes:(NSUInteger)maximumPooledBytes AZS_DESIGNATED_INITIALIZER;
+
+// Returns a buffer of exactly the given length, reusing an idle one if possible.  The contents are undefined.
+-(NSMutableData *)bufferWithLength:(NSUInteger)length;
+
+// Returns a buffer to the pool once nothing references its bytes any more.  Buffers beyond the pool's limit are freed.
+-(void)returnBuffer:(NSMutableData *)buffer;
+
+@end
+
+AZS_ASSUME_NONNULL_END
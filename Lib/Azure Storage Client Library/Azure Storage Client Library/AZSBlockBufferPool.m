@@ -0,0 +1,100 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlockBufferPool.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSBlockBufferPool.h"
+#import "AZSConstants.h"
+
+@interface AZSBlockBufferPool()
+
+@property (readonly) NSUInteger maximumPooledBytes;
+@property (strong, readonly) NSMutableDictionary *buffersByLength;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSBlockBufferPool
+
+-(instancetype)init
+{
+    return nil;
+}
+
++(AZSBlockBufferPool *)sharedPool
+{
+    static AZSBlockBufferPool *sharedPool = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedPool = [[AZSBlockBufferPool alloc] initWithMaximumPooledBytes:(4 * AZSCMaxBlockSize)];
+    });
+    
+    return sharedPool;
+}
+
+-(instancetype)initWithMaximumPooledBytes:(NSUInteger)maximumPooledBytes
+{
+    self = [super init];
+    if (self)
+    {
+        _maximumPooledBytes = maximumPooledBytes;
+        _pooledBytes = 0;
+        _buffersByLength = [NSMutableDictionary dictionary];
+    }
+    
+    return self;
+}
+
+-(NSMutableData *)bufferWithLength:(NSUInteger)length
+{
+    @synchronized(self)
+    {
+        NSMutableArray *buffers = self.buffersByLength[[NSNumber numberWithUnsignedInteger:length]];
+        NSMutableData *buffer = [buffers lastObject];
+        if (buffer)
+        {
+            [buffers removeLastObject];
+            _pooledBytes -= length;
+            return buffer;
+        }
+    }
+    
+    return [NSMutableData dataWithLength:length];
+}
+
+-(void)returnBuffer:(NSMutableData *)buffer
+{
+    NSUInteger length = buffer.length;
+    @synchronized(self)
+    {
+        if (self.pooledBytes + length > self.maximumPooledBytes)
+        {
+            return;
+        }
+        
+        NSNumber *key = [NSNumber numberWithUnsignedInteger:length];
+        NSMutableArray *buffers = self.buffersByLength[key];
+        if (!buffers)
+        {
+            buffers = [NSMutableArray array];
+            self.buffersByLength[key] = buffers;
+        }
+        [buffers addObject:buffer];
+        _pooledBytes += length;
+    }
+}
+
+@end
@@ -0,0 +1,40 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSCRC64.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+// This class is reserved for internal use.
+// Computes the CRC64 (polynomial 0x9A6C9329AC4BC9B5, reflected, pre- and post-inverted) used as a fast integrity check.
+// Checksums of adjacent pieces of data can be computed independently (and in parallel) and then combined.
+@interface AZSCRC64 : NSObject
+
+// Continues a checksum with more data.  Pass 0 as the crc to start a new checksum.
++(uint64_t)crc64OfBytes:(const void *)bytes length:(NSUInteger)length crc:(uint64_t)crc;
++(uint64_t)crc64FromData:(NSData *)data;
+
+// Returns the checksum of the concatenation of two pieces of data, given the checksum of each and the length of the second.
++(uint64_t)crc64ByCombiningCRC64:(uint64_t)firstCRC withCRC64:(uint64_t)secondCRC secondLength:(unsigned long long)secondLength;
+
+// The checksum as the base64 encoding of its 8 little-endian bytes, the same form the service uses.
++(NSString *)stringFromCRC64:(uint64_t)crc;
+
+@end
+
+AZS_ASSUME_NONNULL_END
@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSCRC64.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSCRC64.h"
+
+static const uint64_t AZSCRC64Polynomial = 0x9A6C9329AC4BC9B5ULL;
+
+// AZSCRC64Table[0] is the usual byte-at-a-time table; AZSCRC64Table[k] advances a byte through k more zero bytes, so that eight
+// bytes can be folded in with eight independent lookups (slice-by-8.)
+static uint64_t AZSCRC64Table[8][256];
+
+// Multiplies a 64x64 GF(2) matrix by a vector.
+static uint64_t AZSGF2MatrixTimes(const uint64_t *matrix, uint64_t vector)
+{
+    uint64_t sum = 0;
+    for (int i = 0; vector; i++, vector >>= 1)
+    {
+        if (vector & 1)
+        {
+            sum ^= matrix[i];
+        }
+    }
+    return sum;
+}
+
+static void AZSGF2MatrixSquare(uint64_t *square, const uint64_t *matrix)
+{
+    for (int i = 0; i < 64; i++)
+    {
+        square[i] = AZSGF2MatrixTimes(matrix, matrix[i]);
+    }
+}
+
+@implementation AZSCRC64
+
++(void)initialize
+{
+    if (self == [AZSCRC64 class])
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            uint64_t crc = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 1) ? ((crc >> 1) ^ AZSCRC64Polynomial) : (crc >> 1);
+            }
+            AZSCRC64Table[0][i] = crc;
+        }
+        
+        for (int k = 1; k < 8; k++)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                uint64_t previous = AZSCRC64Table[k - 1][i];
+                AZSCRC64Table[k][i] = (previous >> 8) ^ AZSCRC64Table[0][previous & 0xff];
+            }
+        }
+    }
+}
+
++(uint64_t)crc64OfBytes:(const void *)bytes length:(NSUInteger)length crc:(uint64_t)crc
+{
+    const uint8_t *current = bytes;
+    const uint8_t *end = current + length;
+    crc = ~crc;
+    
+    while (end - current >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, current, sizeof(word));
+        crc ^= CFSwapInt64LittleToHost(word);
+        crc = AZSCRC64Table[7][crc & 0xff] ^
+              AZSCRC64Table[6][(crc >> 8) & 0xff] ^
+              AZSCRC64Table[5][(crc >> 16) & 0xff] ^
+              AZSCRC64Table[4][(crc >> 24) & 0xff] ^
+              AZSCRC64Table[3][(crc >> 32) & 0xff] ^
+              AZSCRC64Table[2][(crc >> 40) & 0xff] ^
+              AZSCRC64Table[1][(crc >> 48) & 0xff] ^
+              AZSCRC64Table[0][crc >> 56];
+        current += 8;
+    }
+    
+    while (current < end)
+    {
+        crc = AZSCRC64Table[0][(crc ^ *current) & 0xff] ^ (crc >> 8);
+        current++;
+    }
+    
+    return ~crc;
+}
+
++(uint64_t)crc64FromData:(NSData *)data
+{
+    return [self crc64OfBytes:data.bytes length:data.length crc:0];
+}
+
+// Appending n zero bytes to the first piece is a linear operation on its CRC; this applies it by repeated squaring of the
+// one-zero-bit operator, then folds in the second piece (as zlib does for CRC32.)
++(uint64_t)crc64ByCombiningCRC64:(uint64_t)firstCRC withCRC64:(uint64_t)secondCRC secondLength:(unsigned long long)secondLength
+{
+    if (secondLength == 0)
+    {
+        return firstCRC;
+    }
+    
+    uint64_t even[64];
+    uint64_t odd[64];
+    
+    // The operator for one zero bit.
+    odd[0] = AZSCRC64Polynomial;
+    uint64_t row = 1;
+    for (int i = 1; i < 64; i++)
+    {
+        odd[i] = row;
+        row <<= 1;
+    }
+    
+    // Two zero bits, then four.
+    AZSGF2MatrixSquare(even, odd);
+    AZSGF2MatrixSquare(odd, even);
+    
+    // Each pass squares the operator (one zero byte, two, four...) and applies it for each set bit of the length.
+    do
+    {
+        AZSGF2MatrixSquare(even, odd);
+        if (secondLength & 1)
+        {
+            firstCRC = AZSGF2MatrixTimes(even, firstCRC);
+        }
+        secondLength >>= 1;
+        if (secondLength == 0)
+        {
+            break;
+        }
+        
+        AZSGF2MatrixSquare(odd, even);
+        if (secondLength & 1)
+        {
+            firstCRC = AZSGF2MatrixTimes(odd, firstCRC);
+        }
+        secondLength >>= 1;
+    } while (secondLength != 0);
+    
+    return firstCRC ^ secondCRC;
+}
+
++(NSString *)stringFromCRC64:(uint64_t)crc
+{
+    uint64_t littleEndian = CFSwapInt64HostToLittle(crc);
+    return [[NSData dataWithBytes:&littleEndian length:sizeof(littleEndian)] base64EncodedStringWithOptions:0];
+}
+
+@end
@@ -21,6 +21,9 @@
 #import "AZSMacros.h"
 #import "AZSOperationContext.h"
 #import "AZSRequestResult.h"
+#import "AZSMemoryGovernor.h"
+#import "AZSDownloadSink.h"
+#import "AZSTransformChain.h"
 #import "AZSBlobRequestOptions.h"
 #import "AZSCloudBlobClient.h"
 #import "AZSStorageCredentials.h"
@@ -42,6 +45,11 @@
 #import "AZSCopyState.h"
 #import "AZSBlobOutputStream.h"
 #import "AZSCloudBlobDirectory.h"
+#import "AZSBlobRandomAccessReader.h"
+#import "AZSPageBlobWriter.h"
+#import "AZSAppendBlobLogWriter.h"
+#import "AZSBlockBlobMultipartWriter.h"
+#import "AZSULLRangeSet.h"
 
 // TODO: Import all the user-accessible headers, so that users only need to import this one header file.
 @interface AZSClient : NSObject
@@ -160,6 +160,48 @@ AZS_ASSUME_NONNULL_BEGIN
  */
 -(void)appendBlockWithData:(NSData *)blockData contentMD5:(AZSNullable NSString *)contentMD5 accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * __AZSNullable, NSNumber *appendOffset))completionHandler;
 
+/** Follows the blob as it is appended to, delivering new data as it appears, much like tail -f.
+ 
+ This polls the blob's attributes, conditional on the ETag seen by the previous poll, so a poll of an unchanged blob returns no
+ body.  Only when the blob has grown past the last offset read is a ranged download issued, from that offset, and its data is
+ streamed to the data handler as it is received.  After a poll that finds no new data, the time until the next poll doubles, up
+ to 30 seconds; once new data arrives, polling returns to once a second.
+ 
+ @param offset The offset at which to start reading.  Pass 0 to read the whole blob, or the blob's length to read only new data.
+ @param dataHandler The block of code to call with each chunk of new data, in order.  It is also called with empty data after each poll
+ that finds nothing new, so that following can be stopped while the blob is idle; handlers that only want data should ignore these
+ calls.  It is called serially.  Set *stop to YES to stop following; a download in progress is canceled.
+ @param completionHandler The block of code to execute when following stops.
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the data handler stopped following, error with details about the failure otherwise.|
+ |unsigned long long | The offset just past the last byte delivered, from which following can be resumed.|
+ */
+-(void)followFromOffset:(unsigned long long)offset dataHandler:(void (^)(NSData *data, unsigned long long offset, BOOL *stop))dataHandler completionHandler:(void (^)(NSError * __AZSNullable, unsigned long long))completionHandler;
+
+/** Follows the blob as it is appended to, delivering new data as it appears, much like tail -f.
+ 
+ This polls the blob's attributes, conditional on the ETag seen by the previous poll, so a poll of an unchanged blob returns no
+ body.  Only when the blob has grown past the last offset read is a ranged download issued, from that offset, and its data is
+ streamed to the data handler as it is received.  After a poll that finds no new data, the time until the next poll doubles, up
+ to maximumPollInterval; once new data arrives, it returns to minimumPollInterval.
+ 
+ @param offset The offset at which to start reading.  Pass 0 to read the whole blob, or the blob's length to read only new data.
+ @param minimumPollInterval The time between polls while data is arriving, in seconds.
+ @param maximumPollInterval The longest time between polls while the blob is idle, in seconds.
+ @param requestOptions The options to use for each request.
+ @param operationContext The operation context to use for each request.
+ @param dataHandler The block of code to call with each chunk of new data, in order.  It is also called with empty data after each poll
+ that finds nothing new, so that following can be stopped while the blob is idle; handlers that only want data should ignore these
+ calls.  It is called serially.  Set *stop to YES to stop following; a download in progress is canceled.
+ @param completionHandler The block of code to execute when following stops.
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the data handler stopped following, error with details about the failure otherwise.|
+ |unsigned long long | The offset just past the last byte delivered, from which following can be resumed.|
+ */
+-(void)followFromOffset:(unsigned long long)offset minimumPollInterval:(NSTimeInterval)minimumPollInterval maximumPollInterval:(NSTimeInterval)maximumPollInterval requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext dataHandler:(void (^)(NSData *data, unsigned long long offset, BOOL *stop))dataHandler completionHandler:(void (^)(NSError * __AZSNullable, unsigned long long))completionHandler;
+
 /** Creates an output stream that is capable of writing to the blob.
  
  This method returns an instance of AZSBlobOutputStream.  The caller can then assign a delegate and schedule the stream in a runloop
@@ -192,8 +234,9 @@ AZS_ASSUME_NONNULL_BEGIN
  chunk the data into blocks, and upload each of those blocks to the service.  Finally, when the stream is finished, it will upload a block list
  consisting of all read data.
  
- No more than one block's worth of data will be uploaded at a time.  Block size is configurable in the AZSBlobRequestOptions (see – uploadFromStream:accessCondition:requestOptions:operationContext:completionHandler:).  Maximum
- number of outstanding downloads is also configurable in the AZSBlobRequestOptions.
+ Up to parallelismFactor blocks (see AZSBlobRequestOptions) are appended at once.  Each append is conditional on its append
+ position, so the blocks are always applied in order; a block that reaches the service ahead of an earlier one is resent once the
+ earlier blocks have been appended.  Block size is configurable in the AZSBlobRequestOptions.
  
  @param sourceStream The stream containing the data that the blob should contain.
  @param completionHandler The block of code to execute when the upload call completes.
@@ -210,8 +253,9 @@ AZS_ASSUME_NONNULL_BEGIN
  chunk the data into blocks, and upload each of those blocks to the service.  Finally, when the stream is finished, it will upload a block list
  consisting of all read data.
  
- No more than one block's worth of data will be uploaded at a time.  Block size is configurable in the AZSBlobRequestOptions.  Maximum
- number of outstanding downloads is also configurable in the AZSBlobRequestOptions.
+ Up to parallelismFactor blocks (see AZSBlobRequestOptions) are appended at once.  Each append is conditional on its append
+ position, so the blocks are always applied in order; a block that reaches the service ahead of an earlier one is resent once the
+ earlier blocks have been appended.  Block size is configurable in the AZSBlobRequestOptions.
  
  @param sourceStream The stream containing the data that the blob should contain.
  @param accessCondition The access condition for the request.
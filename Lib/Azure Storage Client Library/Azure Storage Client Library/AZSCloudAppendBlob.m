@@ -30,6 +30,9 @@
 #import "AZSBlobUploadHelper.h"
 #import "AZSAccessCondition.h"
 #import "AZSBlobOutputStream.h"
+#import "AZSConstants.h"
+#import "AZSDownloadSink.h"
+#import "AZSErrors.h"
 
 @interface AZSAppendBlobUploadFromStreamInputContainer : NSObject
 
@@ -206,6 +209,95 @@
     }];
 }
 
+-(void)followFromOffset:(unsigned long long)offset dataHandler:(void (^)(NSData *, unsigned long long, BOOL *))dataHandler completionHandler:(void (^)(NSError *, unsigned long long))completionHandler
+{
+    [self followFromOffset:offset minimumPollInterval:1 maximumPollInterval:30 requestOptions:nil operationContext:nil dataHandler:dataHandler completionHandler:completionHandler];
+}
+
+-(void)followFromOffset:(unsigned long long)offset minimumPollInterval:(NSTimeInterval)minimumPollInterval maximumPollInterval:(NSTimeInterval)maximumPollInterval requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext dataHandler:(void (^)(NSData *, unsigned long long, BOOL *))dataHandler completionHandler:(void (^)(NSError *, unsigned long long))completionHandler
+{
+    if (!operationContext)
+    {
+        operationContext = [[AZSOperationContext alloc] init];
+    }
+    
+    [self followFromOffset:offset eTag:nil pollInterval:minimumPollInterval minimumPollInterval:minimumPollInterval maximumPollInterval:MAX(maximumPollInterval, minimumPollInterval) requestOptions:requestOptions operationContext:operationContext dataHandler:dataHandler completionHandler:completionHandler];
+}
+
+// Makes one poll, and schedules the next.  eTag is the ETag seen by the previous poll, or nil for the first.
+-(void)followFromOffset:(unsigned long long)offset eTag:(NSString *)eTag pollInterval:(NSTimeInterval)pollInterval minimumPollInterval:(NSTimeInterval)minimumPollInterval maximumPollInterval:(NSTimeInterval)maximumPollInterval requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext dataHandler:(void (^)(NSData *, unsigned long long, BOOL *))dataHandler completionHandler:(void (^)(NSError *, unsigned long long))completionHandler
+{
+    void (^pollAfter)(NSTimeInterval, unsigned long long, NSString *, NSTimeInterval) = ^(NSTimeInterval delay, unsigned long long nextOffset, NSString *nextETag, NSTimeInterval nextPollInterval) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [self followFromOffset:nextOffset eTag:nextETag pollInterval:nextPollInterval minimumPollInterval:minimumPollInterval maximumPollInterval:maximumPollInterval requestOptions:requestOptions operationContext:operationContext dataHandler:dataHandler completionHandler:completionHandler];
+        });
+    };
+    
+    // While the blob is unchanged, the attributes request fails with 304 and no body.
+    AZSAccessCondition *changedCondition = eTag ? [[AZSAccessCondition alloc] initWithIfNoneMatchCondition:eTag] : nil;
+    [self downloadAttributesWithAccessCondition:changedCondition requestOptions:requestOptions operationContext:operationContext completionHandler:^(NSError *error) {
+        BOOL notModified = (((NSNumber *)error.userInfo[AZSCHttpStatusCode]).integerValue == 304);
+        if (error && !notModified)
+        {
+            completionHandler(error, offset);
+            return;
+        }
+        
+        NSString *currentETag = notModified ? eTag : self.properties.eTag;
+        unsigned long long blobLength = self.properties.length.unsignedLongLongValue;
+        if (notModified || blobLength <= offset)
+        {
+            // Nothing new; possibly only the metadata changed.  Back off, so that an idle blob is polled less and less often.
+            // The handler is still called, with no data, as otherwise it could not stop following until the blob grew.
+            BOOL stop = NO;
+            dataHandler([NSData data], offset, &stop);
+            if (stop)
+            {
+                completionHandler(nil, offset);
+                return;
+            }
+            
+            pollAfter(pollInterval, offset, currentETag, MIN(pollInterval * 2, maximumPollInterval));
+            return;
+        }
+        
+        [operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Following append blob, reading %llu new bytes from offset %llu (%@ committed blocks).", blobLength - offset, offset, self.properties.appendBlobCommittedBlockCount];
+        
+        // Appended data never changes, so the ranged download needs no condition of its own.  Data is handed on as it arrives.
+        // Failing the sink when the handler stops makes the executor cancel the rest of the download.
+        __block unsigned long long readOffset = offset;
+        __block BOOL stop = NO;
+        AZSBlockDownloadSink *sink = [[AZSBlockDownloadSink alloc] initWithBlock:^BOOL(NSData *data, NSError **error) {
+            dataHandler(data, readOffset, &stop);
+            readOffset += data.length;
+            if (stop)
+            {
+                if (error)
+                {
+                    *error = [NSError errorWithDomain:AZSErrorDomain code:AZSEOperationCanceled userInfo:@{NSLocalizedDescriptionKey:@"Following was stopped by the data handler."}];
+                }
+                return NO;
+            }
+            return YES;
+        }];
+        
+        [self downloadToSinks:@[sink] AZSULLrange:AZSULLMakeRange(offset, blobLength - offset) accessCondition:nil requestOptions:requestOptions operationContext:operationContext completionHandler:^(NSError *error) {
+            if (stop)
+            {
+                completionHandler(nil, readOffset);
+                return;
+            }
+            if (error)
+            {
+                completionHandler(error, readOffset);
+                return;
+            }
+            
+            pollAfter(minimumPollInterval, readOffset, currentETag, minimumPollInterval);
+        }];
+    }];
+}
+
 -(void)runBlobUploadFromStreamWithContainer:(AZSAppendBlobUploadFromStreamInputContainer *)inputContainer
 {
     @autoreleasepool {
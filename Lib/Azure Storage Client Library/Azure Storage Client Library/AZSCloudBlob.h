@@ -143,6 +143,131 @@ AZS_ASSUME_NONNULL_BEGIN
  */
 -(void)downloadToStream:(NSOutputStream *)targetStream AZSULLrange:(AZSULLRange)range accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
 
+/** Downloads the contents of the blob to several sinks at once.
+ 
+ Each chunk of data received is handed to every sink, without being copied.  Sinks run concurrently with each other and with the
+ transfer; the download only runs ahead of the slowest sink by up to maximumDownloadBufferSize bytes.  This allows, for example,
+ writing a blob to a file, hashing it, and parsing it with a single download.
+ 
+ @param sinks An array of objects conforming to AZSDownloadSink.
+ @param completionHandler The block of code to execute when the download call completes.  Note that this will only be called after every
+ sink has consumed all of the data.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)downloadToSinks:(NSArray *)sinks completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Downloads the contents of the blob to several sinks at once.
+ 
+ Each chunk of data received is handed to every sink, without being copied.  Sinks run concurrently with each other and with the
+ transfer; the download only runs ahead of the slowest sink by up to maximumDownloadBufferSize bytes.
+ 
+ @param sinks An array of objects conforming to AZSDownloadSink.
+ @param range The range of bytes to download.  If the length is 0, download the entire blob.
+ @param accessCondition The access condition for the request.
+ @param requestOptions The options to use for the request.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when the download call completes.  Note that this will only be called after every
+ sink has consumed all of the data.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)downloadToSinks:(NSArray *)sinks AZSULLrange:(AZSULLRange)range accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Streams the blob and delivers its contents as delimited records, for example the lines of a newline-delimited JSON or CSV blob.
+ 
+ The blob is never held in memory as a whole.  Records are parsed as data arrives, and are delivered to the batch handler in batches.
+ 
+ @param delimiter The delimiter separating records.  Must not be empty.
+ @param batchHandler The block to call with each batch of records, as an NSArray of NSData.  Set *stop to YES to stop reading; the rest of the download is canceled.
+ @param completionHandler The block of code to execute when the download call completes, after the last batch has been delivered.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error (or was stopped by the batch handler), error with details about the failure otherwise.|
+ */
+-(void)downloadRecordsWithDelimiter:(NSData *)delimiter batchHandler:(void (^)(NSArray *records, BOOL *stop))batchHandler completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Streams the blob and delivers its contents as delimited records, for example the lines of a newline-delimited JSON or CSV blob.
+ 
+ The blob is never held in memory as a whole.  Records are parsed as data arrives, and are delivered to the batch handler in batches.
+ A record that lies within one received chunk is not copied.
+ 
+ @param delimiter The delimiter separating records.  Must not be empty.
+ @param maximumBatchSize The largest number of records to deliver in a single batch.
+ @param accessCondition The access condition for the request.
+ @param requestOptions The options to use for the request.
+ @param operationContext The operation context to use for the call.
+ @param batchHandler The block to call with each batch of records, as an NSArray of NSData.  Set *stop to YES to stop reading; the rest of the download is canceled.
+ @param completionHandler The block of code to execute when the download call completes, after the last batch has been delivered.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error (or was stopped by the batch handler), error with details about the failure otherwise.|
+ */
+-(void)downloadRecordsWithDelimiter:(NSData *)delimiter maximumBatchSize:(NSUInteger)maximumBatchSize accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext batchHandler:(void (^)(NSArray *records, BOOL *stop))batchHandler completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Downloads a set of byte ranges of the blob.
+ 
+ Ranges that lie within gapThreshold bytes of each other are merged into a single ranged GET, and the merged requests are issued in
+ parallel (up to the parallelismFactor in the request options.)  The downloaded data is then split back up into one NSData slice per
+ requested range.  This is much cheaper than issuing one download call per range when reading many small pieces of a blob, such as
+ the index or footer of an archive and the sections it points to.
+ 
+ @param ranges An array of NSValue objects, each wrapping an AZSULLRange, describing the ranges to download.  Ranges may overlap and need not be sorted.
+ @param gapThreshold Ranges separated by no more than this many bytes will be fetched with a single request.  0 only merges ranges that touch or overlap.
+ @param completionHandler The block of code to execute when all ranges have been downloaded.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ |NSArray * | An array of NSData objects, one for each requested range, in the same order as the ranges parameter.  Slices are shorter than requested if the range runs past the end of the blob.|
+ */
+-(void)downloadRanges:(NSArray *)ranges gapThreshold:(uint64_t)gapThreshold completionHandler:(void (^)(NSError* __AZSNullable, NSArray * __AZSNullable))completionHandler;
+
+/** Downloads a set of byte ranges of the blob.
+ 
+ Ranges that lie within gapThreshold bytes of each other are merged into a single ranged GET, and the merged requests are issued in
+ parallel (up to the parallelismFactor in the request options.)  The downloaded data is then split back up into one NSData slice per
+ requested range.
+ 
+ @param ranges An array of NSValue objects, each wrapping an AZSULLRange, describing the ranges to download.  Ranges may overlap and need not be sorted.
+ @param gapThreshold Ranges separated by no more than this many bytes will be fetched with a single request.  0 only merges ranges that touch or overlap.
+ @param accessCondition The access condition for each request.  Pass an ETag condition to guarantee all ranges are read from the same version of the blob.
+ @param requestOptions The options to use for the requests.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when all ranges have been downloaded.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ |NSArray * | An array of NSData objects, one for each requested range, in the same order as the ranges parameter.  Slices are shorter than requested if the range runs past the end of the blob.|
+ */
+-(void)downloadRanges:(NSArray *)ranges gapThreshold:(uint64_t)gapThreshold accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable, NSArray * __AZSNullable))completionHandler;
+
+/** Downloads a set of byte ranges of the blob directly into caller-supplied buffers.
+ 
+ This behaves like downloadRanges:gapThreshold:accessCondition:requestOptions:operationContext:completionHandler:, except that the data for
+ each range is copied into the corresponding buffer rather than returned.  Each buffer's length is set to the number of bytes read for its range.
+ 
+ @param ranges An array of NSValue objects, each wrapping an AZSULLRange, describing the ranges to download.  Ranges may overlap and need not be sorted.
+ @param buffers An array of NSMutableData objects, one for each range, to receive the downloaded data.
+ @param gapThreshold Ranges separated by no more than this many bytes will be fetched with a single request.  0 only merges ranges that touch or overlap.
+ @param accessCondition The access condition for each request.  Pass an ETag condition to guarantee all ranges are read from the same version of the blob.
+ @param requestOptions The options to use for the requests.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when all ranges have been downloaded.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)downloadRanges:(NSArray *)ranges intoBuffers:(NSArray *)buffers gapThreshold:(uint64_t)gapThreshold accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
 /** Deletes the blob.
  
  This method deletes the blob on the service.  It will fail if the blob does not exist.
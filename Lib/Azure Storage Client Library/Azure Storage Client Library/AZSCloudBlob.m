@@ -38,6 +38,7 @@
 #import "AZSSharedAccessSignatureHelper.h"
 #import "AZSStorageCredentials.h"
 #import "AZSBlobResponseParser.h"
+#import "AZSDownloadSink.h"
 
 @interface AZSCloudBlob()
 
@@ -140,6 +141,58 @@
 }
 
 -(void)downloadToStream:(NSOutputStream *)targetStream AZSULLrange:(AZSULLRange)range accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError*))completionHandler
+{
+    [self downloadToStream:targetStream sinks:nil AZSULLrange:range accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+}
+
+-(void)downloadToSinks:(NSArray *)sinks completionHandler:(void (^)(NSError *))completionHandler
+{
+    [self downloadToSinks:sinks AZSULLrange:AZSULLMakeRange(0, 0) accessCondition:nil requestOptions:nil operationContext:nil completionHandler:completionHandler];
+}
+
+-(void)downloadToSinks:(NSArray *)sinks AZSULLrange:(AZSULLRange)range accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
+{
+    if (sinks.count == 0)
+    {
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"At least one sink must be provided."}]);
+        return;
+    }
+    
+    [self downloadToStream:nil sinks:sinks AZSULLrange:range accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+}
+
+-(void)downloadRecordsWithDelimiter:(NSData *)delimiter batchHandler:(void (^)(NSArray *, BOOL *))batchHandler completionHandler:(void (^)(NSError *))completionHandler
+{
+    [self downloadRecordsWithDelimiter:delimiter maximumBatchSize:256 accessCondition:nil requestOptions:nil operationContext:nil batchHandler:batchHandler completionHandler:completionHandler];
+}
+
+-(void)downloadRecordsWithDelimiter:(NSData *)delimiter maximumBatchSize:(NSUInteger)maximumBatchSize accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext batchHandler:(void (^)(NSArray *, BOOL *))batchHandler completionHandler:(void (^)(NSError *))completionHandler
+{
+    if (delimiter.length == 0)
+    {
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"The record delimiter must not be empty."}]);
+        return;
+    }
+    
+    // The sink parses on its own queue, so parsing overlaps with the network transfer.
+    AZSRecordDownloadSink *recordSink = [[AZSRecordDownloadSink alloc] initWithDelimiter:delimiter maximumBatchSize:maximumBatchSize batchHandler:batchHandler];
+    [self downloadToSinks:@[recordSink] AZSULLrange:AZSULLMakeRange(0, 0) accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:^(NSError *error) {
+        if (recordSink.stopped)
+        {
+            completionHandler(nil);
+            return;
+        }
+        
+        if (!error)
+        {
+            [recordSink finish];
+        }
+        completionHandler(error);
+    }];
+}
+
+// Exactly one of targetStream and sinks should be non-nil.
+-(void)downloadToStream:(NSOutputStream *)targetStream sinks:(NSArray *)sinks AZSULLrange:(AZSULLRange)range accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError*))completionHandler
 {
     if (!operationContext)
     {
@@ -148,6 +201,11 @@
     AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:self.client.defaultRequestOptions];
     AZSStorageCommand * command = [[AZSStorageCommand alloc] initWithStorageCredentials:self.client.credentials storageUri:self.storageUri calculateResponseMD5:!(modifiedOptions.disableContentMD5Validation) operationContext:operationContext];
     command.allowedStorageLocation = AZSAllowedStorageLocationPrimaryOrSecondary;
+    
+    // The stored CRC64 covers the whole blob, so only a download of the whole blob can be checked against it.
+    BOOL validateContentCRC64 = modifiedOptions.useContentCRC64 && (range.length == 0);
+    command.calculateResponseCRC64 = validateContentCRC64;
+    command.responseTransformChain = (range.length == 0) ? modifiedOptions.downloadTransformChain : nil;
     [command setBuildRequest:^ NSMutableURLRequest * (NSURLComponents *urlComponents, NSTimeInterval timeout, AZSOperationContext *operationContext)
      {
          return [AZSBlobRequestFactory getBlobWithSnapshotTime:self.snapshotTime range:range getRangeContentMD5:modifiedOptions.useTransactionalMD5 accessCondition:accessCondition urlComponents:urlComponents timeout:timeout operationContext:operationContext];
@@ -156,6 +214,7 @@
     [command setAuthenticationHandler:self.client.authenticationHandler];
     
     __block NSString *desiredContentMD5 = nil;
+    __block NSString *desiredContentCRC64 = nil;
         
     [command setPreProcessResponse:^id(NSHTTPURLResponse * urlResponse, AZSRequestResult * requestResult, AZSOperationContext * operationContext) {
         NSError *error = [AZSResponseParser preprocessResponseWithResponse:urlResponse requestResult:requestResult operationContext:operationContext];
@@ -193,11 +252,28 @@
         self.properties = parsedProperties;
         self.blobCopyState = [AZSBlobResponseParser getCopyStateWithResponse:urlResponse];
         self.metadata = [AZSBlobResponseParser getMetadataWithResponse:urlResponse];
+        if (validateContentCRC64)
+        {
+            desiredContentCRC64 = self.metadata[AZSCContentCRC64MetadataKey];
+        }
+        
+        // The URL loading system decodes gzip and deflate responses, and the stored checksums cover the encoded bytes, which are never seen.
+        NSString *contentEncoding = urlResponse.allHeaderFields[AZSCContentEncoding];
+        if ([contentEncoding isEqualToString:AZSCContentEncodingGzip] || [contentEncoding isEqualToString:AZSCContentEncodingDeflate])
+        {
+            if (desiredContentMD5 || desiredContentCRC64)
+            {
+                [operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Response body was decoded from Content-Encoding %@, so its MD5 and CRC64 are not validated.", contentEncoding];
+            }
+            desiredContentMD5 = nil;
+            desiredContentCRC64 = nil;
+        }
         
         return nil;
     }];
     
     [command setDestinationStream:targetStream];
+    [command setDestinationSinks:sinks];
     
     [command setPostProcessResponse:^id(NSHTTPURLResponse *response, AZSRequestResult *requestResult, NSOutputStream *outputStream, AZSOperationContext *operationContext, NSError **error) {
         if (desiredContentMD5 && !modifiedOptions.disableContentMD5Validation)
@@ -207,6 +283,13 @@
                 *error = [NSError errorWithDomain:AZSErrorDomain code:AZSEMD5Mismatch userInfo:nil];
             }
         }
+        if (desiredContentCRC64 && !*error)
+        {
+            if ([desiredContentCRC64 compare:requestResult.calculatedResponseCRC64 options:NSLiteralSearch] != NSOrderedSame)
+            {
+                *error = [NSError errorWithDomain:AZSErrorDomain code:AZSECRC64Mismatch userInfo:nil];
+            }
+        }
         return nil;
     }];
     
@@ -218,6 +301,172 @@
 
 }
 
+-(void)downloadRanges:(NSArray *)ranges gapThreshold:(uint64_t)gapThreshold completionHandler:(void (^)(NSError *, NSArray *))completionHandler
+{
+    [self downloadRanges:ranges gapThreshold:gapThreshold accessCondition:nil requestOptions:nil operationContext:nil completionHandler:completionHandler];
+}
+
+-(void)downloadRanges:(NSArray *)ranges gapThreshold:(uint64_t)gapThreshold accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *, NSArray *))completionHandler
+{
+    NSMutableArray *slices = [NSMutableArray arrayWithCapacity:ranges.count];
+    for (NSUInteger i = 0; i < ranges.count; i++)
+    {
+        [slices addObject:[NSData data]];
+    }
+    
+    [self downloadRanges:ranges gapThreshold:gapThreshold accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext scatterBlock:^(NSUInteger rangeIndex, NSData *mergedData, NSRange sliceRange) {
+        slices[rangeIndex] = [mergedData subdataWithRange:sliceRange];
+    } completionHandler:^(NSError *error) {
+        completionHandler(error, error ? nil : slices);
+    }];
+}
+
+-(void)downloadRanges:(NSArray *)ranges intoBuffers:(NSArray *)buffers gapThreshold:(uint64_t)gapThreshold accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
+{
+    if (buffers.count != ranges.count)
+    {
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"The number of buffers must match the number of ranges."}]);
+        return;
+    }
+    
+    for (NSMutableData *buffer in buffers)
+    {
+        [buffer setLength:0];
+    }
+    
+    [self downloadRanges:ranges gapThreshold:gapThreshold accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext scatterBlock:^(NSUInteger rangeIndex, NSData *mergedData, NSRange sliceRange) {
+        NSMutableData *buffer = buffers[rangeIndex];
+        [buffer setLength:sliceRange.length];
+        [buffer replaceBytesInRange:NSMakeRange(0, sliceRange.length) withBytes:((const uint8_t *)mergedData.bytes) + sliceRange.location];
+    } completionHandler:completionHandler];
+}
+
+// Merges the requested ranges, downloads the merged ranges in parallel, and then calls scatterBlock once per (non-empty) requested range with
+// the merged data that contains it and the location of the requested bytes within that data.
+-(void)downloadRanges:(NSArray *)ranges gapThreshold:(uint64_t)gapThreshold accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext scatterBlock:(void (^)(NSUInteger, NSData *, NSRange))scatterBlock completionHandler:(void (^)(NSError *))completionHandler
+{
+    if (!operationContext)
+    {
+        operationContext = [[AZSOperationContext alloc] init];
+    }
+    AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:self.client.defaultRequestOptions];
+    
+    // The service will only return a range MD5 for ranges up to 4 MB, so don't merge past that if transactional MD5 is on.
+    uint64_t maxMergedLength = modifiedOptions.useTransactionalMD5 ? AZSCMaxBlockSize : UINT64_MAX;
+    
+    // Zero-length ranges are skipped entirely; a zero length on a GET means the entire blob.
+    NSMutableArray *sortedIndices = [NSMutableArray arrayWithCapacity:ranges.count];
+    for (NSUInteger i = 0; i < ranges.count; i++)
+    {
+        if (((NSValue *)ranges[i]).AZSULLRangeValue.length > 0)
+        {
+            [sortedIndices addObject:[NSNumber numberWithUnsignedInteger:i]];
+        }
+    }
+    [sortedIndices sortUsingComparator:^NSComparisonResult(NSNumber *first, NSNumber *second) {
+        uint64_t firstLocation = ((NSValue *)ranges[first.unsignedIntegerValue]).AZSULLRangeValue.location;
+        uint64_t secondLocation = ((NSValue *)ranges[second.unsignedIntegerValue]).AZSULLRangeValue.location;
+        return (firstLocation < secondLocation) ? NSOrderedAscending : ((firstLocation > secondLocation) ? NSOrderedDescending : NSOrderedSame);
+    }];
+    
+    NSMutableArray *mergedRanges = [NSMutableArray arrayWithCapacity:sortedIndices.count];
+    NSMutableArray *mergedMembers = [NSMutableArray arrayWithCapacity:sortedIndices.count];
+    AZSULLRange currentRange = AZSULLMakeRange(0, 0);
+    for (NSNumber *index in sortedIndices)
+    {
+        AZSULLRange range = ((NSValue *)ranges[index.unsignedIntegerValue]).AZSULLRangeValue;
+        if (mergedRanges.count > 0)
+        {
+            AZSULLRange unionRange = AZSULLUnionRange(currentRange, range);
+            BOOL withinGap = (range.location <= AZSULLMaxRange(currentRange)) || (range.location - AZSULLMaxRange(currentRange) <= gapThreshold);
+            if (withinGap && unionRange.length <= maxMergedLength)
+            {
+                currentRange = unionRange;
+                [mergedRanges replaceObjectAtIndex:(mergedRanges.count - 1) withObject:[NSValue valueWithAZSULLRange:currentRange]];
+                [[mergedMembers lastObject] addObject:index];
+                continue;
+            }
+        }
+        
+        currentRange = range;
+        [mergedRanges addObject:[NSValue valueWithAZSULLRange:currentRange]];
+        [mergedMembers addObject:[NSMutableArray arrayWithObject:index]];
+    }
+    
+    [operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Downloading %lu ranges with %lu requests.", (unsigned long)ranges.count, (unsigned long)mergedRanges.count];
+    
+    NSInteger parallelism = MAX(modifiedOptions.parallelismFactor, 1);
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        dispatch_semaphore_t requestSemaphore = dispatch_semaphore_create(parallelism);
+        dispatch_group_t requestGroup = dispatch_group_create();
+        NSMutableArray *mergedData = [NSMutableArray arrayWithCapacity:mergedRanges.count];
+        __block NSError *downloadError = nil;
+        
+        for (NSUInteger i = 0; i < mergedRanges.count; i++)
+        {
+            dispatch_semaphore_wait(requestSemaphore, DISPATCH_TIME_FOREVER);
+            @synchronized(mergedData)
+            {
+                if (downloadError)
+                {
+                    dispatch_semaphore_signal(requestSemaphore);
+                    break;
+                }
+                [mergedData addObject:[NSData data]];
+            }
+            
+            NSOutputStream *targetStream = [NSOutputStream outputStreamToMemory];
+            dispatch_group_enter(requestGroup);
+            [self downloadToStream:targetStream AZSULLrange:((NSValue *)mergedRanges[i]).AZSULLRangeValue accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext completionHandler:^(NSError *error) {
+                @synchronized(mergedData)
+                {
+                    if (error)
+                    {
+                        if (!downloadError)
+                        {
+                            downloadError = error;
+                        }
+                    }
+                    else
+                    {
+                        NSData *data = [targetStream propertyForKey:NSStreamDataWrittenToMemoryStreamKey];
+                        if (data)
+                        {
+                            mergedData[i] = data;
+                        }
+                    }
+                }
+                dispatch_semaphore_signal(requestSemaphore);
+                dispatch_group_leave(requestGroup);
+            }];
+        }
+        
+        dispatch_group_wait(requestGroup, DISPATCH_TIME_FOREVER);
+        if (downloadError)
+        {
+            completionHandler(downloadError);
+            return;
+        }
+        
+        for (NSUInteger i = 0; i < mergedRanges.count; i++)
+        {
+            AZSULLRange mergedRange = ((NSValue *)mergedRanges[i]).AZSULLRangeValue;
+            NSData *data = mergedData[i];
+            for (NSNumber *index in mergedMembers[i])
+            {
+                AZSULLRange range = ((NSValue *)ranges[index.unsignedIntegerValue]).AZSULLRangeValue;
+                
+                // The service truncates ranges that run past the end of the blob, so the data may be shorter than requested.
+                NSUInteger offset = (NSUInteger)(range.location - mergedRange.location);
+                NSUInteger available = (data.length > offset) ? (NSUInteger)MIN(range.length, (uint64_t)(data.length - offset)) : 0;
+                scatterBlock(index.unsignedIntegerValue, data, NSMakeRange(MIN(offset, data.length), available));
+            }
+        }
+        
+        completionHandler(nil);
+    });
+}
+
 -(void)deleteWithCompletionHandler:(void (^)(NSError*))completionHandler
 {
     [self deleteWithSnapshotsOption:AZSDeleteSnapshotsOptionNone completionHandler:completionHandler];
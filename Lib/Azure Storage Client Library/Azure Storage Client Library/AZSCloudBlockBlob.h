@@ -155,6 +155,38 @@ AZS_ASSUME_NONNULL_BEGIN
  */
 -(void)uploadFromData:(NSData *)sourceData accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
 
+/** Uploads a blob from given source data, in a single Put Blob request.
+ 
+ This operation replaces the entire contents of the blob with one request, rather than uploading blocks and committing a block list.
+ uploadFromData uses it automatically when the data is no larger than singleBlobUploadThreshold.  The service limits the data to 64 MB.
+ 
+ @param sourceData The data that the blob should contain.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)uploadFromDataInSingleRequest:(NSData *)sourceData completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Uploads a blob from given source data, in a single Put Blob request.
+ 
+ This operation replaces the entire contents of the blob with one request, rather than uploading blocks and committing a block list.
+ uploadFromData uses it automatically when the data is no larger than singleBlobUploadThreshold.  The service limits the data to 64 MB.
+ The data is sent as given, so this fails with AZSEInvalidArgument if contentCompression or an uploadTransformChain is set.
+ 
+ @param sourceData The data that the blob should contain.
+ @param accessCondition The access condition for the request.
+ @param requestOptions The options to use for the request.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)uploadFromDataInSingleRequest:(NSData *)sourceData accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
 /** Uploads a single block from given source data.
  
  This operation uploads one block of data to the blob in the Storage Service.  The block will remain uncommitted (meaning the data will not
@@ -320,8 +352,9 @@ AZS_ASSUME_NONNULL_BEGIN
 
 /** Uploads a blob from given source file.
  
- UploadFromText loads an the input file and uploads the contents of that file to the service.  Contents will not be
- read all at once, but instead in a streaming fashion.  This operation will overwrite any data
+ UploadFromText loads an the input file and uploads the contents of that file to the service.  The file is memory-mapped
+ rather than read all at once, and its blocks are uploaded in parallel (falling back to streaming if the file cannot be mapped),
+ so the file must not be truncated while the upload is in progress.  This operation will overwrite any data
  already in the blob on the service, unless protected with an appropriate AZSAccessCondition.
  
  @param filePath The path to the file containing the data that the blob should contain.
@@ -335,8 +368,9 @@ AZS_ASSUME_NONNULL_BEGIN
 
 /** Uploads a blob from given source file.
  
- UploadFromText loads an the input file and uploads the contents of that file to the service.  Contents will not be
- read all at once, but instead in a streaming fashion.  This operation will overwrite any data
+ UploadFromText loads an the input file and uploads the contents of that file to the service.  The file is memory-mapped
+ rather than read all at once, and its blocks are uploaded in parallel (falling back to streaming if the file cannot be mapped),
+ so the file must not be truncated while the upload is in progress.  This operation will overwrite any data
  already in the blob on the service, unless protected with an appropriate AZSAccessCondition.
  
  @param filePath The path to the file containing the data that the blob should contain.
@@ -353,8 +387,9 @@ AZS_ASSUME_NONNULL_BEGIN
 
 /** Uploads a blob from given source file.
  
- UploadFromText loads an the input file and uploads the contents of that file to the service.  Contents will not be
- read all at once, but instead in a streaming fashion.  This operation will overwrite any data
+ UploadFromText loads an the input file and uploads the contents of that file to the service.  The file is memory-mapped
+ rather than read all at once, and its blocks are uploaded in parallel (falling back to streaming if the file cannot be mapped),
+ so the file must not be truncated while the upload is in progress.  This operation will overwrite any data
  already in the blob on the service, unless protected with an appropriate AZSAccessCondition.
  
  @param fileURL The URL to the file containing the data that the blob should contain.
@@ -368,8 +403,9 @@ AZS_ASSUME_NONNULL_BEGIN
 
 /** Uploads a blob from given source file.
  
- UploadFromText loads an the input file and uploads the contents of that file to the service.  Contents will not be
- read all at once, but instead in a streaming fashion.  This operation will overwrite any data
+ UploadFromText loads an the input file and uploads the contents of that file to the service.  The file is memory-mapped
+ rather than read all at once, and its blocks are uploaded in parallel (falling back to streaming if the file cannot be mapped),
+ so the file must not be truncated while the upload is in progress.  This operation will overwrite any data
  already in the blob on the service, unless protected with an appropriate AZSAccessCondition.
  
  @param fileURL The URL to the file containing the data that the blob should contain.
@@ -384,6 +420,94 @@ AZS_ASSUME_NONNULL_BEGIN
  */
 -(void)uploadFromFileWithURL:(NSURL *)fileURL accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * __AZSNullable))completionHandler;
 
+/** Uploads a blob from given source file, recording progress in a journal so that an interrupted upload can be resumed.
+ 
+ The file is uploaded in parallel blocks as with uploadFromFileWithPath, and the index of each block is appended to the journal
+ file as soon as the block is staged.  If the process exits before the upload completes, calling this method again with the
+ same file, blob and journal path re-uploads only the blocks that are not both recorded in the journal and still present in the
+ blob's uncommitted block list.  If the file has changed since the journal was written, the journal is discarded and the upload
+ starts over.  The journal is deleted once the block list is committed.
+ 
+ Uncommitted blocks are discarded by the service after a week, or when any other block list is committed to the blob.
+ 
+ @param filePath The path to the file containing the data that the blob should contain.
+ @param journalPath The path of the journal file.  It should be in a location that survives the process, and be used for only one upload at a time.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)uploadFromFileWithPath:(NSString *)filePath journalPath:(NSString *)journalPath completionHandler:(void (^)(NSError * __AZSNullable))completionHandler;
+
+/** Uploads a blob from given source file, recording progress in a journal so that an interrupted upload can be resumed.
+ 
+ The file is uploaded in parallel blocks as with uploadFromFileWithPath, and the index of each block is appended to the journal
+ file as soon as the block is staged.  If the process exits before the upload completes, calling this method again with the
+ same file, blob and journal path re-uploads only the blocks that are not both recorded in the journal and still present in the
+ blob's uncommitted block list.  If the file has changed since the journal was written, the journal is discarded and the upload
+ starts over.  The journal is deleted once the block list is committed.
+ 
+ Uncommitted blocks are discarded by the service after a week, or when any other block list is committed to the blob.  Blocks are
+ sent straight from the mapped file, so the upload fails with AZSEInvalidArgument if the options set a memory governor, content
+ compression or an upload transform chain.
+ 
+ @param filePath The path to the file containing the data that the blob should contain.
+ @param journalPath The path of the journal file.  It should be in a location that survives the process, and be used for only one upload at a time.
+ @param accessCondition The access condition for the request.
+ @param requestOptions The options to use for the request.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)uploadFromFileWithPath:(NSString *)filePath journalPath:(NSString *)journalPath accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * __AZSNullable))completionHandler;
+
+/** Uploads a blob from data, re-using any blocks that the blob already contains.
+ 
+ The data is split into variable-sized chunks with a content-defined chunker, so that chunk boundaries follow the content rather
+ than fixed offsets, and each chunk's block ID is derived from the SHA-256 hash of its contents.  Chunks whose block is already in
+ the blob's committed block list are not uploaded again, but are committed by reference.  When a large blob is re-uploaded after
+ a small change, only the chunks around the change are sent.
+ 
+ Blobs uploaded with other methods have unrelated block IDs, so the first deduplicating upload of a blob sends all of its data.
+ Large files can be memory-mapped into an NSData (see NSDataReadingMappedIfSafe) before being passed to this method.
+ 
+ @param sourceData The data to upload.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)uploadFromDataWithDeduplication:(NSData *)sourceData completionHandler:(void (^)(NSError * __AZSNullable))completionHandler;
+
+/** Uploads a blob from data, re-using any blocks that the blob already contains.
+ 
+ The data is split into variable-sized chunks with a content-defined chunker, so that chunk boundaries follow the content rather
+ than fixed offsets, and each chunk's block ID is derived from the SHA-256 hash of its contents.  Chunks whose block is already in
+ the blob's committed block list are not uploaded again, but are committed by reference.  When a large blob is re-uploaded after
+ a small change, only the chunks around the change are sent.
+ 
+ Blobs uploaded with other methods have unrelated block IDs, so the first deduplicating upload of a blob sends all of its data.
+ Large files can be memory-mapped into an NSData (see NSDataReadingMappedIfSafe) before being passed to this method.  Chunks are
+ sent as given, so the upload fails with AZSEInvalidArgument if the options set a memory governor, content compression or an
+ upload transform chain.
+ 
+ @param sourceData The data to upload.
+ @param accessCondition The access condition for the request.
+ @param requestOptions The options to use for the request.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)uploadFromDataWithDeduplication:(NSData *)sourceData accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * __AZSNullable))completionHandler;
+
 @end
 
 AZS_ASSUME_NONNULL_END
\ No newline at end of file
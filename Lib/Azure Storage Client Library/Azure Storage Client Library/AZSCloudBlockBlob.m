@@ -28,14 +28,20 @@
 #import "AZSResponseParser.h"
 #import "AZSBlobUploadHelper.h"
 #import "AZSUtil.h"
+#import "AZSBlobUploadJournal.h"
+#import "AZSContentDefinedChunker.h"
 #import "AZSErrors.h"
 #import "AZSStorageUri.h"
 #import "AZSBlobProperties.h"
+#import "AZSConstants.h"
+#import "AZSBlockListItem.h"
+#import "AZSCRC64.h"
 
 
 @interface AZSBlobUploadFromStreamInputContainer : NSObject
 
 @property (strong) NSInputStream *sourceStream;
+@property unsigned long long expectedLength;
 @property (strong) AZSCloudBlockBlob *targetBlob;
 @property (strong) AZSAccessCondition *accessCondition;
 @property (strong) AZSBlobRequestOptions *blobRequestOptions;
@@ -105,6 +111,7 @@
             }
         }];
         
+        blobUploadHelper.expectedLength = inputContainer.expectedLength;
         [inputContainer.sourceStream setDelegate:blobUploadHelper];
         
         [inputContainer.sourceStream scheduleInRunLoop:runLoopForUpload forMode:NSDefaultRunLoopMode];
@@ -129,6 +136,12 @@
 }
 
 -(void)uploadFromStream:(NSInputStream *)sourceStream accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError*))completionHandler
+{
+    [self uploadFromStream:sourceStream expectedLength:0 accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+}
+
+// The expected length, if known (otherwise 0), lets the upload helper pick a block size when blockSize is 0.
+-(void)uploadFromStream:(NSInputStream *)sourceStream expectedLength:(unsigned long long)expectedLength accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError*))completionHandler
 {
     // TODO: Allow user to give us an input run loop if desired.
     AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:self.client.defaultRequestOptions];
@@ -139,6 +152,7 @@
 
     AZSBlobUploadFromStreamInputContainer *inputContainer = [[AZSBlobUploadFromStreamInputContainer alloc] init];
     inputContainer.sourceStream = sourceStream;
+    inputContainer.expectedLength = expectedLength;
     inputContainer.accessCondition = accessCondition;
     inputContainer.blobRequestOptions = modifiedOptions;
     inputContainer.operationContext = operationContext;
@@ -157,8 +171,150 @@
 
 -(void)uploadFromData:(NSData *)sourceData accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
 {
-    NSInputStream *sourceStream = [NSInputStream inputStreamWithData:sourceData];
-    [self uploadFromStream:sourceStream accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+    AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:self.client.defaultRequestOptions];
+    
+    // Compression, transforms and memory budgeting are applied by the upload helper as it buffers blocks, so data that needs any
+    // of them is uploaded as a stream.
+    if (modifiedOptions.memoryGovernor || modifiedOptions.uploadTransformChain || (modifiedOptions.contentCompression != AZSContentCompressionNone))
+    {
+        [self uploadFromStream:[NSInputStream inputStreamWithData:sourceData] expectedLength:sourceData.length accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+        return;
+    }
+    
+    // Small uploads go up in one request, with no upload thread or block list.
+    if (sourceData.length <= MIN(modifiedOptions.singleBlobUploadThreshold, (NSUInteger)AZSCMaxSingleBlobUploadSize))
+    {
+        [self uploadFromDataInSingleRequest:sourceData accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+        return;
+    }
+    
+    [self uploadFromDataInBlocks:sourceData accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext completionHandler:completionHandler];
+}
+
+// Uploads data that is already in memory as parallel Put Block calls on no-copy slices of it, followed by Put Block List.
+// Unlike uploading from a stream, no data is copied, and no upload thread or runloop is needed.
+-(void)uploadFromDataInBlocks:(NSData *)sourceData accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)modifiedOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
+{
+    // Copying immutable data just retains it; mutable data is copied once, so that the caller may keep changing it.
+    NSData *blobData = [sourceData copy];
+    NSUInteger blockSize = [AZSBlobUploadHelper blockSizeForLength:blobData.length requestOptions:modifiedOptions];
+    [self uploadFromDataInBlocks:blobData blockRanges:[AZSCloudBlockBlob blockRangesForLength:blobData.length blockSize:blockSize] blockIDForIndex:^NSString *(NSUInteger index) {
+        return [[[[NSString stringWithFormat:@"blockid%@",[[[NSUUID UUID] UUIDString] stringByReplacingOccurrencesOfString:@"-" withString:AZSCEmptyString]] lowercaseString] dataUsingEncoding:NSUTF8StringEncoding] base64EncodedStringWithOptions:0];
+    } skippedBlocks:nil skippedBlockListMode:AZSBlockListModeLatest accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext blockUploaded:nil completionHandler:completionHandler];
+}
+
++(NSArray *)blockRangesForLength:(NSUInteger)length blockSize:(NSUInteger)blockSize
+{
+    NSMutableArray *blockRanges = [NSMutableArray arrayWithCapacity:((length + blockSize - 1) / blockSize)];
+    for (NSUInteger offset = 0; offset < length; offset += blockSize)
+    {
+        [blockRanges addObject:[NSValue valueWithRange:NSMakeRange(offset, MIN(blockSize, length - offset))]];
+    }
+    return blockRanges;
+}
+
+// Uploads each block of blobData not in skippedBlocks (those are already on the service, and are committed with skippedBlockListMode)
+// and then commits all of them.  A block with the same ID as an earlier block is only uploaded once.
+// blockUploaded, if given, is called as each block is staged.
+-(void)uploadFromDataInBlocks:(NSData *)blobData blockRanges:(NSArray *)blockRanges blockIDForIndex:(NSString *(^)(NSUInteger))blockIDForIndex skippedBlocks:(NSIndexSet *)skippedBlocks skippedBlockListMode:(AZSBlockListMode)skippedBlockListMode accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)modifiedOptions operationContext:(AZSOperationContext *)operationContext blockUploaded:(void (^)(NSUInteger))blockUploaded completionHandler:(void (^)(NSError *))completionHandler
+{
+    if (operationContext == nil)
+    {
+        operationContext = [[AZSOperationContext alloc] init];
+    }
+    
+    NSInteger parallelism = MAX(modifiedOptions.parallelismFactor, 1);
+    
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        dispatch_semaphore_t requestSemaphore = dispatch_semaphore_create(parallelism);
+        dispatch_group_t requestGroup = dispatch_group_create();
+        dispatch_queue_t workerQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+        
+        // The whole-blob MD5 is a single sequential pass, so it runs alongside the block uploads rather than before them.
+        if (modifiedOptions.storeBlobContentMD5)
+        {
+            dispatch_group_async(requestGroup, workerQueue, ^{
+                self.properties.contentMD5 = [AZSUtil calculateMD5FromData:blobData];
+            });
+        }
+        
+        // The block list carries the blob's metadata, so a CRC64 left over from an earlier download must be replaced or dropped.
+        if (modifiedOptions.useContentCRC64)
+        {
+            dispatch_group_async(requestGroup, workerQueue, ^{
+                self.metadata[AZSCContentCRC64MetadataKey] = [AZSCRC64 stringFromCRC64:[AZSCRC64 crc64FromData:blobData]];
+            });
+        }
+        else
+        {
+            [self.metadata removeObjectForKey:AZSCContentCRC64MetadataKey];
+        }
+
+        NSMutableArray *blockList = [NSMutableArray arrayWithCapacity:blockRanges.count];
+        NSMutableSet *scheduledBlockIDs = [NSMutableSet setWithCapacity:blockRanges.count];
+        NSError * __block uploadError = nil;
+        
+        for (NSUInteger index = 0; index < blockRanges.count; index++)
+        {
+            NSRange blockRange = [blockRanges[index] rangeValue];
+            NSString *blockID = blockIDForIndex(index);
+            if ([skippedBlocks containsIndex:index])
+            {
+                [blockList addObject:[[AZSBlockListItem alloc] initWithBlockID:blockID blockListMode:skippedBlockListMode size:blockRange.length]];
+                continue;
+            }
+            
+            [blockList addObject:[[AZSBlockListItem alloc] initWithBlockID:blockID blockListMode:AZSBlockListModeLatest size:blockRange.length]];
+            if ([scheduledBlockIDs containsObject:blockID])
+            {
+                continue;
+            }
+            [scheduledBlockIDs addObject:blockID];
+            
+            dispatch_semaphore_wait(requestSemaphore, DISPATCH_TIME_FOREVER);
+            @synchronized(blockList)
+            {
+                if (uploadError)
+                {
+                    dispatch_semaphore_signal(requestSemaphore);
+                    break;
+                }
+            }
+            
+            // The slice points into blobData, which this block keeps alive until every upload has completed.
+            NSData *blockData = [NSData dataWithBytesNoCopy:(void *)(((const uint8_t *)blobData.bytes) + blockRange.location) length:blockRange.length freeWhenDone:NO];
+            
+            dispatch_group_enter(requestGroup);
+            dispatch_async(workerQueue, ^{
+                // Hash each block on a worker thread, so that hashing runs in parallel across blocks.
+                NSString *contentMD5 = modifiedOptions.useTransactionalMD5 ? [AZSUtil calculateMD5FromData:blockData] : nil;
+                [self uploadBlockFromData:blockData blockID:blockID contentMD5:contentMD5 accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext completionHandler:^(NSError *error) {
+                    @synchronized(blockList)
+                    {
+                        if (error && !uploadError)
+                        {
+                            uploadError = error;
+                        }
+                    }
+                    if (!error && blockUploaded)
+                    {
+                        blockUploaded(index);
+                    }
+                    dispatch_semaphore_signal(requestSemaphore);
+                    dispatch_group_leave(requestGroup);
+                }];
+            });
+        }
+        
+        dispatch_group_wait(requestGroup, DISPATCH_TIME_FOREVER);
+        if (uploadError)
+        {
+            completionHandler(uploadError);
+            return;
+        }
+        
+        [self uploadBlockListFromArray:blockList accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext completionHandler:completionHandler];
+    });
 }
 
 -(void)uploadFromText:(NSString *)textToUpload completionHandler:(void (^)(NSError *))completionHandler
@@ -168,8 +324,7 @@
 
 -(void)uploadFromText:(NSString *)textToUpload accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
 {
-    NSInputStream *sourceStream = [NSInputStream inputStreamWithData:[textToUpload dataUsingEncoding:NSUTF8StringEncoding]];
-    [self uploadFromStream:sourceStream accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+    [self uploadFromData:[textToUpload dataUsingEncoding:NSUTF8StringEncoding] accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
 }
 
 -(void)uploadFromFileWithPath:(NSString *)filePath completionHandler:(void (^)(NSError *))completionHandler
@@ -179,8 +334,19 @@
 
 -(void)uploadFromFileWithPath:(NSString *)filePath accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
 {
+    // Mapping the file lets its blocks be read and uploaded concurrently, straight from the page cache.
+    NSError *mappingError = nil;
+    NSData *fileData = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedAlways error:&mappingError];
+    if (fileData)
+    {
+        [self uploadFromData:fileData accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+        return;
+    }
+    
+    [operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Could not map file for upload, falling back to streaming.  Error code = %ld, error domain = %@", (long)mappingError.code, mappingError.domain];
     NSInputStream *sourceStream = [NSInputStream inputStreamWithFileAtPath:filePath];
-    [self uploadFromStream:sourceStream accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+    unsigned long long fileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil] fileSize];
+    [self uploadFromStream:sourceStream expectedLength:fileSize accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
 }
 
 -(void)uploadFromFileWithURL:(NSURL *)fileURL completionHandler:(void (^)(NSError *))completionHandler
@@ -190,35 +356,222 @@
 
 -(void)uploadFromFileWithURL:(NSURL *)fileURL accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
 {
+    if (fileURL.isFileURL)
+    {
+        [self uploadFromFileWithPath:fileURL.path accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+        return;
+    }
+    
     NSInputStream *sourceStream = [NSInputStream inputStreamWithURL:fileURL];
-    [self uploadFromStream:sourceStream accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+    [self uploadFromStream:sourceStream expectedLength:0 accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
 }
 
-// TODO: Convert the below method into an explicit 'put blob' call.
-/*
--(void)uploadFromData:(NSData *)sourceData accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
+-(void)uploadFromFileWithPath:(NSString *)filePath journalPath:(NSString *)journalPath completionHandler:(void (^)(NSError *))completionHandler
+{
+    [self uploadFromFileWithPath:filePath journalPath:journalPath accessCondition:nil requestOptions:nil operationContext:nil completionHandler:completionHandler];
+}
+
+-(void)uploadFromFileWithPath:(NSString *)filePath journalPath:(NSString *)journalPath accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
+{
+    if (operationContext == nil)
+    {
+        operationContext = [[AZSOperationContext alloc] init];
+    }
+    AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:self.client.defaultRequestOptions];
+    if (modifiedOptions.memoryGovernor || modifiedOptions.uploadTransformChain || (modifiedOptions.contentCompression != AZSContentCompressionNone))
+    {
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"A journaled upload sends blocks straight from the mapped file, so it cannot use a memory governor, compress or transform the data."}]);
+        return;
+    }
+    
+    NSError *error = nil;
+    NSData *fileData = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedAlways error:&error];
+    NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:&error];
+    if (!fileData || !fileAttributes)
+    {
+        NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:@"Could not read the file to upload." forKey:NSLocalizedDescriptionKey];
+        if (error)
+        {
+            userInfo[AZSInnerErrorString] = error;
+        }
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:userInfo]);
+        return;
+    }
+    
+    NSDictionary *sourceIdentity = [AZSBlobUploadJournal sourceIdentityForFilePath:filePath attributes:fileAttributes blobURL:self.storageUri.primaryUri];
+    NSUInteger blockSize = [AZSBlobUploadHelper blockSizeForLength:fileData.length requestOptions:modifiedOptions];
+    AZSBlobUploadJournal *journal = [AZSBlobUploadJournal journalAtPath:journalPath sourceIdentity:sourceIdentity blockSize:blockSize error:&error];
+    if (!journal)
+    {
+        completionHandler(error);
+        return;
+    }
+    
+    void (^uploadBlocks)(NSIndexSet *) = ^(NSIndexSet *skippedBlocks) {
+        [operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Uploading file with journal, %lu blocks already staged.", (unsigned long)skippedBlocks.count];
+        [self uploadFromDataInBlocks:fileData blockRanges:[AZSCloudBlockBlob blockRangesForLength:fileData.length blockSize:journal.blockSize] blockIDForIndex:^NSString *(NSUInteger index) {
+            return [journal blockIDForIndex:index];
+        } skippedBlocks:skippedBlocks skippedBlockListMode:AZSBlockListModeLatest accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext blockUploaded:^(NSUInteger index) {
+            // A block missing from the journal is only uploaded again, so a failure to record it need not fail the upload.
+            NSError *journalError = nil;
+            if (![journal recordBlock:index error:&journalError])
+            {
+                [operationContext logAtLevel:AZSLogLevelWarning withMessage:@"Could not record block %lu in the upload journal.", (unsigned long)index];
+            }
+        } completionHandler:^(NSError *uploadError) {
+            if (!uploadError)
+            {
+                [journal removeWithError:nil];
+            }
+            completionHandler(uploadError);
+        }];
+    };
+    
+    if (!journal.resumed || journal.recordedBlocks.count == 0)
+    {
+        uploadBlocks(nil);
+        return;
+    }
+    
+    // Only trust a recorded block if the service still has it staged, with the expected size.
+    [self downloadBlockListFromFilter:AZSBlockListFilterUncommitted accessCondition:nil requestOptions:modifiedOptions operationContext:operationContext completionHandler:^(NSError *blockListError, NSArray *blockList) {
+        NSMutableIndexSet *skippedBlocks = [NSMutableIndexSet indexSet];
+        if (!blockListError)
+        {
+            NSMutableDictionary *stagedSizes = [NSMutableDictionary dictionaryWithCapacity:blockList.count];
+            for (AZSBlockListItem *item in blockList)
+            {
+                stagedSizes[item.blockID] = [NSNumber numberWithInteger:item.size];
+            }
+            
+            [journal.recordedBlocks enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+                unsigned long long offset = (unsigned long long)index * journal.blockSize;
+                if (offset < fileData.length && [stagedSizes[[journal blockIDForIndex:index]] unsignedLongLongValue] == MIN(journal.blockSize, fileData.length - offset))
+                {
+                    [skippedBlocks addIndex:index];
+                }
+            }];
+        }
+        
+        uploadBlocks(skippedBlocks);
+    }];
+}
+
+-(void)uploadFromDataWithDeduplication:(NSData *)sourceData completionHandler:(void (^)(NSError *))completionHandler
+{
+    [self uploadFromDataWithDeduplication:sourceData accessCondition:nil requestOptions:nil operationContext:nil completionHandler:completionHandler];
+}
+
+-(void)uploadFromDataWithDeduplication:(NSData *)sourceData accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
+{
+    if (operationContext == nil)
+    {
+        operationContext = [[AZSOperationContext alloc] init];
+    }
+    AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:self.client.defaultRequestOptions];
+    if (modifiedOptions.memoryGovernor || modifiedOptions.uploadTransformChain || (modifiedOptions.contentCompression != AZSContentCompressionNone))
+    {
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"A deduplicated upload names blocks by the hash of the data as given, so it cannot use a memory governor, compress or transform the data."}]);
+        return;
+    }
+    NSData *blobData = [sourceData copy];
+    
+    [self downloadBlockListFromFilter:AZSBlockListFilterCommitted accessCondition:nil requestOptions:modifiedOptions operationContext:operationContext completionHandler:^(NSError *blockListError, NSArray *committedBlocks) {
+        if (blockListError)
+        {
+            // A blob that does not exist yet has nothing to reuse.
+            if (!([blockListError.domain isEqualToString:AZSErrorDomain] && (blockListError.code == AZSEServerError) && blockListError.userInfo[AZSCHttpStatusCode] && (((NSNumber *)blockListError.userInfo[AZSCHttpStatusCode]).intValue == 404)))
+            {
+                completionHandler(blockListError);
+                return;
+            }
+            committedBlocks = nil;
+        }
+        
+        NSMutableDictionary *committedSizes = [NSMutableDictionary dictionaryWithCapacity:committedBlocks.count];
+        for (AZSBlockListItem *item in committedBlocks)
+        {
+            committedSizes[item.blockID] = [NSNumber numberWithInteger:item.size];
+        }
+        
+        // Chunk sizes stay within the service's limit on block size, and are large enough to keep the block count low.
+        AZSContentDefinedChunker *chunker = [[AZSContentDefinedChunker alloc] initWithMinimumChunkSize:(AZSCMaxBlockSize / 8) averageChunkSize:(AZSCMaxBlockSize / 4) maximumChunkSize:AZSCMaxBlockSize];
+        NSArray *chunkRanges = [chunker chunkRangesForData:blobData];
+        
+        NSMutableArray *blockIDs = [NSMutableArray arrayWithCapacity:chunkRanges.count];
+        for (NSUInteger index = 0; index < chunkRanges.count; index++)
+        {
+            [blockIDs addObject:[NSNull null]];
+        }
+        dispatch_apply(chunkRanges.count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+            NSRange chunkRange = [chunkRanges[index] rangeValue];
+            NSString *blockID = [AZSUtil calculateSHA256FromData:[NSData dataWithBytesNoCopy:(void *)(((const uint8_t *)blobData.bytes) + chunkRange.location) length:chunkRange.length freeWhenDone:NO]];
+            @synchronized(blockIDs)
+            {
+                blockIDs[index] = blockID;
+            }
+        });
+        
+        NSMutableIndexSet *committedChunks = [NSMutableIndexSet indexSet];
+        for (NSUInteger index = 0; index < chunkRanges.count; index++)
+        {
+            if ([committedSizes[blockIDs[index]] unsignedIntegerValue] == [chunkRanges[index] rangeValue].length)
+            {
+                [committedChunks addIndex:index];
+            }
+        }
+        [operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Deduplicating upload: %lu of %lu blocks already committed.", (unsigned long)committedChunks.count, (unsigned long)chunkRanges.count];
+        
+        [self uploadFromDataInBlocks:blobData blockRanges:chunkRanges blockIDForIndex:^NSString *(NSUInteger index) {
+            return blockIDs[index];
+        } skippedBlocks:committedChunks skippedBlockListMode:AZSBlockListModeCommitted accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext blockUploaded:nil completionHandler:completionHandler];
+    }];
+}
+
+-(void)uploadFromDataInSingleRequest:(NSData *)sourceData completionHandler:(void (^)(NSError *))completionHandler
+{
+    [self uploadFromDataInSingleRequest:sourceData accessCondition:nil requestOptions:nil operationContext:nil completionHandler:completionHandler];
+}
+
+-(void)uploadFromDataInSingleRequest:(NSData *)sourceData accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
 {
+    if (!operationContext)
+    {
+        operationContext = [[AZSOperationContext alloc] init];
+    }
     AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:self.client.defaultRequestOptions];
-    AZSStorageCommand * command = [[AZSStorageCommand alloc] initWithStorageCredentials:self.client.credentials storageUri:self.storageUri];
+    if (modifiedOptions.uploadTransformChain || (modifiedOptions.contentCompression != AZSContentCompressionNone))
+    {
+        completionHandler([NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:@"A single-request upload sends the data as given; use uploadFromData to compress or transform it."}]);
+        return;
+    }
+    AZSStorageCommand * command = [[AZSStorageCommand alloc] initWithStorageCredentials:self.client.credentials storageUri:self.storageUri operationContext:operationContext];
     
     NSString *contentMD5 = nil;
-    if (requestOptions.useTransactionalMD5 || requestOptions.storeBlobContentMD5)
+    if (modifiedOptions.useTransactionalMD5 || modifiedOptions.storeBlobContentMD5)
     {
-        unsigned char md5Bytes[CC_MD5_DIGEST_LENGTH];
-        CC_MD5(sourceData.bytes, sourceData.length, md5Bytes);
-        NSString *contentMD5String = [[[NSData alloc] initWithBytes:md5Bytes length:CC_MD5_DIGEST_LENGTH] base64EncodedStringWithOptions:0];
+        NSString *contentMD5String = [AZSUtil calculateMD5FromData:sourceData];
         
-        if (requestOptions.useTransactionalMD5)
+        if (modifiedOptions.useTransactionalMD5)
         {
             contentMD5 = contentMD5String;
         }
         
-        if (requestOptions.storeBlobContentMD5)
+        if (modifiedOptions.storeBlobContentMD5)
         {
             self.properties.contentMD5 = contentMD5String;
         }
     }
     
+    if (modifiedOptions.useContentCRC64)
+    {
+        self.metadata[AZSCContentCRC64MetadataKey] = [AZSCRC64 stringFromCRC64:[AZSCRC64 crc64FromData:sourceData]];
+    }
+    else
+    {
+        [self.metadata removeObjectForKey:AZSCContentCRC64MetadataKey];
+    }
+    
     [command setBuildRequest:^ NSMutableURLRequest * (NSURLComponents *urlComponents, NSTimeInterval timeout, AZSOperationContext *operationContext)
      {
          return [AZSBlobRequestFactory putBlockBlobWithLength:[sourceData length] blobProperties:self.properties contentMD5:contentMD5 cloudMetadata:self.metadata AccessCondition:accessCondition urlComponents:urlComponents timeout:timeout operationContext:operationContext];
@@ -234,23 +587,18 @@
         }
         
         [AZSCloudBlob updateEtagAndLastModifiedWithResponse:urlResponse properties:self.properties updateLength:NO];
+        self.properties.length = [NSNumber numberWithUnsignedInteger:sourceData.length];
         return nil;
     }];
     
     [command setSource:sourceData];
     
-    if (operationContext == nil)
-    {
-        operationContext = [[AZSOperationContext alloc] init];
-    }
-    
     [AZSExecutor ExecuteWithStorageCommand:command requestOptions:modifiedOptions operationContext:operationContext completionHandler:^(NSError *error, id result)
      {
          completionHandler(error);
      }];
     return;
 }
- */
 
 -(void)uploadBlockFromData:(NSData *)sourceData blockID:(NSString *)blockID completionHandler:(void (^)(NSError*))completionHandler
 {
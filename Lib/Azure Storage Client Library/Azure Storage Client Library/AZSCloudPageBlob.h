@@ -19,6 +19,8 @@
 #import "AZSCloudBlob.h"
 #import "AZSULLRange.h"
 
+@class AZSULLRangeSet;
+
 @class AZSBlobOutputStream;
 
 AZS_ASSUME_NONNULL_BEGIN
@@ -168,6 +170,24 @@ AZS_ASSUME_NONNULL_BEGIN
  */
 -(void)downloadPageRangesWithAZSULLRange:(AZSULLRange)range accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * __AZSNullable, NSArray *))completionHandler;
 
+/** Downloads the non-clear page ranges from the blob, as an AZSULLRangeSet.
+ 
+ This is the same query as downloadPageRangesWithAZSULLRange:accessCondition:requestOptions:operationContext:completionHandler:, but
+ the page ranges are parsed straight into a compact AZSULLRangeSet rather than an array of boxed ranges.  Prefer this for blobs
+ with many page ranges.
+ 
+ @param range The range of the blob to query.
+ @param accessCondition The access condition for the request.
+ @param requestOptions The options to use for the request.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when the query page ranges call completes.
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ |AZSULLRangeSet * | The page ranges queried.|
+ */
+-(void)downloadPageRangeSetWithAZSULLRange:(AZSULLRange)range accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * __AZSNullable, AZSULLRangeSet * __AZSNullable))completionHandler;
+
 /** Downloads the non-clear page ranges from the blob.
  
  This method will query the page blob on the service, and download all page ranges in the input range that are non-zero (non-clear).
@@ -560,6 +580,87 @@ AZS_ASSUME_NONNULL_BEGIN
  */
 -(void)uploadFromStream:(NSInputStream *)sourceStream size:(NSNumber *)totalBlobSize initialSequenceNumber:(AZSNullable NSNumber *)initialSequenceNumber accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
 
+/** Uploads a file to an existing page blob, skipping holes and all-zero pages.
+ 
+ The file is memory-mapped, and only the parts of it that hold data are sent: holes in a sparse file are found with SEEK_DATA and
+ SEEK_HOLE, and all-zero 512-byte pages are detected as the file is scanned.  This makes uploading a mostly-empty disk image
+ much faster than uploading it as a stream.  Non-zero pages are uploaded in parallel, in writes of up to 4 MB.  If the file's
+ length is not a multiple of 512 bytes, the final page is padded with zeros.
+ 
+ Because the existing blob may already contain data, the pages that are zero in the file are cleared rather than skipped.  Clearing
+ pages sends no data.  The blob is first resized to the file's length, rounded up to a whole page.
+ 
+ @param filePath The path to the file containing the data that the blob should contain.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)uploadFromFileWithPath:(NSString *)filePath completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Uploads a file to an existing page blob, skipping holes and all-zero pages.
+ 
+ The file is memory-mapped, and only the parts of it that hold data are sent: holes in a sparse file are found with SEEK_DATA and
+ SEEK_HOLE, and all-zero 512-byte pages are detected as the file is scanned.  This makes uploading a mostly-empty disk image
+ much faster than uploading it as a stream.  Non-zero pages are uploaded in parallel, in writes of up to 4 MB.  If the file's
+ length is not a multiple of 512 bytes, the final page is padded with zeros.
+ 
+ Because the existing blob may already contain data, the pages that are zero in the file are cleared rather than skipped.  Clearing
+ pages sends no data.  The blob is first resized to the file's length, rounded up to a whole page.
+ 
+ @param filePath The path to the file containing the data that the blob should contain.
+ @param accessCondition The access condition for the request.  It applies in full to reading and resizing the blob; only the lease ID
+ is used for the page writes, as each of them changes the blob's ETag.
+ @param requestOptions The options to use for the request.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)uploadFromFileWithPath:(NSString *)filePath accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Creates a new page blob the size of the given file, and uploads the file to it, skipping holes and all-zero pages.
+ 
+ The file is memory-mapped, and only the parts of it that hold data are sent: holes in a sparse file are found with SEEK_DATA and
+ SEEK_HOLE, and all-zero 512-byte pages are detected as the file is scanned.  This makes uploading a mostly-empty disk image
+ much faster than uploading it as a stream.  Non-zero pages are uploaded in parallel, in writes of up to 4 MB.  If the file's
+ length is not a multiple of 512 bytes, the final page is padded with zeros.
+ 
+ A new page blob is all zeros, so pages that are zero in the file are not written at all.
+ 
+ @param filePath The path to the file containing the data that the blob should contain.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)createFromFileWithPath:(NSString *)filePath completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Creates a new page blob the size of the given file, and uploads the file to it, skipping holes and all-zero pages.
+ 
+ The file is memory-mapped, and only the parts of it that hold data are sent: holes in a sparse file are found with SEEK_DATA and
+ SEEK_HOLE, and all-zero 512-byte pages are detected as the file is scanned.  This makes uploading a mostly-empty disk image
+ much faster than uploading it as a stream.  Non-zero pages are uploaded in parallel, in writes of up to 4 MB.  If the file's
+ length is not a multiple of 512 bytes, the final page is padded with zeros.
+ 
+ A new page blob is all zeros, so pages that are zero in the file are not written at all.
+ 
+ @param filePath The path to the file containing the data that the blob should contain.
+ @param sequenceNumber The initial sequence number for the blob.
+ @param accessCondition The access condition for the request.
+ @param requestOptions The options to use for the request.
+ @param operationContext The operation context to use for the call.
+ @param completionHandler The block of code to execute when the upload call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)createFromFileWithPath:(NSString *)filePath sequenceNumber:(AZSNullable NSNumber *)sequenceNumber accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
 
 @end
 
@@ -31,6 +31,9 @@
 #import "AZSBlobUploadHelper.h"
 #import "AZSBlobOutputStream.h"
 #import "AZSAccessCondition.h"
+#import "AZSConstants.h"
+#import "AZSSparsePageScanner.h"
+#import "AZSULLRangeSet.h"
 
 @interface AZSPageBlobUploadFromStreamInputContainer : NSObject
 
@@ -288,6 +291,13 @@
 }
 
 -(void)downloadPageRangesWithAZSULLRange:(AZSULLRange)range accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * __AZSNullable, NSArray *))completionHandler
+{
+    [self downloadPageRangeSetWithAZSULLRange:range accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:^(NSError *error, AZSULLRangeSet *pageRanges) {
+        completionHandler(error, pageRanges.rangeValues);
+    }];
+}
+
+-(void)downloadPageRangeSetWithAZSULLRange:(AZSULLRange)range accessCondition:(AZSNullable AZSAccessCondition *)accessCondition requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * __AZSNullable, AZSULLRangeSet * __AZSNullable))completionHandler
 {
     if (!operationContext)
     {
@@ -315,7 +325,7 @@
     }];
     
     [command setPostProcessResponse:^id(NSHTTPURLResponse *urlResponse, AZSRequestResult *requestResult, NSOutputStream *outputStream, AZSOperationContext *operationContext, NSError **error) {
-        NSArray *pageRangesResponse = [AZSGetPageRangesResponse parseGetPageRangesResponseWithData:[outputStream propertyForKey:NSStreamDataWrittenToMemoryStreamKey] operationContext:operationContext error:error];
+        AZSULLRangeSet *pageRangesResponse = [AZSGetPageRangesResponse parseGetPageRangesResponseWithData:[outputStream propertyForKey:NSStreamDataWrittenToMemoryStreamKey] operationContext:operationContext error:error];
         
         if (*error)
         {
@@ -572,6 +582,181 @@
     }];
 }
 
+-(void)uploadFromFileWithPath:(NSString *)filePath completionHandler:(void (^)(NSError * _Nullable))completionHandler
+{
+    [self uploadFromFileWithPath:filePath accessCondition:nil requestOptions:nil operationContext:nil completionHandler:completionHandler];
+}
+
+-(void)uploadFromFileWithPath:(NSString *)filePath accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * _Nullable))completionHandler
+{
+    NSError *error = nil;
+    NSData *fileData = [AZSCloudPageBlob mapFileAtPath:filePath error:&error];
+    if (!fileData)
+    {
+        completionHandler(error);
+        return;
+    }
+    
+    // Resize the blob to the file's padded length first, so that no write runs past its end and no old data is left beyond the file's.
+    NSNumber *totalBlobSize = [NSNumber numberWithUnsignedLongLong:((fileData.length + 511) / 512 * 512)];
+    [self downloadAttributesWithAccessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:^(NSError *error) {
+        if (error)
+        {
+            completionHandler(error);
+            return;
+        }
+        
+        if ([self.properties.length isEqualToNumber:totalBlobSize])
+        {
+            [self uploadPagesFromFileData:fileData filePath:filePath clearZeroPages:YES accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+            return;
+        }
+        
+        [self resizeWithSize:totalBlobSize accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:^(NSError *error) {
+            if (error)
+            {
+                completionHandler(error);
+                return;
+            }
+            
+            [self uploadPagesFromFileData:fileData filePath:filePath clearZeroPages:YES accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+        }];
+    }];
+}
+
+-(void)createFromFileWithPath:(NSString *)filePath completionHandler:(void (^)(NSError * _Nullable))completionHandler
+{
+    [self createFromFileWithPath:filePath sequenceNumber:nil accessCondition:nil requestOptions:nil operationContext:nil completionHandler:completionHandler];
+}
+
+-(void)createFromFileWithPath:(NSString *)filePath sequenceNumber:(NSNumber *)sequenceNumber accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError * _Nullable))completionHandler
+{
+    NSError *error = nil;
+    NSData *fileData = [AZSCloudPageBlob mapFileAtPath:filePath error:&error];
+    if (!fileData)
+    {
+        completionHandler(error);
+        return;
+    }
+    
+    NSNumber *totalBlobSize = [NSNumber numberWithUnsignedLongLong:((fileData.length + 511) / 512 * 512)];
+    [self createWithSize:totalBlobSize sequenceNumber:sequenceNumber accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:^(NSError * _Nullable error) {
+        if (error)
+        {
+            completionHandler(error);
+            return;
+        }
+        
+        // A new page blob reads as zeros, so zero pages need not be written.
+        [self uploadPagesFromFileData:fileData filePath:filePath clearZeroPages:NO accessCondition:accessCondition requestOptions:requestOptions operationContext:operationContext completionHandler:completionHandler];
+    }];
+}
+
++(NSData *)mapFileAtPath:(NSString *)filePath error:(NSError **)error
+{
+    NSError *mappingError = nil;
+    NSData *fileData = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedAlways error:&mappingError];
+    if (!fileData)
+    {
+        NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:@"Could not read the file to upload." forKey:NSLocalizedDescriptionKey];
+        if (mappingError)
+        {
+            userInfo[AZSInnerErrorString] = mappingError;
+        }
+        *error = [NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:userInfo];
+    }
+    
+    return fileData;
+}
+
+// Writes the non-zero pages of fileData to the blob in parallel, and, if clearZeroPages is set, clears the rest.
+-(void)uploadPagesFromFileData:(NSData *)fileData filePath:(NSString *)filePath clearZeroPages:(BOOL)clearZeroPages accessCondition:(AZSAccessCondition *)accessCondition requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext completionHandler:(void (^)(NSError *))completionHandler
+{
+    AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:self.client.defaultRequestOptions];
+    if (operationContext == nil)
+    {
+        operationContext = [[AZSOperationContext alloc] init];
+    }
+    
+    // Every page write changes the ETag, so only the lease carries over to the individual writes.
+    if (accessCondition)
+    {
+        accessCondition = [[AZSAccessCondition alloc] initWithLeaseId:accessCondition.leaseId];
+    }
+    
+    NSInteger parallelism = MAX(modifiedOptions.parallelismFactor, 1);
+    
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        uint64_t pagedLength = (fileData.length + 511) / 512 * 512;
+        NSArray *extents = [AZSSparsePageScanner dataExtentsOfFileAtPath:filePath length:fileData.length];
+        NSArray *dataRanges = [AZSSparsePageScanner nonZeroPageRangesInData:fileData extents:extents maximumRangeLength:AZSCMaxBlockSize];
+        NSArray *zeroRanges = clearZeroPages ? [AZSSparsePageScanner rangesComplementingRanges:dataRanges length:pagedLength] : @[];
+        [operationContext logAtLevel:AZSLogLevelInfo withMessage:@"Uploading sparse page blob: %lu data extents, %lu page ranges to write, %lu to clear.", (unsigned long)extents.count, (unsigned long)dataRanges.count, (unsigned long)zeroRanges.count];
+        
+        dispatch_semaphore_t requestSemaphore = dispatch_semaphore_create(parallelism);
+        dispatch_group_t requestGroup = dispatch_group_create();
+        NSObject *errorLock = [[NSObject alloc] init];
+        NSError * __block uploadError = nil;
+        void (^requestCompleted)(NSError *) = ^(NSError *error) {
+            @synchronized(errorLock)
+            {
+                if (error && !uploadError)
+                {
+                    uploadError = error;
+                }
+            }
+            dispatch_semaphore_signal(requestSemaphore);
+            dispatch_group_leave(requestGroup);
+        };
+        BOOL (^waitForRequestSlot)(void) = ^BOOL {
+            dispatch_semaphore_wait(requestSemaphore, DISPATCH_TIME_FOREVER);
+            @synchronized(errorLock)
+            {
+                if (uploadError)
+                {
+                    dispatch_semaphore_signal(requestSemaphore);
+                    return NO;
+                }
+            }
+            dispatch_group_enter(requestGroup);
+            return YES;
+        };
+        
+        for (NSValue *rangeValue in dataRanges)
+        {
+            AZSULLRange range = rangeValue.AZSULLRangeValue;
+            if (!waitForRequestSlot())
+            {
+                break;
+            }
+            
+            // The pages point into the mapped file, except a final partial page, which is padded out with zeros.
+            NSData *pageData = [NSData dataWithBytesNoCopy:(void *)(((const uint8_t *)fileData.bytes) + range.location) length:(NSUInteger)range.length freeWhenDone:NO];
+            if (range.length % 512 != 0)
+            {
+                NSMutableData *paddedData = [pageData mutableCopy];
+                [paddedData setLength:(NSUInteger)((range.length + 511) / 512 * 512)];
+                pageData = paddedData;
+            }
+            
+            [self uploadPagesWithData:pageData startOffset:[NSNumber numberWithUnsignedLongLong:range.location] contentMD5:nil accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext completionHandler:requestCompleted];
+        }
+        
+        for (NSValue *rangeValue in zeroRanges)
+        {
+            if (!waitForRequestSlot())
+            {
+                break;
+            }
+            
+            [self clearPagesWithAZSULLRange:rangeValue.AZSULLRangeValue accessCondition:accessCondition requestOptions:modifiedOptions operationContext:operationContext completionHandler:requestCompleted];
+        }
+        
+        dispatch_group_wait(requestGroup, DISPATCH_TIME_FOREVER);
+        completionHandler(uploadError);
+    });
+}
+
 -(AZSBlobOutputStream *)createOutputStream
 {
     return [self createOutputStreamWithAccessCondition:nil requestOptions:nil operationContext:nil];
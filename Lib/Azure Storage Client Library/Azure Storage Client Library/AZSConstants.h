@@ -41,9 +41,13 @@ FOUNDATION_EXPORT NSString *const AZSCUtc;
 FOUNDATION_EXPORT NSString *const AZSCBlobAppendBlob;
 FOUNDATION_EXPORT NSString *const AZSCBlobBlockBlob;
 FOUNDATION_EXPORT NSString *const AZSCBlobPageBlob;
+FOUNDATION_EXPORT NSString *const AZSCContentCRC64MetadataKey;
+FOUNDATION_EXPORT NSString *const AZSCContentEncodingDeflate;
+FOUNDATION_EXPORT NSString *const AZSCContentEncodingGzip;
 
 FOUNDATION_EXPORT NSInteger const AZSCKilobyte;
 FOUNDATION_EXPORT NSInteger const AZSCMaxBlockSize;
+FOUNDATION_EXPORT NSInteger const AZSCMaxSingleBlobUploadSize;
 FOUNDATION_EXPORT NSInteger const AZSCSnapshotIndex;
 
 // Account Settings
@@ -41,9 +41,13 @@ NSString *const AZSCUtc = @"UTC";
 NSString *const AZSCBlobAppendBlob = @"AppendBlob";
 NSString *const AZSCBlobBlockBlob = @"BlockBlob";
 NSString *const AZSCBlobPageBlob = @"PageBlob";
+NSString *const AZSCContentCRC64MetadataKey = @"azscontentcrc64";
+NSString *const AZSCContentEncodingDeflate = @"deflate";
+NSString *const AZSCContentEncodingGzip = @"gzip";
 
 NSInteger const AZSCKilobyte = 1024;
 NSInteger const AZSCMaxBlockSize = 4 * AZSCKilobyte * AZSCKilobyte;
+NSInteger const AZSCMaxSingleBlobUploadSize = 64 * AZSCKilobyte * AZSCKilobyte;
 NSInteger const AZSCSnapshotIndex = 2;
 
 // Account Settings
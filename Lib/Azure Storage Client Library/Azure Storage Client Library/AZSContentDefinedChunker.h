@@ -0,0 +1,40 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSContentDefinedChunker.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+// This class is reserved for internal use.
+// Splits data into variable-sized chunks whose boundaries depend only on the nearby content (using a gear rolling hash), so an
+// insertion or deletion in the data only changes the chunks around it, and the rest of the chunks are the same as before.
+@interface AZSContentDefinedChunker : NSObject
+
+@property (readonly) NSUInteger minimumChunkSize;
+@property (readonly) NSUInteger averageChunkSize;
+@property (readonly) NSUInteger maximumChunkSize;
+
+// averageChunkSize is rounded down to a power of two.
+-(instancetype)initWithMinimumChunkSize:(NSUInteger)minimumChunkSize averageChunkSize:(NSUInteger)averageChunkSize maximumChunkSize:(NSUInteger)maximumChunkSize AZS_DESIGNATED_INITIALIZER;
+
+// Returns the chunks of data as an array of NSValue-wrapped NSRanges, in order and covering all of the data.
+-(NSArray *)chunkRangesForData:(NSData *)data;
+
+@end
+
+AZS_ASSUME_NONNULL_END
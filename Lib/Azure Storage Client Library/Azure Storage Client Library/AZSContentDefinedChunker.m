@@ -0,0 +1,112 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSContentDefinedChunker.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSContentDefinedChunker.h"
+
+// A random value for each byte, mixed into the rolling hash.  The table is generated from a fixed seed, so chunk boundaries
+// (and therefore block IDs) are the same on every device and in every version of the library.
+static uint64_t AZSGearTable[256];
+
+@interface AZSContentDefinedChunker()
+
+@property (readonly) uint64_t boundaryMask;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSContentDefinedChunker
+
++(void)initialize
+{
+    if (self == [AZSContentDefinedChunker class])
+    {
+        // splitmix64
+        uint64_t state = 0x417a757265424c42ULL;
+        for (NSUInteger i = 0; i < 256; i++)
+        {
+            state += 0x9e3779b97f4a7c15ULL;
+            uint64_t value = state;
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+            AZSGearTable[i] = value ^ (value >> 31);
+        }
+    }
+}
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithMinimumChunkSize:(NSUInteger)minimumChunkSize averageChunkSize:(NSUInteger)averageChunkSize maximumChunkSize:(NSUInteger)maximumChunkSize
+{
+    self = [super init];
+    if (self)
+    {
+        NSUInteger maskBits = 0;
+        while (((NSUInteger)2 << maskBits) <= averageChunkSize)
+        {
+            maskBits++;
+        }
+
+        _averageChunkSize = (NSUInteger)1 << maskBits;
+        _maximumChunkSize = MAX(maximumChunkSize, 1);
+        _minimumChunkSize = MIN(minimumChunkSize, _maximumChunkSize);
+
+        // The hash shifts left each byte, so its high bits depend on the most bytes; test those for a boundary.
+        _boundaryMask = (maskBits == 0) ? 0 : (((uint64_t)1 << maskBits) - 1) << (64 - maskBits);
+    }
+
+    return self;
+}
+
+-(NSArray *)chunkRangesForData:(NSData *)data
+{
+    NSMutableArray *chunkRanges = [NSMutableArray arrayWithCapacity:(data.length / self.averageChunkSize + 1)];
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    NSUInteger chunkStart = 0;
+
+    // Read once, out of the per-byte loop.
+    uint64_t boundaryMask = self.boundaryMask;
+    NSUInteger minimumChunkSize = self.minimumChunkSize;
+    NSUInteger maximumChunkSize = self.maximumChunkSize;
+
+    while (chunkStart < length)
+    {
+        NSUInteger chunkEnd = MIN(chunkStart + maximumChunkSize, length);
+        NSUInteger position = MIN(chunkStart + minimumChunkSize, chunkEnd);
+        uint64_t hash = 0;
+        for (; position < chunkEnd; position++)
+        {
+            hash = (hash << 1) + AZSGearTable[bytes[position]];
+            if ((hash & boundaryMask) == 0)
+            {
+                chunkEnd = position + 1;
+                break;
+            }
+        }
+
+        [chunkRanges addObject:[NSValue valueWithRange:NSMakeRange(chunkStart, chunkEnd - chunkStart)]];
+        chunkStart = chunkEnd;
+    }
+
+    return chunkRanges;
+}
+
+@end
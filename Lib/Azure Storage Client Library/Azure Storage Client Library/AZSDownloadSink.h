@@ -0,0 +1,126 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSDownloadSink.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSEnums.h"
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+/** An AZSDownloadSink consumes the data of a download.
+
+ A download to several sinks hands each chunk of received data to every sink, without copying it.  Each sink is called on its own
+ serial queue, so sinks run concurrently with each other and with the network transfer, but each sink sees the chunks in order.
+ The download only buffers up to maximumDownloadBufferSize bytes ahead of the slowest sink; beyond that, the transfer waits.
+ */
+@protocol AZSDownloadSink <NSObject>
+
+/** Consumes the next chunk of downloaded data.
+
+ This may block; blocking slows down the download.
+
+ @param data The data.  It is shared with the other sinks, so it must not be modified, but it is never reused, so the sink may keep it.
+ @param error Set to an error describing the failure, if the data could not be consumed.
+ @returns YES if the data was consumed, NO otherwise.  Returning NO fails the download.
+ */
+-(BOOL)consumeData:(NSData *)data error:(NSError **)error;
+
+@end
+
+/** An AZSDownloadSink that writes to an NSOutputStream.
+
+ The stream is written to synchronously, on the sink's own queue.  The stream should already be open, and should not be scheduled on a runloop.
+ */
+@interface AZSOutputStreamDownloadSink : NSObject <AZSDownloadSink>
+
+/** The destination stream.*/
+@property (strong, readonly) NSOutputStream *stream;
+
+/** Initializes a newly allocated AZSOutputStreamDownloadSink object.
+
+ @param stream The destination stream.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithStream:(NSOutputStream *)stream AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+/** An AZSDownloadSink that passes each chunk to a block.*/
+@interface AZSBlockDownloadSink : NSObject <AZSDownloadSink>
+
+/** Initializes a newly allocated AZSBlockDownloadSink object.
+
+ @param consumeBlock The block to call with each chunk of data.  Return NO (and populate the error) to fail the download.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithBlock:(BOOL (^)(NSData *data, NSError **error))consumeBlock AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+/** An AZSDownloadSink that hashes the data.*/
+@interface AZSDigestDownloadSink : NSObject <AZSDownloadSink>
+
+/** The hash algorithm.*/
+@property (readonly) AZSDigestAlgorithm algorithm;
+
+/** The digest of all data consumed so far.  This may be read at any time, but is normally read after the download completes.*/
+@property (strong, readonly) NSData *digest;
+
+/** Initializes a newly allocated AZSDigestDownloadSink object.
+
+ @param algorithm The hash algorithm to use.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithAlgorithm:(AZSDigestAlgorithm)algorithm AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+/** An AZSDownloadSink that splits the data into delimited records, and delivers them to a block in batches.
+ 
+ Records that lie entirely within one received chunk are delivered as subranges of that chunk; only a record that spans a chunk
+ boundary is copied.  The delimiter is not included in the records, and a delimiter immediately following another yields an empty
+ record.  Because the last record need not be followed by a delimiter, call finish after the download has completed to deliver it.
+ */
+@interface AZSRecordDownloadSink : NSObject <AZSDownloadSink>
+
+/** The delimiter separating records.*/
+@property (copy, readonly) NSData *delimiter;
+
+/** The largest number of records delivered in a single batch.*/
+@property (readonly) NSUInteger maximumBatchSize;
+
+/** The number of records delivered so far.*/
+@property (readonly) NSUInteger recordCount;
+
+/** YES if the batch handler asked to stop.  Once stopped, consumeData fails with AZSEOperationCanceled.*/
+@property (readonly) BOOL stopped;
+
+/** Initializes a newly allocated AZSRecordDownloadSink object.
+ 
+ @param delimiter The delimiter separating records, for example a newline.  Must not be empty.
+ @param maximumBatchSize The largest number of records to deliver in a single batch.  Pending records are always delivered at the end of each chunk.
+ @param batchHandler The block to call with each batch of records.  It is called serially, on the sink's queue.  Set *stop to YES to stop reading.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithDelimiter:(NSData *)delimiter maximumBatchSize:(NSUInteger)maximumBatchSize batchHandler:(void (^)(NSArray *records, BOOL *stop))batchHandler AZS_DESIGNATED_INITIALIZER;
+
+/** Delivers the final record, if the data did not end with a delimiter.  Call this once all data has been consumed.*/
+-(void)finish;
+
+@end
+
+AZS_ASSUME_NONNULL_END
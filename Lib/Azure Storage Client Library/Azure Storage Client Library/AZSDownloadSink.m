@@ -0,0 +1,335 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSDownloadSink.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <CommonCrypto/CommonDigest.h>
+#import "AZSDownloadSink.h"
+#import "AZSErrors.h"
+
+@interface AZSOutputStreamDownloadSink()
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSOutputStreamDownloadSink
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithStream:(NSOutputStream *)stream
+{
+    self = [super init];
+    if (self)
+    {
+        _stream = stream;
+    }
+
+    return self;
+}
+
+-(BOOL)consumeData:(NSData *)data error:(NSError **)error
+{
+    NSUInteger totalWritten = 0;
+    while (totalWritten < data.length)
+    {
+        NSInteger lengthWritten = [self.stream write:((const uint8_t *)data.bytes) + totalWritten maxLength:(data.length - totalWritten)];
+        if (lengthWritten <= 0)
+        {
+            NSMutableDictionary *userInfo = [NSMutableDictionary dictionary];
+            if (self.stream.streamError)
+            {
+                userInfo[AZSInnerErrorString] = self.stream.streamError;
+            }
+            *error = [NSError errorWithDomain:AZSErrorDomain code:((lengthWritten == 0) ? AZSEOutputStreamFull : AZSEOutputStreamError) userInfo:userInfo];
+            return NO;
+        }
+        totalWritten += lengthWritten;
+    }
+
+    return YES;
+}
+
+@end
+
+@interface AZSBlockDownloadSink()
+
+@property (copy) BOOL (^consumeBlock)(NSData *, NSError **);
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSBlockDownloadSink
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithBlock:(BOOL (^)(NSData *, NSError **))consumeBlock
+{
+    self = [super init];
+    if (self)
+    {
+        _consumeBlock = consumeBlock;
+    }
+
+    return self;
+}
+
+-(BOOL)consumeData:(NSData *)data error:(NSError **)error
+{
+    return self.consumeBlock(data, error);
+}
+
+@end
+
+@interface AZSDigestDownloadSink()
+{
+    CC_MD5_CTX _md5Context;
+    CC_SHA1_CTX _sha1Context;
+    CC_SHA256_CTX _sha256Context;
+}
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSDigestDownloadSink
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithAlgorithm:(AZSDigestAlgorithm)algorithm
+{
+    self = [super init];
+    if (self)
+    {
+        _algorithm = algorithm;
+        switch (algorithm)
+        {
+            case AZSDigestAlgorithmMD5:
+                CC_MD5_Init(&_md5Context);
+                break;
+            case AZSDigestAlgorithmSHA1:
+                CC_SHA1_Init(&_sha1Context);
+                break;
+            case AZSDigestAlgorithmSHA256:
+                CC_SHA256_Init(&_sha256Context);
+                break;
+        }
+    }
+
+    return self;
+}
+
+-(BOOL)consumeData:(NSData *)data error:(NSError **)error
+{
+    @synchronized(self)
+    {
+        switch (self.algorithm)
+        {
+            case AZSDigestAlgorithmMD5:
+                CC_MD5_Update(&_md5Context, data.bytes, (CC_LONG) data.length);
+                break;
+            case AZSDigestAlgorithmSHA1:
+                CC_SHA1_Update(&_sha1Context, data.bytes, (CC_LONG) data.length);
+                break;
+            case AZSDigestAlgorithmSHA256:
+                CC_SHA256_Update(&_sha256Context, data.bytes, (CC_LONG) data.length);
+                break;
+        }
+    }
+
+    return YES;
+}
+
+-(NSData *)digest
+{
+    // Finalize a copy of the context, so that the digest can be read more than once (or before the download completes.)
+    @synchronized(self)
+    {
+        switch (self.algorithm)
+        {
+            case AZSDigestAlgorithmMD5:
+            {
+                CC_MD5_CTX context = _md5Context;
+                unsigned char digestBytes[CC_MD5_DIGEST_LENGTH];
+                CC_MD5_Final(digestBytes, &context);
+                return [NSData dataWithBytes:digestBytes length:CC_MD5_DIGEST_LENGTH];
+            }
+            case AZSDigestAlgorithmSHA1:
+            {
+                CC_SHA1_CTX context = _sha1Context;
+                unsigned char digestBytes[CC_SHA1_DIGEST_LENGTH];
+                CC_SHA1_Final(digestBytes, &context);
+                return [NSData dataWithBytes:digestBytes length:CC_SHA1_DIGEST_LENGTH];
+            }
+            case AZSDigestAlgorithmSHA256:
+            default:
+            {
+                CC_SHA256_CTX context = _sha256Context;
+                unsigned char digestBytes[CC_SHA256_DIGEST_LENGTH];
+                CC_SHA256_Final(digestBytes, &context);
+                return [NSData dataWithBytes:digestBytes length:CC_SHA256_DIGEST_LENGTH];
+            }
+        }
+    }
+}
+
+@end
+
+@interface AZSRecordDownloadSink()
+
+@property (copy) void (^batchHandler)(NSArray *, BOOL *);
+@property (strong) NSMutableData *partialRecord;
+@property (strong) NSMutableArray *batch;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSRecordDownloadSink
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithDelimiter:(NSData *)delimiter maximumBatchSize:(NSUInteger)maximumBatchSize batchHandler:(void (^)(NSArray *, BOOL *))batchHandler
+{
+    self = [super init];
+    if (self)
+    {
+        _delimiter = [delimiter copy];
+        _maximumBatchSize = MAX(maximumBatchSize, 1);
+        _batchHandler = batchHandler;
+        _partialRecord = [NSMutableData data];
+        _batch = [NSMutableArray arrayWithCapacity:_maximumBatchSize];
+        _recordCount = 0;
+        _stopped = NO;
+    }
+
+    return self;
+}
+
+-(BOOL)consumeData:(NSData *)data error:(NSError **)error
+{
+    NSUInteger delimiterLength = self.delimiter.length;
+    NSUInteger offset = 0;
+
+    if (!self.stopped && self.partialRecord.length > 0)
+    {
+        // Look for a delimiter that straddles the chunk boundary, by temporarily appending just enough of the chunk to complete one.
+        NSUInteger searchStart = (self.partialRecord.length >= delimiterLength - 1) ? self.partialRecord.length - (delimiterLength - 1) : 0;
+        NSUInteger peekLength = MIN(delimiterLength - 1, data.length);
+        [self.partialRecord appendBytes:data.bytes length:peekLength];
+        NSRange delimiterRange = [self.partialRecord rangeOfData:self.delimiter options:0 range:NSMakeRange(searchStart, self.partialRecord.length - searchStart)];
+        NSUInteger previousLength = self.partialRecord.length - peekLength;
+
+        if (delimiterRange.location != NSNotFound)
+        {
+            offset = delimiterRange.location + delimiterLength - previousLength;
+            [self.partialRecord setLength:delimiterRange.location];
+        }
+        else
+        {
+            [self.partialRecord setLength:previousLength];
+            delimiterRange = [data rangeOfData:self.delimiter options:0 range:NSMakeRange(0, data.length)];
+            if (delimiterRange.location == NSNotFound)
+            {
+                [self.partialRecord appendData:data];
+                return YES;
+            }
+
+            [self.partialRecord appendBytes:data.bytes length:delimiterRange.location];
+            offset = delimiterRange.location + delimiterLength;
+        }
+
+        [self addRecord:[self.partialRecord copy]];
+        [self.partialRecord setLength:0];
+    }
+
+    while (!self.stopped && offset < data.length)
+    {
+        NSRange delimiterRange = [data rangeOfData:self.delimiter options:0 range:NSMakeRange(offset, data.length - offset)];
+        if (delimiterRange.location == NSNotFound)
+        {
+            [self.partialRecord appendBytes:((const uint8_t *)data.bytes) + offset length:(data.length - offset)];
+            break;
+        }
+
+        [self addRecord:[data subdataWithRange:NSMakeRange(offset, delimiterRange.location - offset)]];
+        offset = delimiterRange.location + delimiterLength;
+    }
+
+    [self deliverBatch];
+
+    if (self.stopped)
+    {
+        if (error)
+        {
+            *error = [NSError errorWithDomain:AZSErrorDomain code:AZSEOperationCanceled userInfo:@{NSLocalizedDescriptionKey:@"Record reading was stopped by the batch handler."}];
+        }
+        return NO;
+    }
+
+    return YES;
+}
+
+-(void)finish
+{
+    if (!self.stopped && self.partialRecord.length > 0)
+    {
+        [self addRecord:[self.partialRecord copy]];
+        [self.partialRecord setLength:0];
+    }
+
+    [self deliverBatch];
+}
+
+-(void)addRecord:(NSData *)record
+{
+    [self.batch addObject:record];
+    if (self.batch.count >= self.maximumBatchSize)
+    {
+        [self deliverBatch];
+    }
+}
+
+-(void)deliverBatch
+{
+    if (self.batch.count == 0 || self.stopped)
+    {
+        [self.batch removeAllObjects];
+        return;
+    }
+
+    NSArray *records = [self.batch copy];
+    [self.batch removeAllObjects];
+    _recordCount += records.count;
+
+    BOOL stop = NO;
+    self.batchHandler(records, &stop);
+    _stopped = stop;
+}
+
+@end
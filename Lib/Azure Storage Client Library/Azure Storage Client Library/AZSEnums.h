@@ -393,3 +393,29 @@ typedef NS_ENUM(NSInteger, AZSSequenceNumberOperator)
     /** Specifies that the request should only complete if the sequence number on the blob is equal to the sequence number in the access condition.*/
     AZSSequenceNumberOperatorEqualTo
 };
+
+/** The compression applied to blob content as it is uploaded, and removed as it is downloaded.*/
+typedef NS_ENUM(NSInteger, AZSContentCompression)
+{
+    /** No compression.*/
+    AZSContentCompressionNone,
+    
+    /** gzip, stored with a Content-Encoding of "gzip".*/
+    AZSContentCompressionGzip,
+    
+    /** zlib-wrapped deflate, stored with a Content-Encoding of "deflate".*/
+    AZSContentCompressionDeflate
+};
+
+/** The hash algorithm used by an AZSDigestDownloadSink.*/
+typedef NS_ENUM(NSInteger, AZSDigestAlgorithm)
+{
+    /** MD5.*/
+    AZSDigestAlgorithmMD5,
+    
+    /** SHA-1.*/
+    AZSDigestAlgorithmSHA1,
+    
+    /** SHA-256.*/
+    AZSDigestAlgorithmSHA256
+};
@@ -32,5 +32,8 @@ FOUNDATION_EXPORT NSString *const AZSInnerErrorString;
 #define AZSEXMLCreationError 7
 #define AZSEOutputStreamError 8
 #define AZSEOutputStreamFull 9
+#define AZSEOperationCanceled 10
+#define AZSECRC64Mismatch 11
+#define AZSETransformError 12
 
 #endif //__AZS_ERRORS_DEFINED__
\ No newline at end of file
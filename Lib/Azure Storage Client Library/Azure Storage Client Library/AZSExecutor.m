@@ -16,6 +16,7 @@
 // -----------------------------------------------------------------------------------------
 
 #import <CommonCrypto/CommonDigest.h>
+#import "AZSTransformChain.h"
 #import "AZSConstants.h"
 #import "AZSExecutor.h"
 #import "AZSOperationContext.h"
@@ -29,14 +30,21 @@
 #import "AZSRetryInfo.h"
 #import "AZSUtil.h"
 #import "AZSStorageCredentials.h"
+#import "AZSMemoryGovernor.h"
+#import "AZSDownloadSink.h"
+#import "AZSCRC64.h"
 
 @interface AZSStreamDownloadBuffer : NSObject <NSStreamDelegate>
 {
     @public
     CC_MD5_CTX _md5Context;
+    uint64_t _crc64;
 }
 
 @property (strong, readonly) NSOutputStream *stream;
+@property (strong, readonly) NSArray *sinks;
+@property (strong, readonly) NSArray *sinkQueues;
+@property (strong, readonly) NSMutableArray *sinkBytesPending;
 @property (strong, readonly) NSMutableArray *queue;
 @property NSUInteger currentLength;
 @property BOOL streamWaiting;
@@ -45,13 +53,20 @@
 @property uint64_t totalSizeStreamed;
 @property (strong, readonly) NSCondition *dataDownloadCondition;
 @property BOOL calculateMD5;
+@property BOOL calculateCRC64;
+@property (strong) AZSTransformChain *transformChain;
+@property BOOL dataTransformed;
 @property (strong, readonly) AZSOperationContext *operationContext;
 @property (strong) NSError *streamError;
+@property (strong, readonly) AZSMemoryGovernor *memoryGovernor;
+@property NSUInteger memoryReserved;
 
 -(instancetype)init AZS_DESIGNATED_INITIALIZER;
--(instancetype)initWithStream:(NSOutputStream *)stream maxSizeToBuffer:(NSUInteger)maxSizeToBuffer calculateMD5:(BOOL)calculateMD5 operationContext:(AZSOperationContext *)operationContext AZS_DESIGNATED_INITIALIZER;
+-(instancetype)initWithStream:(NSOutputStream *)stream sinks:(NSArray *)sinks maxSizeToBuffer:(NSUInteger)maxSizeToBuffer calculateMD5:(BOOL)calculateMD5 memoryGovernor:(AZSMemoryGovernor *)memoryGovernor operationContext:(AZSOperationContext *)operationContext AZS_DESIGNATED_INITIALIZER;
 -(void)stream:(NSStream *)stream handleEvent:(NSStreamEvent)eventCode;
 -(void)writeData:(NSData *)data;
+-(void)releaseReservedMemory:(NSUInteger)bytes;
+-(void)finishTransforming;
 
 @end
 
@@ -62,12 +77,24 @@
     return nil;
 }
 
--(instancetype)initWithStream:(NSOutputStream *)stream maxSizeToBuffer:(NSUInteger)maxSizeToBuffer calculateMD5:(BOOL)calculateMD5 operationContext:(AZSOperationContext *)operationContext
+-(instancetype)initWithStream:(NSOutputStream *)stream sinks:(NSArray *)sinks maxSizeToBuffer:(NSUInteger)maxSizeToBuffer calculateMD5:(BOOL)calculateMD5 memoryGovernor:(AZSMemoryGovernor *)memoryGovernor operationContext:(AZSOperationContext *)operationContext
 {
     self = [super init];
     if (self)
     {
         _stream = stream;
+        _sinks = sinks;
+        if (sinks)
+        {
+            NSMutableArray *sinkQueues = [NSMutableArray arrayWithCapacity:sinks.count];
+            _sinkBytesPending = [NSMutableArray arrayWithCapacity:sinks.count];
+            for (NSUInteger i = 0; i < sinks.count; i++)
+            {
+                [sinkQueues addObject:dispatch_queue_create("com.microsoft.azure.storage.downloadsink", DISPATCH_QUEUE_SERIAL)];
+                [_sinkBytesPending addObject:[NSNumber numberWithUnsignedInteger:0]];
+            }
+            _sinkQueues = sinkQueues;
+        }
         _queue = [[NSMutableArray alloc] init];
         _currentLength = 0;
         _streamWaiting = NO;
@@ -82,17 +109,102 @@
         {
             CC_MD5_Init(&_md5Context);
         }
+        _calculateCRC64 = NO;
+        _crc64 = 0;
+        _transformChain = nil;
+        _dataTransformed = NO;
+        _memoryGovernor = memoryGovernor;
+        _memoryReserved = 0;
     }
     
     return self;
 }
 
+// Must be called with the dataDownloadCondition lock held.
+-(void)releaseReservedMemory:(NSUInteger)bytes
+{
+    NSUInteger bytesToRelease = MIN(bytes, self.memoryReserved);
+    self.memoryReserved = self.memoryReserved - bytesToRelease;
+    [self.memoryGovernor releaseBytes:bytesToRelease];
+}
+
 -(void)writeData:(NSData *)data
 {
     if (self.calculateMD5)
     {
         CC_MD5_Update(&_md5Context, data.bytes, (unsigned int) data.length);
     }
+    if (self.calculateCRC64)
+    {
+        _crc64 = [AZSCRC64 crc64OfBytes:data.bytes length:data.length crc:_crc64];
+    }
+    
+    [self transformAndBufferData:data final:NO];
+}
+
+// Passes the end of the data through the transform chain, so that stages holding data back can flush it.
+-(void)finishTransforming
+{
+    [self transformAndBufferData:[NSData data] final:YES];
+}
+
+// Sets the stream error, if there isn't one already, and wakes anything waiting on the buffer.
+-(void)failWithError:(NSError *)error
+{
+    [self.dataDownloadCondition lock];
+    if (!self.streamError)
+    {
+        self.streamError = error;
+    }
+    [self.dataDownloadCondition broadcast];
+    [self.dataDownloadCondition unlock];
+}
+
+// Returns data that has been written to its destination to the transform chain's pool, if it came from there.
+-(void)recycleData:(NSData *)data
+{
+    [self.transformChain recycleBuffer:data];
+}
+
+// Checksums cover the data as received, so the transform chain comes after them.
+-(void)transformAndBufferData:(NSData *)data final:(BOOL)final
+{
+    if (self.transformChain)
+    {
+        self.dataTransformed = YES;
+        NSError *error = nil;
+        data = [self.transformChain transformData:data mutable:NO final:final error:&error];
+        if (!data)
+        {
+            [self failWithError:error];
+            return;
+        }
+        if (data.length == 0)
+        {
+            [self recycleData:data];
+            return;
+        }
+    }
+    
+    [self bufferData:data];
+}
+
+// Queues data for the destination stream or sinks, writing it straight away if the stream is waiting for it.
+-(void)bufferData:(NSData *)data
+{
+    // Reserve memory for this data before taking the lock, so that the stream callback can keep draining the queue (and releasing
+    // memory) while this waits.  Any memory not needed because the data was written synchronously is released below.
+    NSUInteger reservation = 0;
+    if (self.memoryGovernor)
+    {
+        reservation = [self.memoryGovernor reserveBytes:data.length minimumBytes:data.length];
+    }
+    
+    if (self.sinks)
+    {
+        [self writeDataToSinks:data reservation:reservation];
+        return;
+    }
     
     [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"About to grab lock from data pushing"];
     
@@ -112,6 +224,7 @@
     if (self.streamError)
     {
         // If there's an error, return.
+        [self.memoryGovernor releaseBytes:reservation];
         [self.dataDownloadCondition broadcast];
         [self.dataDownloadCondition unlock];
         return;
@@ -130,6 +243,7 @@
     {
         [self.queue addObject:data];
         self.currentLength = self.currentLength + [data length];
+        self.memoryReserved = self.memoryReserved + reservation;
         [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Adding to queue.  Current length = %ld, total amount streamed = %ld", (unsigned long)self.currentLength, (unsigned long)self.totalSizeStreamed];
     }
     else
@@ -157,6 +271,11 @@
         {
             self.totalSizeStreamed += lengthWritten;
             self.streamWaiting = NO;
+            
+            // Only the part of the data that couldn't be written needs to stay reserved.
+            NSUInteger reservationToKeep = MIN(reservation, [data length] - lengthWritten);
+            self.memoryReserved = self.memoryReserved + reservationToKeep;
+            reservation -= reservationToKeep;
             [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Stream not waiting."];
             // TODO: Handle 0 and -1 case;
             if (lengthWritten < [data length])
@@ -167,9 +286,12 @@
                 [self.queue addObject:[NSData dataWithBytes:buf length:lengthRemaining]];
                 self.currentLength = self.currentLength + [data length];
             }
+            [self recycleData:data];
             
             [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Current length (wrote sync) = %ld, total amount streamed = %ld", (unsigned long)self.currentLength, (unsigned long)self.totalSizeStreamed];
         }
+        [self.memoryGovernor releaseBytes:reservation];
+        
         // The following broadcast should never actually wake up anything, because the condition is only waited on in two cases:
         // - If the thread is done downloading and waiting for the buffer to clear (can't happen due to sync nature of didReceiveData and didCompleteWithError.)
         // - If the buffer is full and didReceiveData is thus blocking (in which case this method shouldn't be called.)
@@ -179,6 +301,77 @@
     [self.dataDownloadCondition unlock];
 }
 
+// Hands the data to every sink, each on its own serial queue.  The data is not copied; all sinks share the same NSData.
+// Sinks may keep the data, so a buffer from the transform chain is never returned to the pool once it has been handed out.
+// This blocks while the slowest sink is more than maxSizeToBuffer bytes behind.
+-(void)writeDataToSinks:(NSData *)data reservation:(NSUInteger)reservation
+{
+    [self.dataDownloadCondition lock];
+    while (!self.streamError && (self.currentLength > self.maxSizeToBuffer))
+    {
+        [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Waiting on datadownloadcondition in writeDataToSinks."];
+        [self.dataDownloadCondition wait];
+    }
+    
+    if (self.streamError)
+    {
+        [self.memoryGovernor releaseBytes:reservation];
+        [self.dataDownloadCondition broadcast];
+        [self.dataDownloadCondition unlock];
+        return;
+    }
+    
+    for (NSUInteger i = 0; i < self.sinks.count; i++)
+    {
+        self.sinkBytesPending[i] = [NSNumber numberWithUnsignedInteger:(((NSNumber *)self.sinkBytesPending[i]).unsignedIntegerValue + data.length)];
+    }
+    [self updateCurrentLengthFromSinks];
+    self.totalSizeStreamed += data.length;
+    [self.dataDownloadCondition unlock];
+    
+    __block NSUInteger sinksRemaining = self.sinks.count;
+    for (NSUInteger i = 0; i < self.sinks.count; i++)
+    {
+        id<AZSDownloadSink> sink = self.sinks[i];
+        dispatch_async(self.sinkQueues[i], ^{
+            NSError *sinkError = nil;
+            BOOL success = YES;
+            if (!self.streamError)
+            {
+                success = [sink consumeData:data error:&sinkError];
+            }
+            
+            [self.dataDownloadCondition lock];
+            if (!success && !self.streamError)
+            {
+                self.streamError = sinkError ?: [NSError errorWithDomain:AZSErrorDomain code:AZSEOutputStreamError userInfo:nil];
+                [self.operationContext logAtLevel:AZSLogLevelError withMessage:@"Error in writing to download sink, aborting download."];
+            }
+            
+            self.sinkBytesPending[i] = [NSNumber numberWithUnsignedInteger:(((NSNumber *)self.sinkBytesPending[i]).unsignedIntegerValue - data.length)];
+            [self updateCurrentLengthFromSinks];
+            sinksRemaining--;
+            if (sinksRemaining == 0)
+            {
+                [self.memoryGovernor releaseBytes:reservation];
+                [self.transformChain relinquishBuffer:data];
+            }
+            [self.dataDownloadCondition broadcast];
+            [self.dataDownloadCondition unlock];
+        });
+    }
+}
+
+// Must be called with the dataDownloadCondition lock held.  With sinks, the amount buffered is however far behind the slowest sink is.
+-(void)updateCurrentLengthFromSinks
+{
+    NSUInteger maxPending = 0;
+    for (NSNumber *pending in self.sinkBytesPending)
+    {
+        maxPending = MAX(maxPending, pending.unsignedIntegerValue);
+    }
+    self.currentLength = maxPending;
+}
 
 -(void)stream:(NSStream *)stream handleEvent:(NSStreamEvent)eventCode
 {
@@ -233,6 +426,7 @@
                 {
                     self.currentLength = self.currentLength - lengthWritten;
                     self.totalSizeStreamed += lengthWritten;
+                    [self releaseReservedMemory:lengthWritten];
                     [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Wrote async.  LengthWritten = %ld, desired write size = %ld.", (unsigned long)lengthWritten, (unsigned long)[self.currentDataToStream length]];
                     [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Current length (wrote async) = %ld, total amount streamed = %ld", (unsigned long)self.currentLength, (unsigned long)self.totalSizeStreamed];
                     
@@ -241,10 +435,12 @@
                         NSUInteger lengthRemaining = [self.currentDataToStream length] - lengthWritten;
                         uint8_t buf[lengthRemaining];
                         memcpy(buf, [self.currentDataToStream bytes] + lengthWritten, lengthRemaining);
+                        [self recycleData:self.currentDataToStream];
                         self.currentDataToStream = [NSData dataWithBytes:buf length:lengthRemaining];
                     }
                     else
                     {
+                        [self recycleData:self.currentDataToStream];
                         self.currentDataToStream = nil;
                     }
                 }
@@ -572,10 +768,16 @@
     self.requestResult = [[AZSRequestResult alloc] initWithStartTime:self.startTime location:self.currentStorageLocation response:self.httpResponse error:nil];
     self.preProcessError = self.storageCommand.preProcessResponse(self.httpResponse, self.requestResult, self.operationContext);
     
+    BOOL useSinks = (self.preProcessError == nil) && (self.storageCommand.destinationSinks.count > 0);
     if (self.preProcessError != nil)
     {
         self.outputStream = [NSOutputStream outputStreamToMemory];
     }
+    else if (useSinks)
+    {
+        // Sinks are written to directly from the download buffer, so no stream or runloop is needed.
+        self.outputStream = nil;
+    }
     else
     {
         // TODO: Don't bother with all the stream stuff (especially thread creation) if there is no body.
@@ -589,24 +791,32 @@
         }
     }
     
-    self.downloadBuffer = [[AZSStreamDownloadBuffer alloc]initWithStream:self.outputStream maxSizeToBuffer:self.requestOptions.maximumDownloadBufferSize calculateMD5:(self.storageCommand.calculateResponseMD5 && (self.requestResult.contentReceivedMD5 != nil)) operationContext:self.operationContext];
-    
-    [self.outputStream setDelegate:self.downloadBuffer];
-    
-    self.runLoopForDownload = self.requestOptions.runLoopForDownload;
-    if (self.runLoopForDownload == nil)
+    self.downloadBuffer = [[AZSStreamDownloadBuffer alloc]initWithStream:self.outputStream sinks:(useSinks ? self.storageCommand.destinationSinks : nil) maxSizeToBuffer:self.requestOptions.maximumDownloadBufferSize calculateMD5:(self.storageCommand.calculateResponseMD5 && (self.requestResult.contentReceivedMD5 != nil)) memoryGovernor:self.requestOptions.memoryGovernor operationContext:self.operationContext];
+    self.downloadBuffer.calculateCRC64 = self.storageCommand.calculateResponseCRC64;
+    if (self.preProcessError == nil)
     {
-        // In this case, we will open the stream inside the createAndSpinRunloopWithOutputStream method.
-        self.semaphoreForRunloopCreation = dispatch_semaphore_create(0);
-
-        [NSThread detachNewThreadSelector:@selector(createAndSpinRunloopWithOutputStream:) toTarget:self withObject:self.outputStream];
-        
-        dispatch_semaphore_wait(self.semaphoreForRunloopCreation, DISPATCH_TIME_FOREVER);
+        self.downloadBuffer.transformChain = self.storageCommand.responseTransformChain;
     }
-    else
+    
+    if (!useSinks)
     {
-        [self.outputStream scheduleInRunLoop:self.runLoopForDownload forMode:NSDefaultRunLoopMode];
-        [self.outputStream open];
+        [self.outputStream setDelegate:self.downloadBuffer];
+        
+        self.runLoopForDownload = self.requestOptions.runLoopForDownload;
+        if (self.runLoopForDownload == nil)
+        {
+            // In this case, we will open the stream inside the createAndSpinRunloopWithOutputStream method.
+            self.semaphoreForRunloopCreation = dispatch_semaphore_create(0);
+
+            [NSThread detachNewThreadSelector:@selector(createAndSpinRunloopWithOutputStream:) toTarget:self withObject:self.outputStream];
+            
+            dispatch_semaphore_wait(self.semaphoreForRunloopCreation, DISPATCH_TIME_FOREVER);
+        }
+        else
+        {
+            [self.outputStream scheduleInRunLoop:self.runLoopForDownload forMode:NSDefaultRunLoopMode];
+            [self.outputStream open];
+        }
     }
     
     
@@ -621,6 +831,13 @@
     {
         [self.downloadBuffer writeData:data];
     }
+    
+    // Once the stream or a sink has failed (or a sink has asked to stop), nothing more will be written, so stop the transfer
+    // rather than receiving the rest of the response.  The download completes, with the stream error, once the task has been canceled.
+    if (self.downloadBuffer.streamError)
+    {
+        [dataTask cancel];
+    }
 }
 
 -(void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error
@@ -633,6 +850,15 @@
         CC_MD5_Final(md5Bytes, &(self.downloadBuffer->_md5Context));
         self.requestResult.calculatedResponseMD5 = [[[NSData alloc] initWithBytes:md5Bytes length:CC_MD5_DIGEST_LENGTH] base64EncodedStringWithOptions:0];
     }
+    if (self.downloadBuffer.calculateCRC64)
+    {
+        self.requestResult.calculatedResponseCRC64 = [AZSCRC64 stringFromCRC64:self.downloadBuffer->_crc64];
+    }
+    
+    if (!error && self.downloadBuffer.transformChain && !self.downloadBuffer.streamError)
+    {
+        [self.downloadBuffer finishTransforming];
+    }
     
     [self.downloadBuffer.dataDownloadCondition lock];
     [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Grabbed lock in didComplete."];
@@ -642,13 +868,20 @@
         [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Waiting on condition in didComplete.  CurrentLength = %ld.", (unsigned long)self.downloadBuffer.currentLength];
         [self.downloadBuffer.dataDownloadCondition wait];
     }
+    
+    // If the download stopped early due to a stream error, data may still be queued; it will never be written, so release its memory.
+    [self.downloadBuffer releaseReservedMemory:self.downloadBuffer.memoryReserved];
     [self.downloadBuffer.dataDownloadCondition unlock];
     [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Released lock in didComplete."];
     
     [self.outputStream close];
     [self.outputStream removeFromRunLoop:self.runLoopForDownload forMode:NSDefaultRunLoopMode];
     
-    if (error) // If DidCompleteWithError was passed an error
+    if (self.downloadBuffer.streamError) // If there was an error in streaming (the task may have been canceled because of it)
+    {
+        [self finishRequestWithSession:session error:self.downloadBuffer.streamError retval:nil];
+    }
+    else if (error) // If DidCompleteWithError was passed an error
     {
         // TODO: Make this error retryable, and have more information with it.
         NSMutableDictionary *userInfo = [NSMutableDictionary dictionary];
@@ -656,10 +889,6 @@
         NSError *clientError = [NSError errorWithDomain:AZSErrorDomain code:AZSEURLSessionClientError userInfo:userInfo];
         [self finishRequestWithSession:session error:clientError retval:nil];
     }
-    else if (self.downloadBuffer.streamError) // If there was an error in streaming
-    {
-        [self finishRequestWithSession:session error:self.downloadBuffer.streamError retval:nil];
-    }
     else if (self.preProcessError) // If there was a server error, we can parse the XML from the service.
     {
         NSError *serverError = self.preProcessError;
@@ -751,7 +980,13 @@
     }
 
     // We cannot recover and retry the request if any data has been written to the caller's stream.
-    if (retry && (((self.storageCommand.destinationStream == self.outputStream) && self.downloadBuffer.totalSizeStreamed > 0)))
+    if (retry && (((self.storageCommand.destinationStream == self.outputStream) || self.downloadBuffer.sinks) && self.downloadBuffer.totalSizeStreamed > 0))
+    {
+        retry = NO;
+    }
+    
+    // Nor if the transform chain has seen any data, as its stages may keep state.
+    if (retry && self.downloadBuffer.dataTransformed)
     {
         retry = NO;
     }
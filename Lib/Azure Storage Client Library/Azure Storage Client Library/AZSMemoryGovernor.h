@@ -0,0 +1,71 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSMemoryGovernor.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+/** The AZSMemoryGovernor bounds the total amount of memory used for transfer buffers across many concurrent operations.
+
+ When an AZSMemoryGovernor is set on the memoryGovernor property of the request options used for an operation, download
+ buffers and upload block buffers reserve memory from it before holding data.  If the budget is exhausted, downloads block
+ until memory is released by other transfers, and uploads use smaller blocks (down to a minimum size) before blocking.
+
+ To bound memory for every operation made by a client, set a single AZSMemoryGovernor on the client's defaultRequestOptions.
+ The same instance may be shared among any number of clients.
+ */
+@interface AZSMemoryGovernor : NSObject
+
+/** The total number of bytes that may be reserved at once.*/
+@property (readonly) NSUInteger maximumBytes;
+
+/** The number of bytes currently reserved.*/
+@property (readonly) NSUInteger reservedBytes;
+
+/** The largest number of bytes that have been reserved at once.*/
+@property (readonly) NSUInteger peakReservedBytes;
+
+/** The number of reservations that had to wait for memory to be released.*/
+@property (readonly) NSUInteger waitCount;
+
+/** Initializes a newly allocated AZSMemoryGovernor object.
+
+ @param maximumBytes The total number of bytes that may be reserved at once.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithMaximumBytes:(NSUInteger)maximumBytes AZS_DESIGNATED_INITIALIZER;
+
+/** Reserves memory, blocking until at least minimumBytes are available.
+
+ Requests larger than maximumBytes are reduced to maximumBytes, so that a single large request cannot block forever.
+
+ @param desiredBytes The number of bytes the caller would like to reserve.
+ @param minimumBytes The smallest reservation the caller can make use of.
+ @returns The number of bytes actually reserved, between minimumBytes and desiredBytes.  The caller must release exactly this amount.
+ */
+-(NSUInteger)reserveBytes:(NSUInteger)desiredBytes minimumBytes:(NSUInteger)minimumBytes;
+
+/** Releases memory previously reserved, waking any callers waiting for memory.
+
+ @param bytes The number of bytes to release.
+ */
+-(void)releaseBytes:(NSUInteger)bytes;
+
+@end
+
+AZS_ASSUME_NONNULL_END
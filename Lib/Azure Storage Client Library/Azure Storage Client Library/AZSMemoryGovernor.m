@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSMemoryGovernor.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSMemoryGovernor.h"
+
+@interface AZSMemoryGovernor()
+
+@property (strong, readonly) NSCondition *memoryCondition;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSMemoryGovernor
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithMaximumBytes:(NSUInteger)maximumBytes
+{
+    self = [super init];
+    if (self)
+    {
+        _maximumBytes = maximumBytes;
+        _reservedBytes = 0;
+        _peakReservedBytes = 0;
+        _waitCount = 0;
+        _memoryCondition = [[NSCondition alloc] init];
+    }
+
+    return self;
+}
+
+-(NSUInteger)reservedBytes
+{
+    [self.memoryCondition lock];
+    NSUInteger reservedBytes = _reservedBytes;
+    [self.memoryCondition unlock];
+    return reservedBytes;
+}
+
+-(NSUInteger)reserveBytes:(NSUInteger)desiredBytes minimumBytes:(NSUInteger)minimumBytes
+{
+    desiredBytes = MIN(desiredBytes, self.maximumBytes);
+    minimumBytes = MIN(minimumBytes, desiredBytes);
+
+    [self.memoryCondition lock];
+    if (self.maximumBytes - _reservedBytes < minimumBytes)
+    {
+        _waitCount++;
+        while (self.maximumBytes - _reservedBytes < minimumBytes)
+        {
+            [self.memoryCondition wait];
+        }
+    }
+
+    NSUInteger grantedBytes = MIN(desiredBytes, self.maximumBytes - _reservedBytes);
+    _reservedBytes += grantedBytes;
+    _peakReservedBytes = MAX(_peakReservedBytes, _reservedBytes);
+    [self.memoryCondition unlock];
+
+    return grantedBytes;
+}
+
+-(void)releaseBytes:(NSUInteger)bytes
+{
+    if (bytes == 0)
+    {
+        return;
+    }
+
+    [self.memoryCondition lock];
+    _reservedBytes -= MIN(bytes, _reservedBytes);
+    [self.memoryCondition broadcast];
+    [self.memoryCondition unlock];
+}
+
+@end
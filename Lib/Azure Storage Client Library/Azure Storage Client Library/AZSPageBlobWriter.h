@@ -0,0 +1,127 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSPageBlobWriter.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+@class AZSCloudPageBlob;
+@class AZSBlobRequestOptions;
+@class AZSOperationContext;
+
+/** The AZSPageBlobWriter collects small random writes to a page blob in a write-back cache, and uploads them in large Put Page requests.
+ 
+ Writes are held in memory as dirty extents.  Writes that are adjacent to or overlap an existing extent are merged into it, so
+ that many small writes to nearby pages go out as one request of up to maximumWriteSize bytes.  Dirty data is uploaded when
+ more than maximumDirtyBytes are held, when flushInterval has passed since the cache became dirty, or when flushWithCompletionHandler
+ is called.  Extents are uploaded in parallel, up to the parallelismFactor of the request options, but an extent that overlaps a
+ write still in flight waits for it, so later writes to the same pages always win.
+ 
+ When the writer is opened, it records the blob's sequence number, and every Put Page is conditional on the blob still having that
+ sequence number.  Another writer can take over the blob by changing its sequence number, after which this writer's uploads fail
+ with a 412 error, rather than interleaving with the new writer's.
+ */
+@interface AZSPageBlobWriter : NSObject
+
+/** The blob being written.*/
+@property (strong, readonly) AZSCloudPageBlob *blob;
+
+/** The largest number of bytes uploaded in a single Put Page request.  At most 4 MB.*/
+@property (readonly) NSUInteger maximumWriteSize;
+
+/** The number of dirty bytes the cache holds before it starts uploading them.*/
+@property (readonly) NSUInteger maximumDirtyBytes;
+
+/** The longest time data stays in the cache before it is uploaded, in seconds.  0 disables time-based flushing.  Default is 1 second.*/
+@property NSTimeInterval flushInterval;
+
+/** The sequence number the writer is pinned to.  Nil until the writer has been opened.*/
+@property (copy, readonly, AZSNullable) NSNumber *sequenceNumber;
+
+/** The length of the blob, as of when the writer was opened.*/
+@property (readonly) unsigned long long blobLength;
+
+/** The number of bytes currently held in the cache and not yet uploaded.*/
+@property (readonly) NSUInteger dirtyBytes;
+
+/** The number of writes accepted.*/
+@property (readonly) NSUInteger writeCount;
+
+/** The number of Put Page requests made.*/
+@property (readonly) NSUInteger requestCount;
+
+/** The total number of bytes uploaded.*/
+@property (readonly) unsigned long long bytesUploaded;
+
+/** Initializes a newly allocated AZSPageBlobWriter object that holds up to 16 MB of dirty data.
+ 
+ @param blob The blob to write.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithBlob:(AZSCloudPageBlob *)blob;
+
+/** Initializes a newly allocated AZSPageBlobWriter object.
+ 
+ @param blob The blob to write.
+ @param maximumDirtyBytes The number of dirty bytes to hold before uploading them.
+ @param requestOptions The options to use for each request.
+ @param operationContext The operation context to use for each request.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithBlob:(AZSCloudPageBlob *)blob maximumDirtyBytes:(NSUInteger)maximumDirtyBytes requestOptions:(AZSNullable AZSBlobRequestOptions *)requestOptions operationContext:(AZSNullable AZSOperationContext *)operationContext AZS_DESIGNATED_INITIALIZER;
+
+/** Opens the writer.
+ 
+ This downloads the blob's attributes and pins the writer to the blob's current sequence number.
+ 
+ @param completionHandler The block of code to execute when the open call completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if the operation succeeded without error, error with details about the failure otherwise.|
+ */
+-(void)openWithCompletionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+/** Writes data to the cache.
+ 
+ The data is copied, and uploaded later.  If an earlier upload has failed, the write fails with that upload's error, and the
+ writer should be discarded.
+ 
+ @param data The data to write.  The length must be a multiple of 512 bytes.
+ @param offset The offset in the blob at which to write.  Must be a multiple of 512 bytes.
+ @param error Set to an error describing the failure, if the write failed.
+ @returns YES if the write was accepted, NO otherwise.
+ */
+-(BOOL)writeData:(NSData *)data atOffset:(unsigned long long)offset error:(NSError **)error;
+
+/** Uploads all dirty data.
+ 
+ The completion handler is called once the cache is empty and no uploads are in flight, so it covers every write made before the
+ call, as well as any made while the flush is in progress.
+ 
+ @param completionHandler The block of code to execute when the flush completes.
+ 
+ | Parameter name | Description |
+ |----------------|-------------|
+ |NSError * | Nil if every upload succeeded, the error from the first failed upload otherwise.|
+ */
+-(void)flushWithCompletionHandler:(void (^)(NSError* __AZSNullable))completionHandler;
+
+@end
+
+AZS_ASSUME_NONNULL_END
@@ -0,0 +1,393 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSPageBlobWriter.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSPageBlobWriter.h"
+#import "AZSAccessCondition.h"
+#import "AZSBlobProperties.h"
+#import "AZSBlobRequestOptions.h"
+#import "AZSCloudBlobClient.h"
+#import "AZSCloudPageBlob.h"
+#import "AZSConstants.h"
+#import "AZSErrors.h"
+#import "AZSOperationContext.h"
+#import "AZSULLRange.h"
+#import "AZSULLRangeSet.h"
+
+// A run of dirty pages.
+@interface AZSPageBlobWriterExtent : NSObject
+
+@property unsigned long long offset;
+@property (strong) NSMutableData *data;
+
+-(unsigned long long)end;
+
+@end
+
+@implementation AZSPageBlobWriterExtent
+
+-(unsigned long long)end
+{
+    return self.offset + self.data.length;
+}
+
+@end
+
+@interface AZSPageBlobWriter()
+
+@property (strong) AZSBlobRequestOptions *requestOptions;
+@property (strong) AZSOperationContext *operationContext;
+@property (strong) AZSAccessCondition *pinnedAccessCondition;
+
+// Sorted by offset.  Extents never overlap or touch; a write that joins two of them merges them.
+@property (strong) NSMutableArray *dirtyExtents;
+
+// The ranges of uploads that have been started but not completed.
+@property (strong) AZSULLRangeSet *inFlightRanges;
+@property (strong) NSMutableArray *flushHandlers;
+@property (strong) NSError *writeError;
+@property BOOL flushRequested;
+@property BOOL timedFlushScheduled;
+@property (strong) dispatch_queue_t uploadQueue;
+@property (strong) dispatch_semaphore_t uploadSemaphore;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation AZSPageBlobWriter
+
+@synthesize dirtyBytes = _dirtyBytes;
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithBlob:(AZSCloudPageBlob *)blob
+{
+    return [self initWithBlob:blob maximumDirtyBytes:(16 * AZSCKilobyte * AZSCKilobyte) requestOptions:nil operationContext:nil];
+}
+
+-(instancetype)initWithBlob:(AZSCloudPageBlob *)blob maximumDirtyBytes:(NSUInteger)maximumDirtyBytes requestOptions:(AZSBlobRequestOptions *)requestOptions operationContext:(AZSOperationContext *)operationContext
+{
+    self = [super init];
+    if (self)
+    {
+        _blob = blob;
+        _maximumWriteSize = AZSCMaxBlockSize;
+        _maximumDirtyBytes = MAX(maximumDirtyBytes, 512);
+        _flushInterval = 1;
+        _requestOptions = requestOptions;
+        _operationContext = operationContext ?: [[AZSOperationContext alloc] init];
+        _dirtyExtents = [NSMutableArray array];
+        _inFlightRanges = [[AZSULLRangeSet alloc] init];
+        _flushHandlers = [NSMutableArray array];
+        _flushRequested = NO;
+        _timedFlushScheduled = NO;
+        _uploadQueue = dispatch_queue_create("com.microsoft.azure.storage.pageblobwriter", DISPATCH_QUEUE_SERIAL);
+        
+        AZSBlobRequestOptions *modifiedOptions = [[AZSBlobRequestOptions copyOptions:requestOptions] applyDefaultsFromOptions:blob.client.defaultRequestOptions];
+        _uploadSemaphore = dispatch_semaphore_create(MAX(modifiedOptions.parallelismFactor, 1));
+    }
+    
+    return self;
+}
+
+-(void)openWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    [self.blob downloadAttributesWithAccessCondition:nil requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error) {
+        if (!error)
+        {
+            @synchronized(self)
+            {
+                _sequenceNumber = self.blob.properties.sequenceNumber;
+                _blobLength = self.blob.properties.length.unsignedLongLongValue;
+                self.pinnedAccessCondition = _sequenceNumber ? [[AZSAccessCondition alloc] initWithIfSequenceNumberEqualTo:_sequenceNumber] : [[AZSAccessCondition alloc] init];
+            }
+        }
+        
+        completionHandler(error);
+    }];
+}
+
+-(NSUInteger)dirtyBytes
+{
+    @synchronized(self)
+    {
+        return _dirtyBytes;
+    }
+}
+
+// Must be called while synchronized on self.  Returns the index of the first extent that ends at or after the given offset.
+-(NSUInteger)indexOfFirstExtentEndingAtOrAfter:(unsigned long long)offset
+{
+    NSUInteger low = 0;
+    NSUInteger high = self.dirtyExtents.count;
+    while (low < high)
+    {
+        NSUInteger middle = low + (high - low) / 2;
+        if ([(AZSPageBlobWriterExtent *)self.dirtyExtents[middle] end] < offset)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    
+    return low;
+}
+
+-(BOOL)writeData:(NSData *)data atOffset:(unsigned long long)offset error:(NSError **)error
+{
+    NSString *failure = nil;
+    if (!self.pinnedAccessCondition)
+    {
+        failure = @"The writer must be opened before it can be written to.";
+    }
+    else if ((offset % 512 != 0) || (data.length % 512 != 0))
+    {
+        failure = @"Page blob writes must start and end on 512-byte page boundaries.";
+    }
+    else if (offset + data.length > self.blobLength)
+    {
+        failure = @"The write runs past the end of the blob.";
+    }
+    
+    if (failure)
+    {
+        if (error)
+        {
+            *error = [NSError errorWithDomain:AZSErrorDomain code:AZSEInvalidArgument userInfo:@{NSLocalizedDescriptionKey:failure}];
+        }
+        return NO;
+    }
+    
+    if (data.length == 0)
+    {
+        return YES;
+    }
+    
+    BOOL startFlush = NO;
+    BOOL scheduleTimedFlush = NO;
+    @synchronized(self)
+    {
+        if (self.writeError)
+        {
+            if (error)
+            {
+                *error = self.writeError;
+            }
+            return NO;
+        }
+        
+        unsigned long long end = offset + data.length;
+        NSUInteger first = [self indexOfFirstExtentEndingAtOrAfter:offset];
+        NSUInteger last = first;
+        while ((last < self.dirtyExtents.count) && (((AZSPageBlobWriterExtent *)self.dirtyExtents[last]).offset <= end))
+        {
+            last++;
+        }
+        
+        AZSPageBlobWriterExtent *firstExtent = (first < last) ? self.dirtyExtents[first] : nil;
+        if (!firstExtent)
+        {
+            AZSPageBlobWriterExtent *extent = [[AZSPageBlobWriterExtent alloc] init];
+            extent.offset = offset;
+            extent.data = [data mutableCopy];
+            [self.dirtyExtents insertObject:extent atIndex:first];
+            _dirtyBytes += data.length;
+        }
+        else if ((last == first + 1) && (firstExtent.offset <= offset))
+        {
+            // The common case: the write overlaps or extends a single extent, which can be updated in place.
+            NSUInteger relativeOffset = (NSUInteger)(offset - firstExtent.offset);
+            NSUInteger previousLength = firstExtent.data.length;
+            [firstExtent.data replaceBytesInRange:NSMakeRange(relativeOffset, MIN(data.length, previousLength - relativeOffset)) withBytes:data.bytes length:data.length];
+            _dirtyBytes += firstExtent.data.length - previousLength;
+        }
+        else
+        {
+            AZSPageBlobWriterExtent *lastExtent = self.dirtyExtents[last - 1];
+            unsigned long long mergedOffset = MIN(offset, firstExtent.offset);
+            unsigned long long mergedEnd = MAX(end, [lastExtent end]);
+            NSMutableData *mergedData = [NSMutableData dataWithLength:(NSUInteger)(mergedEnd - mergedOffset)];
+            for (NSUInteger i = first; i < last; i++)
+            {
+                AZSPageBlobWriterExtent *extent = self.dirtyExtents[i];
+                memcpy(((uint8_t *)mergedData.mutableBytes) + (extent.offset - mergedOffset), extent.data.bytes, extent.data.length);
+                _dirtyBytes -= extent.data.length;
+            }
+            memcpy(((uint8_t *)mergedData.mutableBytes) + (offset - mergedOffset), data.bytes, data.length);
+            _dirtyBytes += mergedData.length;
+            
+            firstExtent.offset = mergedOffset;
+            firstExtent.data = mergedData;
+            [self.dirtyExtents removeObjectsInRange:NSMakeRange(first + 1, last - first - 1)];
+        }
+        _writeCount++;
+        
+        if (_dirtyBytes >= self.maximumDirtyBytes)
+        {
+            self.flushRequested = YES;
+            startFlush = YES;
+        }
+        else if ((self.flushInterval > 0) && !self.timedFlushScheduled)
+        {
+            self.timedFlushScheduled = YES;
+            scheduleTimedFlush = YES;
+        }
+    }
+    
+    if (scheduleTimedFlush)
+    {
+        AZSPageBlobWriter * __weak weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.flushInterval * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            AZSPageBlobWriter *writer = weakSelf;
+            @synchronized(writer)
+            {
+                writer.timedFlushScheduled = NO;
+                writer.flushRequested = YES;
+            }
+            [writer advance];
+        });
+    }
+    if (startFlush)
+    {
+        [self advance];
+    }
+    
+    return YES;
+}
+
+-(void)flushWithCompletionHandler:(void (^)(NSError *))completionHandler
+{
+    @synchronized(self)
+    {
+        [self.flushHandlers addObject:[completionHandler copy]];
+        self.flushRequested = YES;
+    }
+    [self advance];
+}
+
+// Must be called while synchronized on self.
+-(BOOL)rangeOverlapsUploadInFlight:(AZSULLRange)range
+{
+    return [self.inFlightRanges intersectsRange:range];
+}
+
+// Starts uploading dirty extents if a flush has been requested, and completes flushes once the cache is clean.
+-(void)advance
+{
+    NSMutableArray *extentsToUpload = [NSMutableArray array];
+    NSArray *completedFlushHandlers = nil;
+    NSError *error = nil;
+    @synchronized(self)
+    {
+        if (self.flushRequested && !self.writeError)
+        {
+            // An extent that overlaps an upload still in flight waits for it, so that the newer data is applied last.
+            NSMutableIndexSet *takenIndexes = [NSMutableIndexSet indexSet];
+            for (NSUInteger i = 0; i < self.dirtyExtents.count; i++)
+            {
+                AZSPageBlobWriterExtent *extent = self.dirtyExtents[i];
+                AZSULLRange extentRange = AZSULLMakeRange(extent.offset, extent.data.length);
+                if (![self rangeOverlapsUploadInFlight:extentRange])
+                {
+                    [takenIndexes addIndex:i];
+                    [extentsToUpload addObject:extent];
+                    [self.inFlightRanges addRange:extentRange];
+                    _dirtyBytes -= extent.data.length;
+                }
+            }
+            [self.dirtyExtents removeObjectsAtIndexes:takenIndexes];
+        }
+        
+        if ((self.dirtyExtents.count == 0) || self.writeError)
+        {
+            self.flushRequested = NO;
+        }
+        
+        if (((self.dirtyExtents.count == 0) || self.writeError) && (self.inFlightRanges.count == 0) && (self.flushHandlers.count > 0))
+        {
+            completedFlushHandlers = [self.flushHandlers copy];
+            [self.flushHandlers removeAllObjects];
+            error = self.writeError;
+        }
+    }
+    
+    for (AZSPageBlobWriterExtent *extent in extentsToUpload)
+    {
+        [self uploadExtent:extent];
+    }
+    
+    for (void (^flushHandler)(NSError *) in completedFlushHandlers)
+    {
+        flushHandler(error);
+    }
+}
+
+// Uploads an extent in requests of up to maximumWriteSize bytes, which run in parallel with each other and with other extents.
+-(void)uploadExtent:(AZSPageBlobWriterExtent *)extent
+{
+    AZSULLRange extentRange = AZSULLMakeRange(extent.offset, extent.data.length);
+    NSUInteger requestTotal = (extent.data.length + self.maximumWriteSize - 1) / self.maximumWriteSize;
+    NSUInteger __block requestsRemaining = requestTotal;
+    
+    [self.operationContext logAtLevel:AZSLogLevelDebug withMessage:@"Flushing %lu dirty bytes at offset %llu in %lu requests.", (unsigned long)extent.data.length, extent.offset, (unsigned long)requestTotal];
+    
+    for (NSUInteger i = 0; i < requestTotal; i++)
+    {
+        NSUInteger relativeOffset = i * self.maximumWriteSize;
+        NSUInteger length = MIN(self.maximumWriteSize, extent.data.length - relativeOffset);
+        
+        // The requests send straight from the extent's buffer, which the completion block keeps alive.
+        NSData *requestData = [NSData dataWithBytesNoCopy:((uint8_t *)extent.data.mutableBytes) + relativeOffset length:length freeWhenDone:NO];
+        NSNumber *startOffset = [NSNumber numberWithUnsignedLongLong:(extent.offset + relativeOffset)];
+        dispatch_async(self.uploadQueue, ^{
+            dispatch_semaphore_wait(self.uploadSemaphore, DISPATCH_TIME_FOREVER);
+            [self.blob uploadPagesWithData:requestData startOffset:startOffset contentMD5:nil accessCondition:self.pinnedAccessCondition requestOptions:self.requestOptions operationContext:self.operationContext completionHandler:^(NSError *error) {
+                dispatch_semaphore_signal(self.uploadSemaphore);
+                @synchronized(self)
+                {
+                    _requestCount++;
+                    if (error)
+                    {
+                        if (!self.writeError)
+                        {
+                            self.writeError = error;
+                        }
+                    }
+                    else
+                    {
+                        _bytesUploaded += length;
+                    }
+                    
+                    requestsRemaining--;
+                    if (requestsRemaining == 0)
+                    {
+                        [self.inFlightRanges removeRange:extentRange];
+                    }
+                }
+                [self advance];
+            }];
+        });
+    }
+}
+
+@end
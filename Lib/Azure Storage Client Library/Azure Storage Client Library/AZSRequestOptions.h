@@ -21,6 +21,8 @@
 
 AZS_ASSUME_NONNULL_BEGIN
 
+@class AZSMemoryGovernor;
+
 /** AZSRequestOptions contains options used for requests that are common to all requests.
  
  AZSRequestOptions is used for configuring the behavior of the Azure Storage Client Library.
@@ -71,6 +73,15 @@ AZS_ASSUME_NONNULL_BEGIN
 
 @property AZSStorageLocationMode storageLocationMode;
 
+/** The memory governor from which download buffers and upload block buffers reserve memory.  Can be nil.
+ 
+ If this is nil (the default), each operation buffers up to its own limits independently.  Share one AZSMemoryGovernor between
+ operations (for example, by setting it on a client's defaultRequestOptions) to bound the memory used by all of them together.
+ The governor itself is shared, not copied, when options are copied.  Page blob uploads fail with AZSEInvalidArgument if the governor
+ allows fewer than 512 bytes, as every page blob write must be whole pages.
+ */
+@property (strong, AZSNullable) AZSMemoryGovernor *memoryGovernor;
+
 /** Initializes a new AZSRequestOptions object.
  Once the object is initialized, individual properties can be set.*/
 -(instancetype)init AZS_DESIGNATED_INITIALIZER;
@@ -25,6 +25,7 @@
     BOOL _maximumDownloadBufferSizeSet;
     BOOL _maximumExecutionTimeSet;
     BOOL _storageLocationModeSet;
+    BOOL _memoryGovernorSet;
 }
 
 -(AZSRequestOptions *)copy;
@@ -39,6 +40,7 @@
 @synthesize maximumExecutionTime = _maximumExecutionTime;
 @synthesize operationExpiryTime = _operationExpiryTime;
 @synthesize storageLocationMode = _storageLocationMode;
+@synthesize memoryGovernor = _memoryGovernor;
 
 -(instancetype)init
 {
@@ -55,6 +57,8 @@
         _maximumExecutionTimeSet = NO;
         _storageLocationMode = AZSStorageLocationModePrimaryOnly;
         _storageLocationModeSet = NO;
+        _memoryGovernor = nil;
+        _memoryGovernorSet = NO;
     }
     
     return self;
@@ -108,6 +112,11 @@
             self.storageLocationMode = sourceOptions.storageLocationMode;
         }
         
+        if (sourceOptions->_memoryGovernorSet)
+        {
+            self.memoryGovernor = sourceOptions.memoryGovernor;
+        }
+        
         _operationExpiryTime = [NSDate dateWithTimeIntervalSinceNow:self.maximumExecutionTime];
     }
     
@@ -169,4 +178,15 @@
     _storageLocationModeSet = YES;
 }
 
+-(AZSMemoryGovernor *)memoryGovernor
+{
+    return _memoryGovernor;
+}
+
+-(void)setMemoryGovernor:(AZSMemoryGovernor *)memoryGovernor
+{
+    _memoryGovernor = memoryGovernor;
+    _memoryGovernorSet = YES;
+}
+
 @end
\ No newline at end of file
@@ -69,6 +69,9 @@ AZS_ASSUME_NONNULL_BEGIN
  This is unrelated to the Content-MD5 header of the request.*/
 @property (copy, AZSNullable) NSString *calculatedResponseMD5;
 
+/** The CRC64 that was calculated for the response to this request, if requested, in the form stored by useContentCRC64.*/
+@property (copy, AZSNullable) NSString *calculatedResponseCRC64;
+
 // TODO: Should we also include the uploaded MD5?
 
 -(instancetype) initWithStartTime:(NSDate *)startTime location:(AZSStorageLocation)currentLocation AZS_DESIGNATED_INITIALIZER;
@@ -0,0 +1,42 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSSparsePageScanner.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+#import "AZSULLRange.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+// This class is reserved for internal use.
+// Finds the parts of a page blob's source data that actually need to be written: data that is neither in a hole of a sparse file
+// nor made up of all-zero 512-byte pages.  All ranges are arrays of NSValue-wrapped AZSULLRanges, in order and not overlapping.
+@interface AZSSparsePageScanner : NSObject
+
+// The extents of the file that contain data, found with SEEK_DATA and SEEK_HOLE.  If the file system cannot report holes, the
+// whole file is one extent.
++(NSArray *)dataExtentsOfFileAtPath:(NSString *)filePath length:(uint64_t)length;
+
+// The page-aligned ranges within the given extents that contain at least one non-zero byte.  Adjacent non-zero pages are merged,
+// and no range is longer than maximumRangeLength (a multiple of 512.)  The final range may end with a partial page.
++(NSArray *)nonZeroPageRangesInData:(NSData *)data extents:(NSArray *)extents maximumRangeLength:(uint64_t)maximumRangeLength;
+
+// The ranges between 0 and length not covered by the given ranges.
++(NSArray *)rangesComplementingRanges:(NSArray *)ranges length:(uint64_t)length;
+
+@end
+
+AZS_ASSUME_NONNULL_END
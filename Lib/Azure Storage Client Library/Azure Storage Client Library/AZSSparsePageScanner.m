@@ -0,0 +1,172 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSSparsePageScanner.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#import "AZSSparsePageScanner.h"
+
+static const uint64_t AZSPageSize = 512;
+
+// Checks a page 64 bits at a time, with independent accumulators so that the compiler can vectorize the loop.
+static BOOL AZSIsZeroPage(const uint8_t *bytes, uint64_t length)
+{
+    uint64_t wordCount = length / sizeof(uint64_t);
+    const uint64_t *words = (const uint64_t *)bytes;
+    uint64_t accumulators[4] = {0, 0, 0, 0};
+    uint64_t i = 0;
+    for (; i + 4 <= wordCount; i += 4)
+    {
+        accumulators[0] |= words[i];
+        accumulators[1] |= words[i + 1];
+        accumulators[2] |= words[i + 2];
+        accumulators[3] |= words[i + 3];
+    }
+    for (; i < wordCount; i++)
+    {
+        accumulators[0] |= words[i];
+    }
+
+    uint8_t tail = 0;
+    for (uint64_t j = wordCount * sizeof(uint64_t); j < length; j++)
+    {
+        tail |= bytes[j];
+    }
+
+    return ((accumulators[0] | accumulators[1] | accumulators[2] | accumulators[3]) == 0) && (tail == 0);
+}
+
+@implementation AZSSparsePageScanner
+
++(NSArray *)dataExtentsOfFileAtPath:(NSString *)filePath length:(uint64_t)length
+{
+    NSArray *wholeFile = @[[NSValue valueWithAZSULLRange:AZSULLMakeRange(0, length)]];
+
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+    int fileDescriptor = open(filePath.fileSystemRepresentation, O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return wholeFile;
+    }
+
+    NSMutableArray *extents = [NSMutableArray array];
+    off_t position = 0;
+    while ((uint64_t)position < length)
+    {
+        off_t dataStart = lseek(fileDescriptor, position, SEEK_DATA);
+        if (dataStart < 0)
+        {
+            // ENXIO means there is no more data; anything else means holes are not supported here.
+            if (errno != ENXIO)
+            {
+                extents = nil;
+            }
+            break;
+        }
+
+        off_t dataEnd = lseek(fileDescriptor, dataStart, SEEK_HOLE);
+        if (dataEnd < 0)
+        {
+            extents = nil;
+            break;
+        }
+
+        dataEnd = MIN(dataEnd, (off_t)length);
+        if (dataEnd > dataStart)
+        {
+            [extents addObject:[NSValue valueWithAZSULLRange:AZSULLMakeRange(dataStart, dataEnd - dataStart)]];
+        }
+        position = dataEnd;
+    }
+
+    close(fileDescriptor);
+    return extents ?: wholeFile;
+#else
+    return wholeFile;
+#endif
+}
+
++(NSArray *)nonZeroPageRangesInData:(NSData *)data extents:(NSArray *)extents maximumRangeLength:(uint64_t)maximumRangeLength
+{
+    NSMutableArray *ranges = [NSMutableArray array];
+    const uint8_t *bytes = data.bytes;
+    uint64_t dataLength = data.length;
+    uint64_t rangeStart = 0;
+    uint64_t rangeEnd = 0;
+
+    for (NSValue *extentValue in extents)
+    {
+        // Holes need not be page-aligned, so widen each extent to whole pages.
+        AZSULLRange extent = extentValue.AZSULLRangeValue;
+        uint64_t pageStart = MAX(extent.location / AZSPageSize * AZSPageSize, rangeEnd);
+        uint64_t extentEnd = MIN(AZSULLMaxRange(extent), dataLength);
+
+        for (; pageStart < extentEnd; pageStart += AZSPageSize)
+        {
+            uint64_t pageLength = MIN(AZSPageSize, dataLength - pageStart);
+            if (AZSIsZeroPage(bytes + pageStart, pageLength))
+            {
+                continue;
+            }
+
+            if (rangeEnd > rangeStart && pageStart == rangeEnd && (rangeEnd - rangeStart) < maximumRangeLength)
+            {
+                rangeEnd += pageLength;
+            }
+            else
+            {
+                if (rangeEnd > rangeStart)
+                {
+                    [ranges addObject:[NSValue valueWithAZSULLRange:AZSULLMakeRange(rangeStart, rangeEnd - rangeStart)]];
+                }
+                rangeStart = pageStart;
+                rangeEnd = pageStart + pageLength;
+            }
+        }
+    }
+
+    if (rangeEnd > rangeStart)
+    {
+        [ranges addObject:[NSValue valueWithAZSULLRange:AZSULLMakeRange(rangeStart, rangeEnd - rangeStart)]];
+    }
+
+    return ranges;
+}
+
++(NSArray *)rangesComplementingRanges:(NSArray *)ranges length:(uint64_t)length
+{
+    NSMutableArray *complement = [NSMutableArray array];
+    uint64_t position = 0;
+    for (NSValue *rangeValue in ranges)
+    {
+        AZSULLRange range = rangeValue.AZSULLRangeValue;
+        if (range.location > position)
+        {
+            [complement addObject:[NSValue valueWithAZSULLRange:AZSULLMakeRange(position, range.location - position)]];
+        }
+        position = MAX(position, AZSULLMaxRange(range));
+    }
+
+    if (length > position)
+    {
+        [complement addObject:[NSValue valueWithAZSULLRange:AZSULLMakeRange(position, length - position)]];
+    }
+
+    return complement;
+}
+
+@end
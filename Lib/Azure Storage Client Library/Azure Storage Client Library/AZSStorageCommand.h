@@ -23,6 +23,7 @@
 @class AZSRequestResult;
 @class AZSStorageCredentials;
 @class AZSUriQueryBuilder;
+@class AZSTransformChain;
 
 @protocol AZSAuthenticationHandler;
 
@@ -32,6 +33,8 @@
 @property (nonatomic, strong, readonly) AZSStorageCredentials *credentials;
 @property (nonatomic, strong) AZSUriQueryBuilder *queryBuilder;
 @property BOOL calculateResponseMD5;
+@property BOOL calculateResponseCRC64;
+@property (strong) AZSTransformChain *responseTransformChain;
 @property (readonly) AZSAllowedStorageLocation allowedStorageLocation;
 
 @property (copy) NSMutableURLRequest *(^buildRequest)(NSURLComponents *urlComponents, NSTimeInterval timeout, AZSOperationContext *operationContext);
@@ -41,6 +44,7 @@
 @property (copy) void(^processError)(NSOutputStream *outputStream, NSError **errorToPopulate, NSError **error);
 @property (strong, nonatomic) NSData *source;
 @property (strong, nonatomic) NSOutputStream *destinationStream;
+@property (strong, nonatomic) NSArray *destinationSinks;
 
 -(instancetype) initWithStorageCredentials:(AZSStorageCredentials *)credentials storageUri:(AZSStorageUri *)storageUri operationContext:(AZSOperationContext *)operationContext;
 -(instancetype) initWithStorageCredentials:(AZSStorageCredentials *)credentials storageUri:(AZSStorageUri *)storageUri calculateResponseMD5:(BOOL)calculateResponseMD5 operationContext:(AZSOperationContext *)operationContext AZS_DESIGNATED_INITIALIZER;
@@ -49,6 +49,8 @@
     {
         _storageUri = storageUri;
         _calculateResponseMD5 = calculateResponseMD5;
+        _calculateResponseCRC64 = NO;
+        _responseTransformChain = nil;
         _allowedStorageLocation = AZSAllowedStorageLocationPrimaryOnly;
         
         // Give a default error-processing implementation.
@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSTransformChain.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+@class AZSTransformChain;
+
+/** An AZSTransformStage transforms transfer data on its way between the caller and the service.
+ 
+ Stages are chained in an AZSTransformChain.  On upload, each block buffer passes through the chain just before it is sent, so a
+ stage sees the data in the order it was written, one block-sized slice at a time.  On download, each chunk passes through the
+ chain as it is received.  Stages may keep state between slices; a chain, and its stages, must be used for only one transfer at a time.
+ */
+@protocol AZSTransformStage <NSObject>
+
+/** Transforms the next slice of data.
+ 
+ To avoid copies, the stage may modify a mutable slice in place and return it, return the slice unchanged (if it only inspects the
+ data), or write its output into a buffer from the chain's outputBufferWithLength: and return that.  Returning an empty slice is
+ allowed, for stages that hold data back until they have enough to work on.
+ 
+ @param data The slice.  If transformsInPlace is YES, this is an NSMutableData that the stage may modify (including its length.)  The
+ slice may be reused once the call returns, so a stage holding data back must copy it.
+ @param final YES if this is the last slice of the transfer.  A stage holding data back must return all of it now.  The final slice may be empty.
+ @param chain The chain the stage is running in.
+ @param error Set to an error describing the failure, if the data could not be transformed.
+ @returns The transformed slice, or nil on failure.  Returning nil fails the transfer.
+ */
+-(NSData * AZSNullable)transformData:(NSData *)data final:(BOOL)final chain:(AZSTransformChain *)chain error:(NSError **)error;
+
+@optional
+
+/** YES if the stage modifies slices in place.  The chain then always passes an NSMutableData, copying the slice once if it isn't already mutable.*/
+@property (readonly) BOOL transformsInPlace;
+
+@end
+
+/** The running totals for one stage in an AZSTransformChain.*/
+@interface AZSTransformStageStatistics : NSObject
+
+/** The number of slices the stage has transformed.*/
+@property (readonly) NSUInteger sliceCount;
+
+/** The number of bytes passed into the stage.*/
+@property (readonly) unsigned long long bytesIn;
+
+/** The number of bytes the stage returned.*/
+@property (readonly) unsigned long long bytesOut;
+
+/** The wall-clock time spent in the stage, in seconds.*/
+@property (readonly) NSTimeInterval elapsedTime;
+
+/** The CPU time spent in the stage, in seconds.  This is measured per thread, so time the stage spends waiting is not included.*/
+@property (readonly) NSTimeInterval cpuTime;
+
+/** The input throughput of the stage, in bytes per second of elapsed time.*/
+@property (readonly) double throughput;
+
+@end
+
+/** An AZSTransformChain runs transfer data through a sequence of AZSTransformStages, keeping statistics for each.
+ 
+ Set a chain as the uploadTransformChain or downloadTransformChain of an AZSBlobRequestOptions to apply it to a transfer.  Upload
+ stages see the data as it will be stored (after any contentCompression), and download stages see it as received, so blob MD5s and
+ CRC64s describe the transformed data.  A gzip or deflate Content-Encoding is decoded by the URL loading system before either.
+ Page blob uploads require stages that don't change the length of a slice, and a transformed block must not exceed the service's
+ maximum block size.
+ */
+@interface AZSTransformChain : NSObject
+
+/** The stages, in the order data passes through them.*/
+@property (copy, readonly) NSArray *stages;
+
+/** The AZSTransformStageStatistics for each stage, in the same order as stages.*/
+@property (copy, readonly) NSArray *statistics;
+
+/** Initializes a newly allocated AZSTransformChain object.
+ 
+ @param stages The stages, each conforming to AZSTransformStage, in the order data passes through them.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithStages:(NSArray *)stages AZS_DESIGNATED_INITIALIZER;
+
+/** Returns an output buffer for a stage, reusing a pooled buffer if one is available.  The buffer goes back to the pool once the
+ next stage, or the transfer, is done with it.
+ 
+ @param length The length of the buffer.  The stage may shorten it to the length of its output.  The contents are undefined.
+ @returns The buffer.
+ */
+-(NSMutableData *)outputBufferWithLength:(NSUInteger)length;
+
+// The following are helpers, meant for internal use only:
+-(NSData * AZSNullable)transformData:(NSData *)data mutable:(BOOL)mutable final:(BOOL)final error:(NSError **)error;
+-(void)recycleBuffer:(NSData *)data;
+-(void)relinquishBuffer:(NSData *)data;
+@end
+
+AZS_ASSUME_NONNULL_END
@@ -0,0 +1,211 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSTransformChain.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+#import "AZSTransformChain.h"
+#import "AZSBlockBufferPool.h"
+#import "AZSErrors.h"
+
+@interface AZSTransformStageStatistics()
+
+@property (readwrite) NSUInteger sliceCount;
+@property (readwrite) unsigned long long bytesIn;
+@property (readwrite) unsigned long long bytesOut;
+@property (readwrite) NSTimeInterval elapsedTime;
+@property (readwrite) NSTimeInterval cpuTime;
+
+@end
+
+@implementation AZSTransformStageStatistics
+
+-(double)throughput
+{
+    NSTimeInterval elapsedTime = self.elapsedTime;
+    return (elapsedTime > 0) ? (self.bytesIn / elapsedTime) : 0;
+}
+
+@end
+
+@interface AZSTransformChain()
+
+// Output buffers handed out to stages, mapped to the length they were allocated with.
+@property (strong, readonly) NSMapTable *vendedBuffers;
+
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+@end
+
+// The CPU time used by the calling thread so far.
+static NSTimeInterval AZSThreadCPUTime()
+{
+    mach_port_t thread = mach_thread_self();
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    kern_return_t result = thread_info(thread, THREAD_BASIC_INFO, (thread_info_t)&info, &count);
+    mach_port_deallocate(mach_task_self(), thread);
+    if (result != KERN_SUCCESS)
+    {
+        return 0;
+    }
+    
+    return info.user_time.seconds + info.system_time.seconds + (info.user_time.microseconds + info.system_time.microseconds) / 1000000.0;
+}
+
+// Converts a mach_absolute_time interval to seconds.
+static NSTimeInterval AZSSecondsFromMachTime(uint64_t machTime)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    
+    return (double)machTime * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+@implementation AZSTransformChain
+
+-(instancetype)init
+{
+    return nil;
+}
+
+-(instancetype)initWithStages:(NSArray *)stages
+{
+    self = [super init];
+    if (self)
+    {
+        _stages = [stages copy];
+        NSMutableArray *statistics = [NSMutableArray arrayWithCapacity:stages.count];
+        for (NSUInteger i = 0; i < stages.count; i++)
+        {
+            [statistics addObject:[[AZSTransformStageStatistics alloc] init]];
+        }
+        _statistics = statistics;
+        _vendedBuffers = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality) valueOptions:NSPointerFunctionsStrongMemory];
+    }
+    
+    return self;
+}
+
+-(NSMutableData *)outputBufferWithLength:(NSUInteger)length
+{
+    NSMutableData *buffer = [[AZSBlockBufferPool sharedPool] bufferWithLength:length];
+    @synchronized(self.vendedBuffers)
+    {
+        [self.vendedBuffers setObject:[NSNumber numberWithUnsignedInteger:length] forKey:buffer];
+    }
+    
+    return buffer;
+}
+
+-(BOOL)isVendedBuffer:(NSData *)data
+{
+    @synchronized(self.vendedBuffers)
+    {
+        return [self.vendedBuffers objectForKey:data] != nil;
+    }
+}
+
+-(void)recycleBuffer:(NSData *)data
+{
+    NSNumber *length = nil;
+    @synchronized(self.vendedBuffers)
+    {
+        length = [self.vendedBuffers objectForKey:data];
+        [self.vendedBuffers removeObjectForKey:data];
+    }
+    
+    if (length)
+    {
+        // The pool hands out buffers by length, so restore the length the buffer was allocated with.
+        NSMutableData *buffer = (NSMutableData *)data;
+        [buffer setLength:length.unsignedIntegerValue];
+        [[AZSBlockBufferPool sharedPool] returnBuffer:buffer];
+    }
+}
+
+-(void)relinquishBuffer:(NSData *)data
+{
+    @synchronized(self.vendedBuffers)
+    {
+        [self.vendedBuffers removeObjectForKey:data];
+    }
+}
+
+-(NSData *)transformData:(NSData *)data mutable:(BOOL)mutable final:(BOOL)final error:(NSError **)error
+{
+    NSData *current = data;
+    BOOL currentMutable = mutable;
+    for (NSUInteger i = 0; i < self.stages.count; i++)
+    {
+        id<AZSTransformStage> stage = self.stages[i];
+        AZSTransformStageStatistics *statistics = self.statistics[i];
+        
+        if (!currentMutable && [stage respondsToSelector:@selector(transformsInPlace)] && stage.transformsInPlace)
+        {
+            NSMutableData *copy = [self outputBufferWithLength:current.length];
+            memcpy(copy.mutableBytes, current.bytes, current.length);
+            current = copy;
+            currentMutable = YES;
+        }
+        
+        NSError *stageError = nil;
+        NSUInteger bytesIn = current.length;
+        uint64_t startTime = mach_absolute_time();
+        NSTimeInterval startCPUTime = AZSThreadCPUTime();
+        NSData *output = [stage transformData:current final:final chain:self error:&stageError];
+        NSTimeInterval cpuTime = AZSThreadCPUTime() - startCPUTime;
+        NSTimeInterval elapsedTime = AZSSecondsFromMachTime(mach_absolute_time() - startTime);
+        
+        @synchronized(statistics)
+        {
+            statistics.sliceCount++;
+            statistics.bytesIn += bytesIn;
+            statistics.bytesOut += output.length;
+            statistics.elapsedTime += elapsedTime;
+            statistics.cpuTime += cpuTime;
+        }
+        
+        if (!output)
+        {
+            [self recycleBuffer:current];
+            if (error)
+            {
+                NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:[NSString stringWithFormat:@"Transform stage %lu failed.", (unsigned long)i] forKey:NSLocalizedDescriptionKey];
+                if (stageError)
+                {
+                    userInfo[AZSInnerErrorString] = stageError;
+                }
+                *error = [NSError errorWithDomain:AZSErrorDomain code:AZSETransformError userInfo:userInfo];
+            }
+            return nil;
+        }
+        
+        if (output != current)
+        {
+            [self recycleBuffer:current];
+            currentMutable = [self isVendedBuffer:output];
+        }
+        current = output;
+    }
+    
+    return current;
+}
+
+@end
@@ -0,0 +1,132 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSULLRangeSet.h" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <Foundation/Foundation.h>
+#import "AZSMacros.h"
+#import "AZSULLRange.h"
+
+AZS_ASSUME_NONNULL_BEGIN
+
+/** An AZSULLRangeSet is a sorted set of non-overlapping byte ranges.
+ 
+ The ranges are stored in a single contiguous array of AZSULLRange structs, kept sorted by location, with overlapping and adjacent
+ ranges merged.  Lookups are binary searches, and ranges appended in order (as the service returns page ranges) are added in
+ constant time, so the set stays cheap to build and query for blobs with hundreds of thousands of page ranges.
+ 
+ An AZSULLRangeSet is mutable, and is not thread-safe.
+ */
+@interface AZSULLRangeSet : NSObject <NSCopying>
+
+/** The number of ranges in the set.*/
+@property (readonly) NSUInteger count;
+
+/** The total length of all ranges in the set.*/
+@property (readonly) unsigned long long totalLength;
+
+/** The ranges in the set, sorted by location.  The pointer is only valid until the set is next modified.*/
+@property (readonly) const AZSULLRange *ranges;
+
+/** The ranges in the set, as an array of NSValue objects each containing an AZSULLRange.*/
+@property (strong, readonly) NSArray *rangeValues;
+
+/** Initializes a newly allocated, empty AZSULLRangeSet object.
+ 
+ @returns The freshly allocated object.
+ */
+-(instancetype)init AZS_DESIGNATED_INITIALIZER;
+
+/** Initializes a newly allocated AZSULLRangeSet object containing the given ranges.
+ 
+ @param ranges The ranges, in any order.  They may overlap.
+ @param count The number of ranges.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithRanges:(const AZSULLRange *)ranges count:(NSUInteger)count;
+
+/** Initializes a newly allocated AZSULLRangeSet object containing the given ranges.
+ 
+ @param rangeValues An array of NSValue objects, each containing an AZSULLRange.
+ @returns The freshly allocated object.
+ */
+-(instancetype)initWithRangeValues:(NSArray *)rangeValues;
+
+/** Returns the range at the given index.
+ 
+ @param index The index of the range.  Must be less than count.
+ @returns The range.
+ */
+-(AZSULLRange)rangeAtIndex:(NSUInteger)index;
+
+/** Returns the index of the first range that ends after the given location.
+ 
+ @param location The location.
+ @returns The index of the range containing the location, or of the first range after it.  Returns count if there is no such range.
+ */
+-(NSUInteger)indexOfRangeEndingAfterLocation:(unsigned long long)location;
+
+/** Adds a range to the set, merging it with any ranges it overlaps or touches.  Empty ranges are ignored.
+ 
+ @param range The range to add.
+ */
+-(void)addRange:(AZSULLRange)range;
+
+/** Removes a range from the set, trimming or splitting any ranges it overlaps.
+ 
+ @param range The range to remove.
+ */
+-(void)removeRange:(AZSULLRange)range;
+
+/** Removes all ranges from the set.*/
+-(void)removeAllRanges;
+
+/** Adds every range in another set to this set.
+ 
+ @param rangeSet The ranges to add.
+ */
+-(void)unionRangeSet:(AZSULLRangeSet *)rangeSet;
+
+/** Removes every range in another set from this set.
+ 
+ @param rangeSet The ranges to remove.
+ */
+-(void)subtractRangeSet:(AZSULLRangeSet *)rangeSet;
+
+/** Removes everything from this set that is not also in another set.
+ 
+ @param rangeSet The ranges to keep.
+ */
+-(void)intersectRangeSet:(AZSULLRangeSet *)rangeSet;
+
+/** Returns a new set containing the parts of this set that lie within a range.
+ 
+ @param range The range.
+ @returns The parts of this set within the range.
+ */
+-(AZSULLRangeSet *)rangeSetByIntersectingRange:(AZSULLRange)range;
+
+/** Returns YES if the location lies within one of the ranges in the set.*/
+-(BOOL)containsLocation:(unsigned long long)location;
+
+/** Returns YES if the whole of a non-empty range lies within the set.*/
+-(BOOL)containsRange:(AZSULLRange)range;
+
+/** Returns YES if any part of the range lies within the set.*/
+-(BOOL)intersectsRange:(AZSULLRange)range;
+
+@end
+
+AZS_ASSUME_NONNULL_END
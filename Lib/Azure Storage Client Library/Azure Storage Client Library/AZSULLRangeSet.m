@@ -0,0 +1,472 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSULLRangeSet.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import "AZSULLRangeSet.h"
+
+// Returns the index of the first range that ends after the location, or (if touching is YES) at or after it.
+static NSUInteger AZSULLRangeSetSearch(const AZSULLRange *ranges, NSUInteger count, uint64_t location, BOOL touching)
+{
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    while (low < high)
+    {
+        NSUInteger middle = low + (high - low) / 2;
+        uint64_t end = AZSULLMaxRange(ranges[middle]);
+        if ((end < location) || (!touching && end == location))
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+static int AZSULLRangeCompareLocations(const void *first, const void *second)
+{
+    uint64_t firstLocation = ((const AZSULLRange *)first)->location;
+    uint64_t secondLocation = ((const AZSULLRange *)second)->location;
+    return (firstLocation < secondLocation) ? -1 : ((firstLocation > secondLocation) ? 1 : 0);
+}
+
+@interface AZSULLRangeSet()
+{
+    AZSULLRange *_ranges;
+    NSUInteger _capacity;
+}
+
+@end
+
+@implementation AZSULLRangeSet
+
+-(instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        _ranges = NULL;
+        _count = 0;
+        _capacity = 0;
+        _totalLength = 0;
+    }
+
+    return self;
+}
+
+-(instancetype)initWithRanges:(const AZSULLRange *)ranges count:(NSUInteger)count
+{
+    self = [self init];
+    if (self && count > 0)
+    {
+        [self ensureCapacity:count];
+        memcpy(_ranges, ranges, count * sizeof(AZSULLRange));
+        qsort(_ranges, count, sizeof(AZSULLRange), AZSULLRangeCompareLocations);
+
+        // Coalesce in place, dropping empty ranges.
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            if (_ranges[i].length == 0)
+            {
+                continue;
+            }
+
+            if (_count > 0 && _ranges[i].location <= AZSULLMaxRange(_ranges[_count - 1]))
+            {
+                AZSULLRange *last = &_ranges[_count - 1];
+                last->length = MAX(AZSULLMaxRange(*last), AZSULLMaxRange(_ranges[i])) - last->location;
+            }
+            else
+            {
+                _ranges[_count++] = _ranges[i];
+            }
+        }
+
+        for (NSUInteger i = 0; i < _count; i++)
+        {
+            _totalLength += _ranges[i].length;
+        }
+    }
+
+    return self;
+}
+
+-(instancetype)initWithRangeValues:(NSArray *)rangeValues
+{
+    AZSULLRange *ranges = malloc(MAX(rangeValues.count, 1) * sizeof(AZSULLRange));
+    for (NSUInteger i = 0; i < rangeValues.count; i++)
+    {
+        ranges[i] = ((NSValue *)rangeValues[i]).AZSULLRangeValue;
+    }
+
+    self = [self initWithRanges:ranges count:rangeValues.count];
+    free(ranges);
+    return self;
+}
+
+-(void)dealloc
+{
+    free(_ranges);
+}
+
+-(id)copyWithZone:(NSZone *)zone
+{
+    AZSULLRangeSet *copy = [[AZSULLRangeSet allocWithZone:zone] init];
+    [copy replaceRangesWithRanges:_ranges count:_count totalLength:_totalLength];
+    return copy;
+}
+
+-(BOOL)isEqual:(id)object
+{
+    if (![object isKindOfClass:[AZSULLRangeSet class]])
+    {
+        return NO;
+    }
+
+    AZSULLRangeSet *other = object;
+    return (other.count == _count) && ((_count == 0) || (memcmp(other.ranges, _ranges, _count * sizeof(AZSULLRange)) == 0));
+}
+
+-(NSUInteger)hash
+{
+    return (NSUInteger)(_count ^ _totalLength);
+}
+
+-(NSString *)description
+{
+    NSMutableString *description = [NSMutableString stringWithFormat:@"<%@: %p> (", NSStringFromClass([self class]), self];
+    for (NSUInteger i = 0; i < _count; i++)
+    {
+        [description appendFormat:(i == 0) ? @"%@" : @", %@", NSStringFromAZSULLRange(_ranges[i])];
+    }
+    [description appendString:@")"];
+    return description;
+}
+
+-(const AZSULLRange *)ranges
+{
+    return _ranges;
+}
+
+-(NSArray *)rangeValues
+{
+    NSMutableArray *rangeValues = [NSMutableArray arrayWithCapacity:_count];
+    for (NSUInteger i = 0; i < _count; i++)
+    {
+        [rangeValues addObject:[NSValue valueWithAZSULLRange:_ranges[i]]];
+    }
+
+    return rangeValues;
+}
+
+-(AZSULLRange)rangeAtIndex:(NSUInteger)index
+{
+    if (index >= _count)
+    {
+        [NSException raise:NSRangeException format:@"Index %lu beyond bounds of range set with %lu ranges.", (unsigned long)index, (unsigned long)_count];
+    }
+
+    return _ranges[index];
+}
+
+-(NSUInteger)indexOfRangeEndingAfterLocation:(unsigned long long)location
+{
+    return AZSULLRangeSetSearch(_ranges, _count, location, NO);
+}
+
+-(void)ensureCapacity:(NSUInteger)capacity
+{
+    if (capacity <= _capacity)
+    {
+        return;
+    }
+
+    _capacity = MAX(capacity, MAX(_capacity * 2, 16));
+    _ranges = reallocf(_ranges, _capacity * sizeof(AZSULLRange));
+    if (!_ranges)
+    {
+        [NSException raise:NSMallocException format:@"Could not grow range set to %lu ranges.", (unsigned long)_capacity];
+    }
+}
+
+// Replaces the ranges at the given indexes with the given (sorted, disjoint) ranges.
+-(void)replaceRangesInRange:(NSRange)indexes withRanges:(const AZSULLRange *)ranges count:(NSUInteger)count
+{
+    for (NSUInteger i = indexes.location; i < NSMaxRange(indexes); i++)
+    {
+        _totalLength -= _ranges[i].length;
+    }
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        _totalLength += ranges[i].length;
+    }
+
+    [self ensureCapacity:_count - indexes.length + count];
+    if (count != indexes.length)
+    {
+        memmove(_ranges + indexes.location + count, _ranges + NSMaxRange(indexes), (_count - NSMaxRange(indexes)) * sizeof(AZSULLRange));
+    }
+    if (count > 0)
+    {
+        memcpy(_ranges + indexes.location, ranges, count * sizeof(AZSULLRange));
+    }
+    _count = _count - indexes.length + count;
+}
+
+// Replaces the whole contents of the set with the given (sorted, coalesced) ranges.
+-(void)replaceRangesWithRanges:(const AZSULLRange *)ranges count:(NSUInteger)count totalLength:(unsigned long long)totalLength
+{
+    [self ensureCapacity:count];
+    if (count > 0)
+    {
+        memmove(_ranges, ranges, count * sizeof(AZSULLRange));
+    }
+    _count = count;
+    _totalLength = totalLength;
+}
+
+-(void)addRange:(AZSULLRange)range
+{
+    if (range.length == 0)
+    {
+        return;
+    }
+
+    // Ranges added in order only ever append to, or extend, the last range.
+    if (_count == 0 || range.location > AZSULLMaxRange(_ranges[_count - 1]))
+    {
+        [self ensureCapacity:_count + 1];
+        _ranges[_count++] = range;
+        _totalLength += range.length;
+        return;
+    }
+
+    NSUInteger first = AZSULLRangeSetSearch(_ranges, _count, range.location, YES);
+    NSUInteger last = first;
+    while (last < _count && _ranges[last].location <= AZSULLMaxRange(range))
+    {
+        last++;
+    }
+
+    AZSULLRange merged = range;
+    if (last > first)
+    {
+        merged = AZSULLUnionRange(AZSULLUnionRange(range, _ranges[first]), _ranges[last - 1]);
+    }
+    [self replaceRangesInRange:NSMakeRange(first, last - first) withRanges:&merged count:1];
+}
+
+-(void)removeRange:(AZSULLRange)range
+{
+    if (range.length == 0)
+    {
+        return;
+    }
+
+    NSUInteger first = AZSULLRangeSetSearch(_ranges, _count, range.location, NO);
+    NSUInteger last = first;
+    while (last < _count && _ranges[last].location < AZSULLMaxRange(range))
+    {
+        last++;
+    }
+    if (last == first)
+    {
+        return;
+    }
+
+    AZSULLRange remainders[2];
+    NSUInteger remainderCount = 0;
+    if (_ranges[first].location < range.location)
+    {
+        remainders[remainderCount++] = AZSULLMakeRange(_ranges[first].location, range.location - _ranges[first].location);
+    }
+    if (AZSULLMaxRange(_ranges[last - 1]) > AZSULLMaxRange(range))
+    {
+        remainders[remainderCount++] = AZSULLMakeRange(AZSULLMaxRange(range), AZSULLMaxRange(_ranges[last - 1]) - AZSULLMaxRange(range));
+    }
+    [self replaceRangesInRange:NSMakeRange(first, last - first) withRanges:remainders count:remainderCount];
+}
+
+-(void)removeAllRanges
+{
+    _count = 0;
+    _totalLength = 0;
+}
+
+-(void)unionRangeSet:(AZSULLRangeSet *)rangeSet
+{
+    const AZSULLRange *other = rangeSet.ranges;
+    NSUInteger otherCount = rangeSet.count;
+    if (otherCount == 0)
+    {
+        return;
+    }
+
+    // Merge the two sorted arrays, coalescing as we go.
+    AZSULLRange *merged = malloc((_count + otherCount) * sizeof(AZSULLRange));
+    NSUInteger mergedCount = 0;
+    unsigned long long mergedLength = 0;
+    NSUInteger i = 0;
+    NSUInteger j = 0;
+    while (i < _count || j < otherCount)
+    {
+        AZSULLRange next = ((j == otherCount) || ((i < _count) && (_ranges[i].location <= other[j].location))) ? _ranges[i++] : other[j++];
+        if (mergedCount > 0 && next.location <= AZSULLMaxRange(merged[mergedCount - 1]))
+        {
+            AZSULLRange *previous = &merged[mergedCount - 1];
+            uint64_t end = MAX(AZSULLMaxRange(*previous), AZSULLMaxRange(next));
+            mergedLength += end - AZSULLMaxRange(*previous);
+            previous->length = end - previous->location;
+        }
+        else
+        {
+            merged[mergedCount++] = next;
+            mergedLength += next.length;
+        }
+    }
+
+    [self replaceRangesWithRanges:merged count:mergedCount totalLength:mergedLength];
+    free(merged);
+}
+
+-(void)subtractRangeSet:(AZSULLRangeSet *)rangeSet
+{
+    const AZSULLRange *other = rangeSet.ranges;
+    NSUInteger otherCount = rangeSet.count;
+    if (otherCount == 0 || _count == 0)
+    {
+        return;
+    }
+
+    // Each removed range can split at most one range in two.
+    AZSULLRange *result = malloc((_count + otherCount) * sizeof(AZSULLRange));
+    NSUInteger resultCount = 0;
+    unsigned long long resultLength = 0;
+    NSUInteger j = 0;
+    for (NSUInteger i = 0; i < _count; i++)
+    {
+        uint64_t location = _ranges[i].location;
+        uint64_t end = AZSULLMaxRange(_ranges[i]);
+        while (j < otherCount && AZSULLMaxRange(other[j]) <= location)
+        {
+            j++;
+        }
+
+        NSUInteger k = j;
+        while (location < end && k < otherCount && other[k].location < end)
+        {
+            if (other[k].location > location)
+            {
+                result[resultCount++] = AZSULLMakeRange(location, other[k].location - location);
+                resultLength += other[k].location - location;
+            }
+            location = MAX(location, AZSULLMaxRange(other[k]));
+            k++;
+        }
+
+        if (location < end)
+        {
+            result[resultCount++] = AZSULLMakeRange(location, end - location);
+            resultLength += end - location;
+        }
+    }
+
+    [self replaceRangesWithRanges:result count:resultCount totalLength:resultLength];
+    free(result);
+}
+
+-(void)intersectRangeSet:(AZSULLRangeSet *)rangeSet
+{
+    const AZSULLRange *other = rangeSet.ranges;
+    NSUInteger otherCount = rangeSet.count;
+
+    AZSULLRange *result = malloc(MAX(_count + otherCount, 1) * sizeof(AZSULLRange));
+    NSUInteger resultCount = 0;
+    unsigned long long resultLength = 0;
+    NSUInteger i = 0;
+    NSUInteger j = 0;
+    while (i < _count && j < otherCount)
+    {
+        AZSULLRange overlap = AZSULLIntersectionRange(_ranges[i], other[j]);
+        if (overlap.length > 0)
+        {
+            result[resultCount++] = overlap;
+            resultLength += overlap.length;
+        }
+
+        if (AZSULLMaxRange(_ranges[i]) <= AZSULLMaxRange(other[j]))
+        {
+            i++;
+        }
+        else
+        {
+            j++;
+        }
+    }
+
+    [self replaceRangesWithRanges:result count:resultCount totalLength:resultLength];
+    free(result);
+}
+
+-(AZSULLRangeSet *)rangeSetByIntersectingRange:(AZSULLRange)range
+{
+    AZSULLRangeSet *result = [[AZSULLRangeSet alloc] init];
+    if (range.length == 0)
+    {
+        return result;
+    }
+
+    for (NSUInteger i = AZSULLRangeSetSearch(_ranges, _count, range.location, NO); (i < _count) && (_ranges[i].location < AZSULLMaxRange(range)); i++)
+    {
+        [result addRange:AZSULLIntersectionRange(range, _ranges[i])];
+    }
+
+    return result;
+}
+
+-(BOOL)containsLocation:(unsigned long long)location
+{
+    NSUInteger i = AZSULLRangeSetSearch(_ranges, _count, location, NO);
+    return (i < _count) && (_ranges[i].location <= location);
+}
+
+-(BOOL)containsRange:(AZSULLRange)range
+{
+    if (range.length == 0)
+    {
+        return NO;
+    }
+
+    // Touching ranges are always merged, so a contained range lies within a single range of the set.
+    NSUInteger i = AZSULLRangeSetSearch(_ranges, _count, range.location, NO);
+    return (i < _count) && (_ranges[i].location <= range.location) && (AZSULLMaxRange(_ranges[i]) >= AZSULLMaxRange(range));
+}
+
+-(BOOL)intersectsRange:(AZSULLRange)range
+{
+    if (range.length == 0)
+    {
+        return NO;
+    }
+
+    NSUInteger i = AZSULLRangeSetSearch(_ranges, _count, range.location, NO);
+    return (i < _count) && (_ranges[i].location < AZSULLMaxRange(range));
+}
+
+@end
@@ -48,5 +48,6 @@
 +(AZSOperationContext *) operationlessContext;
 
 +(NSString *)calculateMD5FromData:(NSData *)data;
++(NSString *)calculateSHA256FromData:(NSData *)data;
 
 @end
\ No newline at end of file
@@ -244,4 +244,11 @@
     return [[[NSData alloc] initWithBytes:md5Bytes length:CC_MD5_DIGEST_LENGTH] base64EncodedStringWithOptions:0];
 }
 
++(NSString *)calculateSHA256FromData:(NSData *)data
+{
+    unsigned char sha256Bytes[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG) data.length, sha256Bytes);
+    return [[[NSData alloc] initWithBytes:sha256Bytes length:CC_SHA256_DIGEST_LENGTH] base64EncodedStringWithOptions:0];
+}
+
 @end
\ No newline at end of file
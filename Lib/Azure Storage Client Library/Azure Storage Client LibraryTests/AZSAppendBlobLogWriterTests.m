@@ -0,0 +1,117 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSAppendBlobLogWriterTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSBlobTestBase.h"
+#import "AZSClient.h"
+#import "AZSAppendBlobLogWriter.h"
+#import "AZSConstants.h"
+#import "AZSTestHelpers.h"
+#import "AZSTestSemaphore.h"
+
+@interface AZSAppendBlobLogWriterTests : AZSBlobTestBase
+@property NSString *containerName;
+@property AZSCloudBlobContainer *blobContainer;
+@end
+
+@implementation AZSAppendBlobLogWriterTests
+
+- (void)setUp
+{
+    [super setUp];
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    self.containerName = [NSString stringWithFormat:@"sampleioscontainer%@", [AZSTestHelpers uniqueName]];
+
+    self.blobContainer = [self.blobClient containerReferenceFromName:self.containerName];
+    [self.blobContainer createContainerIfNotExistsWithCompletionHandler:^(NSError *error, BOOL exists) {
+        XCTAssertNil(error, @"Error in test setup, in creating container.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        [semaphore signal];
+    }];
+    [semaphore wait];
+}
+
+- (void)tearDown
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+
+    AZSCloudBlobContainer *blobContainer = [self.blobClient containerReferenceFromName:self.containerName];
+    [blobContainer deleteContainerIfExistsWithCompletionHandler:^(NSError * error, BOOL exists) {
+        [semaphore signal];
+    }];
+    [semaphore wait];
+    [super tearDown];
+}
+
+-(void)testLogRecordsAreBatchedAndRolledOver
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobNamePrefix = [NSString stringWithFormat:@"samplelog%@-", [AZSTestHelpers uniqueName]];
+    NSUInteger recordTotal = 200;
+    
+    // 200 records of 11 bytes don't fit in two 1 KB blobs, so the writer must roll over at least twice.
+    AZSAppendBlobLogWriter *writer = [[AZSAppendBlobLogWriter alloc] initWithContainer:self.blobContainer blobNamePrefix:blobNamePrefix maximumBlobSize:1024 requestOptions:nil operationContext:nil];
+    writer.maximumLatency = 60;
+    
+    NSError *appendError = nil;
+    XCTAssertFalse([writer appendRecord:[NSData dataWithBytes:"a" length:1] error:&appendError], @"Record was accepted before the writer was opened.");
+    XCTAssertEqual(AZSEInvalidArgument, appendError.code, @"Incorrect error code.");
+    
+    [writer openWithCompletionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in opening writer.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        // Append from several threads at once.
+        dispatch_apply(recordTotal, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+            NSError *appendError = nil;
+            NSData *record = [[NSString stringWithFormat:@"record-%03lu\n", (unsigned long)i] dataUsingEncoding:NSUTF8StringEncoding];
+            XCTAssertTrue([writer appendRecord:record error:&appendError], @"Append failed.  Error = %@", appendError);
+        });
+        
+        [writer flushWithCompletionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in flushing writer.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(recordTotal, writer.recordCount, @"Incorrect record count.");
+            XCTAssertEqual(recordTotal * 11, writer.bytesAppended, @"Incorrect bytes appended.");
+            XCTAssertEqual(0, writer.pendingBytes, @"Queue was not emptied.");
+            XCTAssertTrue(writer.rolloverCount >= 2, @"Writer did not roll over.");
+            XCTAssertTrue(writer.appendCount < recordTotal / 10, @"Records were not batched.");
+            XCTAssertTrue([writer flushLatencyAtPercentile:50] <= [writer flushLatencyAtPercentile:99], @"Latency percentiles are out of order.");
+            [semaphore signal];
+        }];
+    }];
+    [semaphore wait];
+    
+    NSMutableSet *records = [NSMutableSet set];
+    for (NSUInteger i = 0; i <= writer.rolloverCount; i++)
+    {
+        AZSCloudAppendBlob *blob = [self.blobContainer appendBlobReferenceFromName:[NSString stringWithFormat:@"%@%06lu", blobNamePrefix, (unsigned long)i]];
+        [blob downloadToTextWithCompletionHandler:^(NSError *error, NSString *text) {
+            XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertTrue(text.length <= 1024, @"Blob grew past the maximum size.");
+            for (NSString *record in [text componentsSeparatedByString:@"\n"])
+            {
+                if (record.length > 0)
+                {
+                    [records addObject:record];
+                }
+            }
+            [semaphore signal];
+        }];
+        [semaphore wait];
+    }
+    XCTAssertEqual(recordTotal, records.count, @"Records were lost or duplicated.");
+}
+
+@end
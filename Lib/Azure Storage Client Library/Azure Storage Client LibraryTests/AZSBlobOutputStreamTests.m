@@ -440,4 +440,54 @@
     XCTAssertEqual(0, failures, @"%d failure(s) detected.", failures);
 }
 
+-(void)testBlockBlobOutputStreamNonBlockingWritesAndAsyncClose
+{
+    unsigned int seed = (unsigned int)time(NULL);
+    NSUInteger blobSize = 12 * 1024 * 1024;
+    NSData *sourceData = [AZSTestHelpers generateSampleDataWithSeed:&seed length:(unsigned int)blobSize];
+    AZSCloudBlockBlob *blob = [self.blobContainer blockBlobReferenceFromName:@"blobName"];
+    
+    // Small blocks and a single upload slot make the writer outrun the uploads.
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.blockSize = 1024 * 1024;
+    options.parallelismFactor = 1;
+    
+    AZSBlobOutputStream *blobOutputStream = [blob createOutputStreamWithAccessCondition:nil requestOptions:options operationContext:nil];
+    blobOutputStream.nonBlockingWrites = YES;
+    [blobOutputStream open];
+    
+    NSUInteger bytesWritten = 0;
+    NSUInteger wouldBlockCount = 0;
+    while (bytesWritten < blobSize)
+    {
+        NSInteger written = [blobOutputStream write:((const uint8_t *)sourceData.bytes) + bytesWritten maxLength:MIN(256 * 1024, blobSize - bytesWritten)];
+        XCTAssertTrue(written >= 0, @"Write failed.  Error = %@", blobOutputStream.streamError);
+        if (written < 0)
+        {
+            return;
+        }
+        
+        if (written == 0)
+        {
+            wouldBlockCount++;
+            [NSThread sleepForTimeInterval:0.01];
+        }
+        bytesWritten += written;
+    }
+    XCTAssertTrue(wouldBlockCount > 0, @"Writes never reported that they would block.");
+    
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    [blobOutputStream closeWithCompletionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in closing the output stream.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        XCTAssertEqual(NSStreamStatusClosed, blobOutputStream.streamStatus, @"Stream was not closed.");
+        
+        [blob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+            XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertTrue([sourceData isEqualToData:data], @"Downloaded data does not match the data written.");
+            [semaphore signal];
+        }];
+    }];
+    [semaphore wait];
+}
+
 @end
\ No newline at end of file
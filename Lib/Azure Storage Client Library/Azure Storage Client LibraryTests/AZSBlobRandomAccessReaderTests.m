@@ -0,0 +1,173 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlobRandomAccessReaderTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSBlobTestBase.h"
+#import "AZSClient.h"
+#import "AZSBlobRandomAccessReader.h"
+#import "AZSConstants.h"
+#import "AZSTestHelpers.h"
+#import "AZSTestSemaphore.h"
+
+@interface AZSBlobRandomAccessReaderTests : AZSBlobTestBase
+@property NSString *containerName;
+@property AZSCloudBlobContainer *blobContainer;
+@end
+
+@implementation AZSBlobRandomAccessReaderTests
+
+- (void)setUp
+{
+    [super setUp];
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    self.containerName = [NSString stringWithFormat:@"sampleioscontainer%@", [AZSTestHelpers uniqueName]];
+
+    self.blobContainer = [self.blobClient containerReferenceFromName:self.containerName];
+    [self.blobContainer createContainerIfNotExistsWithCompletionHandler:^(NSError *error, BOOL exists) {
+        XCTAssertNil(error, @"Error in test setup, in creating container.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        [semaphore signal];
+    }];
+    [semaphore wait];
+}
+
+- (void)tearDown
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+
+    AZSCloudBlobContainer *blobContainer = [self.blobClient containerReferenceFromName:self.containerName];
+    [blobContainer deleteContainerIfExistsWithCompletionHandler:^(NSError * error, BOOL exists) {
+        [semaphore signal];
+    }];
+    [semaphore wait];
+    [super tearDown];
+}
+
+-(void)testRandomAccessReads
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:10000];
+
+    [blockBlob uploadFromData:blobData completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+
+        AZSBlobRandomAccessReader *reader = [[AZSBlobRandomAccessReader alloc] initWithBlob:blockBlob blockSize:1024 maximumCachedBlocks:4 requestOptions:nil operationContext:nil];
+        reader.readAheadBlockCount = 0;
+        [reader openWithCompletionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in opening reader.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(blobData.length, reader.blobLength, @"Incorrect blob length.");
+
+            // Spans blocks 3 to 5.
+            [reader readFromOffset:4000 length:2000 completionHandler:^(NSError *error, NSData *data) {
+                XCTAssertNil(error, @"Error in reading.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                XCTAssertTrue([data isEqualToData:[blobData subdataWithRange:NSMakeRange(4000, 2000)]], @"Data does not match.");
+                XCTAssertEqual(0, reader.cacheHits, @"Incorrect cache hit count.");
+                XCTAssertEqual(3, reader.cacheMisses, @"Incorrect cache miss count.");
+                XCTAssertEqual(3072, reader.bytesFetched, @"Incorrect bytes fetched.");
+
+                // Starts in the cached block 5 and runs past the end of the blob.
+                [reader readFromOffset:5500 length:100000 completionHandler:^(NSError *error, NSData *data) {
+                    XCTAssertNil(error, @"Error in reading.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    XCTAssertTrue([data isEqualToData:[blobData subdataWithRange:NSMakeRange(5500, blobData.length - 5500)]], @"Data does not match.");
+                    XCTAssertEqual(1, reader.cacheHits, @"Incorrect cache hit count.");
+                    XCTAssertEqual(3072 + (blobData.length - 6144), reader.bytesFetched, @"Incorrect bytes fetched.");
+
+                    // Modify the blob; reads that miss the cache must now fail, since the reader is pinned to the old ETag.
+                    [blockBlob uploadFromText:@"changed" completionHandler:^(NSError *error) {
+                        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                        [reader readFromOffset:0 length:10 completionHandler:^(NSError *error, NSData *data) {
+                            XCTAssertNotNil(error, @"Read of a modified blob did not fail.");
+                            XCTAssertEqual(412, ((NSNumber *)error.userInfo[AZSCHttpStatusCode]).integerValue, @"Incorrect HTTP status code.");
+                            [semaphore signal];
+                        }];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testPageBlobReadsSkipClearPages
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudPageBlob *pageBlob = [self.blobContainer pageBlobReferenceFromName:blobName];
+
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *firstPages = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:512];
+    NSData *secondPages = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:512];
+    NSData *newPages = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:512];
+
+    // Only pages at 1024 and 5120 are populated; the rest of the blob is clear.
+    NSMutableData *expectedData = [NSMutableData dataWithLength:8192];
+    [expectedData replaceBytesInRange:NSMakeRange(1024, 512) withBytes:firstPages.bytes];
+    [expectedData replaceBytesInRange:NSMakeRange(5120, 512) withBytes:secondPages.bytes];
+
+    [pageBlob createWithSize:[NSNumber numberWithInt:8192] completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in creating blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        [pageBlob uploadPagesWithData:firstPages startOffset:[NSNumber numberWithInt:1024] contentMD5:nil completionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in uploading pages.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            [pageBlob uploadPagesWithData:secondPages startOffset:[NSNumber numberWithInt:5120] contentMD5:nil completionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in uploading pages.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+
+                AZSBlobRandomAccessReader *reader = [[AZSBlobRandomAccessReader alloc] initWithBlob:pageBlob blockSize:1024 maximumCachedBlocks:16 requestOptions:nil operationContext:nil];
+                reader.readAheadBlockCount = 0;
+                reader.refreshesWhenBlobChanges = YES;
+                [reader openWithCompletionHandler:^(NSError *error) {
+                    XCTAssertNil(error, @"Error in opening reader.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    XCTAssertNotNil(reader.sequenceNumber, @"Sequence number not recorded for a page blob.");
+
+                    [reader readFromOffset:0 length:8192 completionHandler:^(NSError *error, NSData *data) {
+                        XCTAssertNil(error, @"Error in reading.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                        XCTAssertTrue([data isEqualToData:expectedData], @"Data does not match.");
+                        XCTAssertEqual(1024, reader.bytesFetched, @"Clear pages were downloaded.");
+                        XCTAssertEqual(8192 - 1024, reader.bytesSkipped, @"Incorrect bytes skipped.");
+
+                        // Populate a clear page.  Block 0 is still zero-filled locally from the old page ranges, but the read also
+                        // downloads block 1, which fails against the old ETag; the retry must re-plan both blocks against the new version.
+                        [pageBlob uploadPagesWithData:newPages startOffset:[NSNumber numberWithInt:0] contentMD5:nil completionHandler:^(NSError *error) {
+                            XCTAssertNil(error, @"Error in uploading pages.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                            NSString *oldETag = reader.eTag;
+                            [reader invalidateCache];
+                            [reader readFromOffset:0 length:2048 completionHandler:^(NSError *error, NSData *data) {
+                                XCTAssertNil(error, @"Error in reading after the blob changed.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                                NSMutableData *expectedNewData = [NSMutableData dataWithLength:2048];
+                                [expectedNewData replaceBytesInRange:NSMakeRange(0, 512) withBytes:newPages.bytes];
+                                [expectedNewData replaceBytesInRange:NSMakeRange(1024, 512) withBytes:firstPages.bytes];
+                                XCTAssertTrue([data isEqualToData:expectedNewData], @"Data does not reflect the new version of the blob.");
+                                XCTAssertNotEqualObjects(oldETag, reader.eTag, @"Reader was not re-pinned to the new version.");
+
+                                [reader refreshWithCompletionHandler:^(NSError *error, BOOL changed) {
+                                    XCTAssertNil(error, @"Error in refreshing.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                                    XCTAssertFalse(changed, @"Refresh of an unchanged blob reported a change.");
+                                    [semaphore signal];
+                                }];
+                            }];
+                        }];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+@end
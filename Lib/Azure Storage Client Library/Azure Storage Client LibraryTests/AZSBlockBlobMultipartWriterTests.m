@@ -0,0 +1,153 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlockBlobMultipartWriterTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSBlobTestBase.h"
+#import "AZSClient.h"
+#import "AZSBlockBlobMultipartWriter.h"
+#import "AZSConstants.h"
+#import "AZSCRC64.h"
+#import "AZSTestHelpers.h"
+#import "AZSTestSemaphore.h"
+
+@interface AZSBlockBlobMultipartWriterTests : AZSBlobTestBase
+@property NSString *containerName;
+@property AZSCloudBlobContainer *blobContainer;
+@end
+
+@implementation AZSBlockBlobMultipartWriterTests
+
+- (void)setUp
+{
+    [super setUp];
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    self.containerName = [NSString stringWithFormat:@"sampleioscontainer%@", [AZSTestHelpers uniqueName]];
+
+    self.blobContainer = [self.blobClient containerReferenceFromName:self.containerName];
+    [self.blobContainer createContainerIfNotExistsWithCompletionHandler:^(NSError *error, BOOL exists) {
+        XCTAssertNil(error, @"Error in test setup, in creating container.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        [semaphore signal];
+    }];
+    [semaphore wait];
+}
+
+- (void)tearDown
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+
+    AZSCloudBlobContainer *blobContainer = [self.blobClient containerReferenceFromName:self.containerName];
+    [blobContainer deleteContainerIfExistsWithCompletionHandler:^(NSError * error, BOOL exists) {
+        [semaphore signal];
+    }];
+    [semaphore wait];
+    [super tearDown];
+}
+
+-(void)testPartsCommitInPartOrder
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:AZSCBlob];
+
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.blockSize = 64 * 1024;
+    options.useContentCRC64 = YES;
+    AZSBlockBlobMultipartWriter *writer = [[AZSBlockBlobMultipartWriter alloc] initWithBlob:blockBlob accessCondition:nil requestOptions:options operationContext:nil];
+
+    // Each part gets a different, non-block-aligned size, so the last block of every part is partial.
+    NSUInteger partCount = 4;
+    NSMutableArray *partData = [NSMutableArray arrayWithCapacity:partCount];
+    for (NSUInteger i = 0; i < partCount; i++)
+    {
+        NSUInteger length = 150 * 1024 + i * 7000;
+        NSMutableData *data = [NSMutableData dataWithLength:length];
+        for (NSUInteger j = 0; j < length; j++)
+        {
+            ((uint8_t *)data.mutableBytes)[j] = (uint8_t)(i * 31 + j);
+        }
+        [partData addObject:data];
+    }
+
+    // Write the parts concurrently, creating them in reverse order.
+    dispatch_group_t closeGroup = dispatch_group_create();
+    dispatch_apply(partCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        NSUInteger partIndex = partCount - 1 - iteration;
+        AZSBlockBlobPartWriter *partWriter = [writer partWriterAtIndex:partIndex];
+        NSData *data = partData[partIndex];
+
+        NSUInteger chunkSize = 10 * 1024;
+        for (NSUInteger offset = 0; offset < data.length; offset += chunkSize)
+        {
+            NSError *error = nil;
+            XCTAssertTrue([partWriter writeData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkSize, data.length - offset))] error:&error], @"Error in writing a part.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        }
+
+        dispatch_group_enter(closeGroup);
+        [partWriter closeWithCompletionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in closing a part.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            dispatch_group_leave(closeGroup);
+        }];
+    });
+    dispatch_group_wait(closeGroup, DISPATCH_TIME_FOREVER);
+
+    XCTAssertEqual(partCount, writer.parts.count, @"Incorrect number of parts.");
+    XCTAssertTrue([writer partWriterAtIndex:2] == writer.parts[2], @"Requesting an existing part did not return it.");
+    for (NSUInteger i = 0; i < partCount; i++)
+    {
+        AZSBlockBlobPartWriter *partWriter = writer.parts[i];
+        XCTAssertEqual(i, partWriter.partIndex, @"Parts are not sorted by index.");
+        XCTAssertEqual(((NSData *)partData[i]).length, partWriter.bytesWritten, @"Incorrect bytes written for part.");
+        XCTAssertEqual(3, partWriter.blockCount, @"Incorrect block count for part.");
+    }
+
+    [writer commitWithCompletionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in committing the parts.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+
+        NSMutableData *expected = [NSMutableData data];
+        for (NSData *part in partData)
+        {
+            [expected appendData:part];
+        }
+        XCTAssertEqualObjects([AZSCRC64 stringFromCRC64:[AZSCRC64 crc64FromData:expected]], blockBlob.metadata[AZSCContentCRC64MetadataKey], @"Combined CRC64 incorrect.");
+
+        // Downloading with useContentCRC64 checks the data against the stored CRC64.
+        [blockBlob downloadToDataWithAccessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error, NSData *data) {
+            XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertTrue([expected isEqualToData:data], @"Blob contents are not the parts in part order.");
+            [semaphore signal];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testCommitFailsWithOpenPart
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:AZSCBlob];
+    AZSBlockBlobMultipartWriter *writer = [[AZSBlockBlobMultipartWriter alloc] initWithBlob:blockBlob accessCondition:nil requestOptions:nil operationContext:nil];
+
+    NSError *writeError = nil;
+    XCTAssertTrue([[writer partWriterAtIndex:0] writeData:[@"data" dataUsingEncoding:NSUTF8StringEncoding] error:&writeError], @"Error in writing a part.");
+
+    [writer commitWithCompletionHandler:^(NSError *error) {
+        XCTAssertNotNil(error, @"Commit succeeded with a part still open.");
+        XCTAssertEqual(AZSEInvalidArgument, error.code, @"Incorrect error code.");
+        [semaphore signal];
+    }];
+    [semaphore wait];
+}
+
+@end
@@ -0,0 +1,66 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSBlockBufferPoolTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSBlockBufferPool.h"
+
+@interface AZSBlockBufferPoolTests : XCTestCase
+
+@end
+
+@implementation AZSBlockBufferPoolTests
+
+-(void)testBuffersAreReused {
+    AZSBlockBufferPool *pool = [[AZSBlockBufferPool alloc] initWithMaximumPooledBytes:4096];
+
+    NSMutableData *buffer = [pool bufferWithLength:1024];
+    XCTAssertEqual(1024, buffer.length, @"Buffer length incorrect.");
+    [pool returnBuffer:buffer];
+    XCTAssertEqual(1024, pool.pooledBytes, @"Pooled bytes incorrect after return.");
+
+    XCTAssertEqual(buffer, [pool bufferWithLength:1024], @"Returned buffer was not reused.");
+    XCTAssertEqual(0, pool.pooledBytes, @"Pooled bytes incorrect after reuse.");
+
+    XCTAssertNotEqual(buffer, [pool bufferWithLength:2048], @"A buffer of a different length should not be reused.");
+}
+
+-(void)testPoolIsBounded {
+    AZSBlockBufferPool *pool = [[AZSBlockBufferPool alloc] initWithMaximumPooledBytes:2048];
+
+    // Take all three before returning any, so that the pool cannot hand the same buffer out twice.
+    NSMutableData *first = [pool bufferWithLength:1024];
+    NSMutableData *second = [pool bufferWithLength:1024];
+    NSMutableData *third = [pool bufferWithLength:1024];
+    XCTAssertNotEqual(first, second, @"Distinct buffers expected.");
+    XCTAssertNotEqual(second, third, @"Distinct buffers expected.");
+
+    [pool returnBuffer:first];
+    [pool returnBuffer:second];
+    [pool returnBuffer:third];
+    XCTAssertEqual(2048, pool.pooledBytes, @"Pool held more than its maximum.");
+
+    // The third buffer was dropped, so only the first two come back out.
+    NSMutableData *reused1 = [pool bufferWithLength:1024];
+    NSMutableData *reused2 = [pool bufferWithLength:1024];
+    XCTAssertTrue((reused1 == first) || (reused1 == second), @"Pooled buffer was not reused.");
+    XCTAssertTrue((reused2 == first) || (reused2 == second), @"Pooled buffer was not reused.");
+    XCTAssertNotEqual(reused1, reused2, @"The same buffer was pooled twice.");
+    XCTAssertNotEqual(third, [pool bufferWithLength:1024], @"A buffer beyond the pool's limit was kept.");
+    XCTAssertEqual(0, pool.pooledBytes, @"Pooled bytes incorrect after reuse.");
+}
+
+@end
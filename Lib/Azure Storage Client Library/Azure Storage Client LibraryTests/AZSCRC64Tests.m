@@ -0,0 +1,75 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSCRC64Tests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSCRC64.h"
+
+@interface AZSCRC64Tests : XCTestCase
+
+@end
+
+@implementation AZSCRC64Tests
+
+-(NSData *)sampleDataWithLength:(NSUInteger)length {
+    unsigned int seed = 11;
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    uint8_t *bytes = data.mutableBytes;
+    for (NSUInteger i = 0; i < length; i++) {
+        bytes[i] = rand_r(&seed) % 256;
+    }
+    return data;
+}
+
+-(void)testKnownValue {
+    NSData *data = [@"123456789" dataUsingEncoding:NSUTF8StringEncoding];
+    uint64_t crc = [AZSCRC64 crc64FromData:data];
+
+    XCTAssertEqual(0xAE8B14860A799888ULL, crc, @"Incorrect checksum.");
+    XCTAssertEqualObjects(@"iJh5CoYUi64=", [AZSCRC64 stringFromCRC64:crc], @"Incorrect checksum string.");
+    XCTAssertEqual(0ULL, [AZSCRC64 crc64FromData:[NSData data]], @"Checksum of no data should be 0.");
+}
+
+-(void)testIncrementalMatchesWhole {
+    NSData *data = [self sampleDataWithLength:10007];
+    uint64_t wholeCRC = [AZSCRC64 crc64FromData:data];
+
+    // Split at offsets that are not multiples of 8, so both the sliced and the bytewise loops see every alignment.
+    for (NSUInteger split = 0; split < 24; split++) {
+        uint64_t crc = [AZSCRC64 crc64OfBytes:data.bytes length:split crc:0];
+        crc = [AZSCRC64 crc64OfBytes:((const uint8_t *)data.bytes) + split length:(data.length - split) crc:crc];
+        XCTAssertEqual(wholeCRC, crc, @"Incremental checksum does not match at split %lu.", (unsigned long)split);
+    }
+}
+
+-(void)testCombineMatchesWhole {
+    NSData *data = [self sampleDataWithLength:100003];
+    uint64_t wholeCRC = [AZSCRC64 crc64FromData:data];
+
+    NSUInteger blockLengths[] = {1, 4096, 33333, 7, 0, 62566};
+    uint64_t combinedCRC = 0;
+    NSUInteger offset = 0;
+    for (NSUInteger i = 0; i < sizeof(blockLengths) / sizeof(blockLengths[0]); i++) {
+        NSData *block = [data subdataWithRange:NSMakeRange(offset, blockLengths[i])];
+        combinedCRC = [AZSCRC64 crc64ByCombiningCRC64:combinedCRC withCRC64:[AZSCRC64 crc64FromData:block] secondLength:block.length];
+        offset += blockLengths[i];
+    }
+
+    XCTAssertEqual(data.length, offset, @"Test blocks do not cover the data.");
+    XCTAssertEqual(wholeCRC, combinedCRC, @"Combined checksum does not match the checksum of the whole.");
+}
+
+@end
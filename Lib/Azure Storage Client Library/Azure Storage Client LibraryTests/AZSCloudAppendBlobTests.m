@@ -279,4 +279,81 @@
     [semaphore wait];
 }
 
+-(void)testUploadFromStreamWithParallelAppends
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    AZSCloudAppendBlob *appendBlob = [self.blobContainer appendBlobReferenceFromName:@"appendBlob"];
+    unsigned int randSeed = (unsigned int)time(NULL);
+    NSData *sourceData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:(4 * 1024 * 1024)];
+    
+    // Several appends are in flight at once, but the data must still be appended in order.
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.parallelismFactor = 4;
+    options.blockSize = 256 * 1024;
+    
+    [appendBlob uploadFromStream:[NSInputStream inputStreamWithData:sourceData] createNew:YES accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        [appendBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *blobData) {
+            XCTAssertNil(error, @"Error in downloading blob data.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(16, appendBlob.properties.appendBlobCommittedBlockCount.intValue, @"Incorrect block count reported.");
+            XCTAssertTrue([sourceData isEqualToData:blobData], @"Blob data does not match.");
+            [semaphore signal];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testFollowDeliversNewData
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    AZSCloudAppendBlob *appendBlob = [self.blobContainer appendBlobReferenceFromName:@"followedBlob"];
+    NSData *firstData = [@"first record\n" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *secondData = [@"second record\n" dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData *expectedData = [firstData mutableCopy];
+    [expectedData appendData:secondData];
+    
+    [appendBlob createWithCompletionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in creating blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        [appendBlob appendBlockWithData:firstData contentMD5:nil completionHandler:^(NSError *error, NSNumber *appendOffset) {
+            XCTAssertNil(error, @"Error in appending block.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            
+            // A separate reference follows the blob, as another process would.
+            AZSCloudAppendBlob *followedBlob = [self.blobContainer appendBlobReferenceFromName:@"followedBlob"];
+            NSMutableData *receivedData = [NSMutableData data];
+            NSUInteger __block idlePollCount = 0;
+            BOOL __block secondAppended = NO;
+            
+            [followedBlob followFromOffset:0 minimumPollInterval:0.1 maximumPollInterval:0.4 requestOptions:nil operationContext:nil dataHandler:^(NSData *data, unsigned long long offset, BOOL *stop) {
+                XCTAssertEqual(receivedData.length, offset, @"Data delivered at the wrong offset.");
+                [receivedData appendData:data];
+                if (data.length == 0)
+                {
+                    idlePollCount++;
+                }
+                
+                // Once the existing data has been read and the blob has gone idle, append more.
+                if (!secondAppended && idlePollCount > 0)
+                {
+                    secondAppended = YES;
+                    XCTAssertTrue([receivedData isEqualToData:firstData], @"Existing data not delivered.");
+                    [appendBlob appendBlockWithData:secondData contentMD5:nil completionHandler:^(NSError *error, NSNumber *appendOffset) {
+                        XCTAssertNil(error, @"Error in appending block.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    }];
+                }
+                
+                *stop = (receivedData.length >= expectedData.length);
+            } completionHandler:^(NSError *error, unsigned long long offset) {
+                XCTAssertNil(error, @"Error in following blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                XCTAssertEqual(expectedData.length, offset, @"Incorrect final offset.");
+                XCTAssertTrue([receivedData isEqualToData:expectedData], @"Followed data does not match.");
+                [semaphore signal];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
 @end
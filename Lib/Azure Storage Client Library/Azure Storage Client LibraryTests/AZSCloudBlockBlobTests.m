@@ -15,6 +15,7 @@
 // </copyright>
 // -----------------------------------------------------------------------------------------
 
+#import <CommonCrypto/CommonDigest.h>
 #import <XCTest/XCTest.h>
 #import "AZSClient.h"
 #import "AZSBlobTestBase.h"
@@ -22,6 +23,31 @@
 #import "AZSTestHelpers.h"
 #import "AZSTestSemaphore.h"
 #import "AZSUtil.h"
+#import "AZSBlobUploadJournal.h"
+
+// XORs each byte with a fixed key, in place.  Applying it twice restores the data.
+@interface AZSBlockBlobXorStage : NSObject <AZSTransformStage>
+@end
+
+@implementation AZSBlockBlobXorStage
+
+-(BOOL)transformsInPlace
+{
+    return YES;
+}
+
+-(NSData *)transformData:(NSData *)data final:(BOOL)final chain:(AZSTransformChain *)chain error:(NSError **)error
+{
+    NSMutableData *mutableData = (NSMutableData *)data;
+    uint8_t *bytes = mutableData.mutableBytes;
+    for (NSUInteger i = 0; i < mutableData.length; i++)
+    {
+        bytes[i] ^= 0x5a;
+    }
+    return mutableData;
+}
+
+@end
 
 @interface AZSCloudBlockBlobTests : AZSBlobTestBase
 @property NSString *containerName;
@@ -1210,4 +1236,597 @@
     [semaphore wait];
 }
 
-@end
\ No newline at end of file
+-(void)testDownloadRanges
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:100000];
+    
+    // The first two ranges are merged into one request, the third overlaps the first, the fourth is fetched separately, the fifth is empty, and the last runs past the end of the blob.
+    NSArray *ranges = @[[NSValue valueWithAZSULLRange:AZSULLMakeRange(100, 50)],
+                        [NSValue valueWithAZSULLRange:AZSULLMakeRange(200, 1000)],
+                        [NSValue valueWithAZSULLRange:AZSULLMakeRange(120, 10)],
+                        [NSValue valueWithAZSULLRange:AZSULLMakeRange(50000, 20)],
+                        [NSValue valueWithAZSULLRange:AZSULLMakeRange(60000, 0)],
+                        [NSValue valueWithAZSULLRange:AZSULLMakeRange(99990, 100)]];
+    
+    [blockBlob uploadFromData:blobData completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        AZSOperationContext *opCtxt = [[AZSOperationContext alloc] init];
+        [blockBlob downloadRanges:ranges gapThreshold:1024 accessCondition:nil requestOptions:nil operationContext:opCtxt completionHandler:^(NSError *error, NSArray *slices) {
+            XCTAssertNil(error, @"Error in downloading ranges.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(3, opCtxt.requestResults.count, @"Incorrect number of requests issued.");
+            XCTAssertEqual(ranges.count, slices.count, @"Incorrect number of slices returned.");
+            
+            for (NSUInteger i = 0; i < ranges.count; i++)
+            {
+                NSRange range = NSRangeFromAZSULLRange(((NSValue *)ranges[i]).AZSULLRangeValue);
+                range.length = MIN(range.length, blobData.length - range.location);
+                XCTAssertTrue([slices[i] isEqualToData:[blobData subdataWithRange:range]], @"Slice %lu does not match the blob data.", (unsigned long)i);
+            }
+            
+            NSArray *buffers = @[[NSMutableData data], [NSMutableData data], [NSMutableData data], [NSMutableData data], [NSMutableData data], [NSMutableData data]];
+            [blockBlob downloadRanges:ranges intoBuffers:buffers gapThreshold:0 accessCondition:nil requestOptions:nil operationContext:nil completionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in downloading ranges.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                for (NSUInteger i = 0; i < ranges.count; i++)
+                {
+                    XCTAssertTrue([buffers[i] isEqualToData:slices[i]], @"Buffer %lu does not match the blob data.", (unsigned long)i);
+                }
+                [semaphore signal];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testDownloadToSinks
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:3000000];
+    
+    unsigned char expectedDigest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(blobData.bytes, (CC_LONG) blobData.length, expectedDigest);
+    
+    NSOutputStream *targetStream = [NSOutputStream outputStreamToMemory];
+    [targetStream open];
+    AZSOutputStreamDownloadSink *streamSink = [[AZSOutputStreamDownloadSink alloc] initWithStream:targetStream];
+    AZSDigestDownloadSink *digestSink = [[AZSDigestDownloadSink alloc] initWithAlgorithm:AZSDigestAlgorithmSHA256];
+    
+    // A deliberately slow sink, so that the download has to wait on it.
+    NSMutableData *blockSinkData = [NSMutableData data];
+    AZSBlockDownloadSink *slowSink = [[AZSBlockDownloadSink alloc] initWithBlock:^BOOL(NSData *data, NSError **error) {
+        [NSThread sleepForTimeInterval:0.01];
+        [blockSinkData appendData:data];
+        return YES;
+    }];
+    
+    [blockBlob uploadFromData:blobData completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+        options.maximumDownloadBufferSize = 64 * 1024;
+        [blockBlob downloadToSinks:@[streamSink, digestSink, slowSink] AZSULLrange:AZSULLMakeRange(0, 0) accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in downloading blob to sinks.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertTrue([blobData isEqualToData:[targetStream propertyForKey:NSStreamDataWrittenToMemoryStreamKey]], @"Stream sink contents do not match.");
+            XCTAssertTrue([blobData isEqualToData:blockSinkData], @"Block sink contents do not match.");
+            XCTAssertTrue([digestSink.digest isEqualToData:[NSData dataWithBytes:expectedDigest length:CC_SHA256_DIGEST_LENGTH]], @"Digest sink result does not match.");
+            
+            // A failing sink fails the download.
+            AZSBlockDownloadSink *failingSink = [[AZSBlockDownloadSink alloc] initWithBlock:^BOOL(NSData *data, NSError **error) {
+                *error = [NSError errorWithDomain:AZSErrorDomain code:AZSEOutputStreamError userInfo:nil];
+                return NO;
+            }];
+            [blockBlob downloadToSinks:@[failingSink] completionHandler:^(NSError *error) {
+                XCTAssertNotNil(error, @"Download did not fail when a sink failed.");
+                [semaphore signal];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testSingleBlobUploadThreshold
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:2048];
+    
+    // Below the threshold, the upload is a single Put Blob.
+    AZSOperationContext *singleRequestContext = [[AZSOperationContext alloc] init];
+    [blockBlob uploadFromData:blobData accessCondition:nil requestOptions:nil operationContext:singleRequestContext completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        XCTAssertEqual(1, singleRequestContext.requestResults.count, @"Small upload did not use a single request.");
+        
+        // The same applies to uploads from streams.
+        AZSOperationContext *streamContext = [[AZSOperationContext alloc] init];
+        [blockBlob uploadFromStream:[NSInputStream inputStreamWithData:blobData] accessCondition:nil requestOptions:nil operationContext:streamContext completionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(1, streamContext.requestResults.count, @"Small stream upload did not use a single request.");
+            
+            // With a threshold of 0, the upload uses Put Block and Put Block List.
+            AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+            options.singleBlobUploadThreshold = 0;
+            AZSOperationContext *blockContext = [[AZSOperationContext alloc] init];
+            [blockBlob uploadFromData:blobData accessCondition:nil requestOptions:options operationContext:blockContext completionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                XCTAssertEqual(2, blockContext.requestResults.count, @"Upload with a zero threshold did not use blocks.");
+                
+                [blockBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                    XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    XCTAssertTrue([blobData isEqualToData:data], @"Downloaded data does not match.");
+                    [semaphore signal];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testUploadBlockSize
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:(1024 * 1024 + 100)];
+    
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.singleBlobUploadThreshold = 0;
+    options.blockSize = 256 * 1024;
+    [blockBlob uploadFromData:blobData accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        [blockBlob downloadBlockListFromFilter:AZSBlockListFilterCommitted completionHandler:^(NSError *error, NSArray *blockList) {
+            XCTAssertNil(error, @"Error in downloading block list.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(5, blockList.count, @"Incorrect number of blocks for the configured block size.");
+            XCTAssertEqual(256 * 1024, ((AZSBlockListItem *)blockList[0]).size, @"Incorrect block size.");
+            
+            // In automatic mode, every block is within the service limit and the data round-trips.
+            options.blockSize = 0;
+            [blockBlob uploadFromData:blobData accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                
+                [blockBlob downloadBlockListFromFilter:AZSBlockListFilterCommitted completionHandler:^(NSError *error, NSArray *blockList) {
+                    XCTAssertNil(error, @"Error in downloading block list.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    XCTAssertTrue(blockList.count > 1, @"Automatic block size did not split a 1 MB upload.");
+                    for (AZSBlockListItem *block in blockList)
+                    {
+                        XCTAssertTrue(block.size <= 4 * 1024 * 1024, @"Block exceeds the service maximum.");
+                    }
+                    
+                    [blockBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                        XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                        XCTAssertTrue([blobData isEqualToData:data], @"Downloaded data does not match.");
+                        [semaphore signal];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+// Checks that uploading in-memory data as slices stores the same blob as pumping the same data through a stream.
+-(void)testUploadFromDataSlicesMatchesStream
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:(9 * 1024 * 1024 + 11)];
+    NSString *expectedMD5 = [AZSUtil calculateMD5FromData:blobData];
+    
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.storeBlobContentMD5 = YES;
+    
+    // Uploading no-copy slices of the data must store the same blob, block layout and MD5 as uploading it from a stream.
+    [blockBlob uploadFromData:blobData accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        [blockBlob downloadBlockListFromFilter:AZSBlockListFilterCommitted completionHandler:^(NSError *error, NSArray *sliceBlockList) {
+            XCTAssertNil(error, @"Error in downloading block list.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            
+            [blockBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                XCTAssertTrue([blobData isEqualToData:data], @"Downloaded data does not match.");
+                XCTAssertEqualObjects(expectedMD5, blockBlob.properties.contentMD5, @"Stored content MD5 incorrect.");
+                
+                [blockBlob uploadFromStream:[NSInputStream inputStreamWithData:blobData] accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+                    XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    
+                    [blockBlob downloadBlockListFromFilter:AZSBlockListFilterCommitted completionHandler:^(NSError *error, NSArray *streamBlockList) {
+                        XCTAssertNil(error, @"Error in downloading block list.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                        XCTAssertEqual(streamBlockList.count, sliceBlockList.count, @"Slices and stream used different numbers of blocks.");
+                        for (NSUInteger i = 0; i < MIN(streamBlockList.count, sliceBlockList.count); i++)
+                        {
+                            XCTAssertEqual(((AZSBlockListItem *)streamBlockList[i]).size, ((AZSBlockListItem *)sliceBlockList[i]).size, @"Block sizes differ.");
+                        }
+                        
+                        [blockBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                            XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                            XCTAssertTrue([blobData isEqualToData:data], @"Downloaded data does not match.");
+                            XCTAssertEqualObjects(expectedMD5, blockBlob.properties.contentMD5, @"Stored content MD5 incorrect.");
+                            [semaphore signal];
+                        }];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testUploadLargeFileInParallelBlocks
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    NSString *filePath = [[NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]] path];
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *fileData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:(10 * 1024 * 1024 + 7)];
+    XCTAssertTrue([fileData writeToFile:filePath atomically:YES], @"Error in writing initial file.");
+    
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.useTransactionalMD5 = YES;
+    options.storeBlobContentMD5 = YES;
+    options.blockSize = 1024 * 1024;
+    [blockBlob uploadFromFileWithPath:filePath accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading file to a blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        [blockBlob downloadBlockListFromFilter:AZSBlockListFilterCommitted completionHandler:^(NSError *error, NSArray *blockList) {
+            XCTAssertNil(error, @"Error in downloading block list.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(11, blockList.count, @"Incorrect number of blocks.");
+            
+            [blockBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                XCTAssertTrue([fileData isEqualToData:data], @"Downloaded data does not match the file.");
+                XCTAssertEqualObjects([AZSUtil calculateMD5FromData:fileData], blockBlob.properties.contentMD5, @"Stored content MD5 incorrect.");
+                
+                NSError *fileError = nil;
+                [[NSFileManager defaultManager] removeItemAtPath:filePath error:&fileError];
+                XCTAssertNil(fileError, @"Error in deleting initial file.  Error code = %ld, error domain = %@, error userinfo = %@", (long)fileError.code, fileError.domain, fileError.userInfo);
+                [semaphore signal];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testResumeFileUploadFromJournal
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    NSString *filePath = [[NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]] path];
+    NSString *journalPath = [filePath stringByAppendingPathExtension:@"journal"];
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSData *fileData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:(5 * 1024 * 1024 + 7)];
+    XCTAssertTrue([fileData writeToFile:filePath atomically:YES], @"Error in writing initial file.");
+    
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.blockSize = 1024 * 1024;
+    
+    // Simulate an interrupted upload: blocks 0 and 1 are staged and journaled, and block 2 is journaled but was never staged.
+    NSError *journalError = nil;
+    NSDictionary *sourceIdentity = [AZSBlobUploadJournal sourceIdentityForFilePath:filePath attributes:[[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil] blobURL:blockBlob.storageUri.primaryUri];
+    AZSBlobUploadJournal *journal = [AZSBlobUploadJournal journalAtPath:journalPath sourceIdentity:sourceIdentity blockSize:options.blockSize error:&journalError];
+    XCTAssertNotNil(journal, @"Error in creating journal.  Error code = %ld, error domain = %@, error userinfo = %@", (long)journalError.code, journalError.domain, journalError.userInfo);
+    XCTAssertFalse(journal.resumed, @"New journal should not be resumed.");
+    
+    [blockBlob uploadBlockFromData:[fileData subdataWithRange:NSMakeRange(0, 1024 * 1024)] blockID:[journal blockIDForIndex:0] completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading block.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        [blockBlob uploadBlockFromData:[fileData subdataWithRange:NSMakeRange(1024 * 1024, 1024 * 1024)] blockID:[journal blockIDForIndex:1] completionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in uploading block.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertTrue([journal recordBlock:0 error:nil], @"Error in recording block.");
+            XCTAssertTrue([journal recordBlock:1 error:nil], @"Error in recording block.");
+            XCTAssertTrue([journal recordBlock:2 error:nil], @"Error in recording block.");
+            
+            [blockBlob uploadFromFileWithPath:filePath journalPath:journalPath accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in resuming upload.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:journalPath], @"Journal was not removed after the upload completed.");
+                
+                [blockBlob downloadBlockListFromFilter:AZSBlockListFilterCommitted completionHandler:^(NSError *error, NSArray *blockList) {
+                    XCTAssertNil(error, @"Error in downloading block list.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    XCTAssertEqual(6, blockList.count, @"Incorrect number of blocks.");
+                    XCTAssertEqualObjects([journal blockIDForIndex:0], ((AZSBlockListItem *)blockList[0]).blockID, @"Staged block was not reused.");
+                    
+                    [blockBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                        XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                        XCTAssertTrue([fileData isEqualToData:data], @"Downloaded data does not match the file.");
+                        
+                        NSError *fileError = nil;
+                        [[NSFileManager defaultManager] removeItemAtPath:filePath error:&fileError];
+                        XCTAssertNil(fileError, @"Error in deleting initial file.  Error code = %ld, error domain = %@, error userinfo = %@", (long)fileError.code, fileError.domain, fileError.userInfo);
+                        [semaphore signal];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testJournalRejectsInvalidBlockSize
+{
+    NSString *filePath = [[NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]] path];
+    NSString *journalPath = [filePath stringByAppendingPathExtension:@"journal"];
+    XCTAssertTrue([[@"data" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:filePath atomically:YES], @"Error in writing initial file.");
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:AZSCBlob];
+    NSDictionary *sourceIdentity = [AZSBlobUploadJournal sourceIdentityForFilePath:filePath attributes:[[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil] blobURL:blockBlob.storageUri.primaryUri];
+    
+    // A journal written for this file resumes, since its source identity survives being written out and read back.
+    NSError *journalError = nil;
+    AZSBlobUploadJournal *journal = [AZSBlobUploadJournal journalAtPath:journalPath sourceIdentity:sourceIdentity blockSize:1024 error:&journalError];
+    XCTAssertNotNil(journal, @"Error in creating journal.  Error code = %ld, error domain = %@, error userinfo = %@", (long)journalError.code, journalError.domain, journalError.userInfo);
+    XCTAssertTrue([journal recordBlock:0 error:nil], @"Error in recording block.");
+    journal = [AZSBlobUploadJournal journalAtPath:journalPath sourceIdentity:sourceIdentity blockSize:2048 error:&journalError];
+    XCTAssertTrue(journal.resumed, @"Journal for the same file was not resumed.");
+    XCTAssertEqual(1024, journal.blockSize, @"Resumed journal did not keep its block size.");
+    
+    // A damaged header with a zero block size must start a new journal, rather than be resumed.
+    NSDictionary *header = @{@"source":sourceIdentity, @"blockSize":@0, @"blockIDPrefix":@"0123456789abcdef"};
+    NSMutableData *journalData = [[NSJSONSerialization dataWithJSONObject:header options:0 error:nil] mutableCopy];
+    [journalData appendData:[@"\n0\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertTrue([journalData writeToFile:journalPath atomically:YES], @"Error in writing damaged journal.");
+    journal = [AZSBlobUploadJournal journalAtPath:journalPath sourceIdentity:sourceIdentity blockSize:2048 error:&journalError];
+    XCTAssertFalse(journal.resumed, @"Journal with a zero block size was resumed.");
+    XCTAssertEqual(2048, journal.blockSize, @"New journal has the wrong block size.");
+    
+    [journal removeWithError:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+-(void)testUploadFromDataWithDeduplication
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    NSMutableData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:(12 * 1024 * 1024)];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    [blockBlob uploadFromDataWithDeduplication:blobData completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        [blockBlob downloadBlockListFromFilter:AZSBlockListFilterCommitted completionHandler:^(NSError *error, NSArray *originalBlockList) {
+            XCTAssertNil(error, @"Error in downloading block list.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            NSMutableSet *originalBlockIDs = [NSMutableSet setWithCapacity:originalBlockList.count];
+            for (AZSBlockListItem *item in originalBlockList)
+            {
+                [originalBlockIDs addObject:item.blockID];
+            }
+            
+            // Insert a few bytes in the middle; only the blocks around the insertion should change.
+            [blobData replaceBytesInRange:NSMakeRange(blobData.length / 2, 0) withBytes:"edit" length:4];
+            [blockBlob uploadFromDataWithDeduplication:blobData completionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                
+                [blockBlob downloadBlockListFromFilter:AZSBlockListFilterCommitted completionHandler:^(NSError *error, NSArray *blockList) {
+                    XCTAssertNil(error, @"Error in downloading block list.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    NSUInteger newBlocks = 0;
+                    for (AZSBlockListItem *item in blockList)
+                    {
+                        newBlocks += [originalBlockIDs containsObject:item.blockID] ? 0 : 1;
+                    }
+                    XCTAssertTrue(newBlocks <= 3, @"Too many blocks changed: %lu of %lu.", (unsigned long)newBlocks, (unsigned long)blockList.count);
+                    
+                    [blockBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                        XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                        XCTAssertTrue([blobData isEqualToData:data], @"Downloaded data does not match the uploaded data.");
+                        [semaphore signal];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testUploadFromStreamWithTransactionalAndBlobMD5
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    unsigned int seed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&seed length:(6 * 1024 * 1024 + 1000)];
+    
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    // Every block is sent with its own MD5, hashed off the stream's thread, and the blob MD5 is stored on commit.
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.useTransactionalMD5 = YES;
+    options.storeBlobContentMD5 = YES;
+    options.blockSize = 1024 * 1024;
+    options.singleBlobUploadThreshold = 1024 * 1024;
+    options.parallelismFactor = 4;
+    [blockBlob uploadFromStream:[NSInputStream inputStreamWithData:blobData] accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        AZSCloudBlockBlob *downloadBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+        [downloadBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+            XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertTrue([blobData isEqualToData:data], @"Downloaded data does not match the data uploaded.");
+            XCTAssertEqualObjects([AZSUtil calculateMD5FromData:blobData], downloadBlob.properties.contentMD5, @"Stored content MD5 incorrect.");
+            [semaphore signal];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testUploadFromStreamWithContentCRC64
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    unsigned int seed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&seed length:(5 * 1024 * 1024 + 17)];
+    
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.useContentCRC64 = YES;
+    options.blockSize = 1024 * 1024;
+    [blockBlob uploadFromStream:[NSInputStream inputStreamWithData:blobData] accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        AZSCloudBlockBlob *downloadBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+        [downloadBlob downloadToDataWithAccessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error, NSData *data) {
+            XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertTrue([blobData isEqualToData:data], @"Downloaded data does not match the data uploaded.");
+            XCTAssertNotNil(downloadBlob.metadata[AZSCContentCRC64MetadataKey], @"CRC64 was not stored.");
+            
+            // A checksum that doesn't match the data must fail the download.
+            downloadBlob.metadata[AZSCContentCRC64MetadataKey] = @"AAAAAAAAAAA=";
+            [downloadBlob uploadMetadataWithCompletionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in uploading metadata.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                
+                [downloadBlob downloadToDataWithAccessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error, NSData *data) {
+                    XCTAssertNotNil(error, @"Download with a mismatched CRC64 did not fail.");
+                    XCTAssertEqual(AZSECRC64Mismatch, error.code, @"Incorrect error code.");
+                    [semaphore signal];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testUploadFromDataDropsStaleContentCRC64
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    unsigned int seed = (unsigned int)time(NULL);
+    NSData *firstData = [AZSTestHelpers generateSampleDataWithSeed:&seed length:(1024 * 1024)];
+    NSData *secondData = [AZSTestHelpers generateSampleDataWithSeed:&seed length:(1024 * 1024 + 3)];
+    
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    AZSBlobRequestOptions *crcOptions = [[AZSBlobRequestOptions alloc] init];
+    crcOptions.useContentCRC64 = YES;
+    
+    // Uploading in blocks, without a CRC64, must not commit the CRC64 of the earlier contents that the blob object still holds.
+    AZSBlobRequestOptions *blockOptions = [[AZSBlobRequestOptions alloc] init];
+    blockOptions.singleBlobUploadThreshold = 0;
+    blockOptions.blockSize = 256 * 1024;
+    [blockBlob uploadFromData:firstData accessCondition:nil requestOptions:crcOptions operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        [blockBlob downloadAttributesWithCompletionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in downloading attributes.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertNotNil(blockBlob.metadata[AZSCContentCRC64MetadataKey], @"CRC64 was not stored.");
+            
+            [blockBlob uploadFromData:secondData accessCondition:nil requestOptions:blockOptions operationContext:nil completionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                
+                [blockBlob downloadToDataWithAccessCondition:nil requestOptions:crcOptions operationContext:nil completionHandler:^(NSError *error, NSData *data) {
+                    XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    XCTAssertTrue([secondData isEqualToData:data], @"Downloaded data does not match the data uploaded.");
+                    XCTAssertNil(blockBlob.metadata[AZSCContentCRC64MetadataKey], @"Stale CRC64 was committed.");
+                    [semaphore signal];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testUploadFromStreamWithGzipCompression
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    NSMutableString *text = [NSMutableString string];
+    for (int i = 0; i < 40000; i++)
+    {
+        [text appendFormat:@"{\"id\":%d,\"name\":\"record %d\",\"active\":%@}\n", i, i % 97, (i % 3) ? @"true" : @"false"];
+    }
+    NSData *blobData = [text dataUsingEncoding:NSUTF8StringEncoding];
+    
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    AZSBlobRequestOptions *options = [[AZSBlobRequestOptions alloc] init];
+    options.contentCompression = AZSContentCompressionGzip;
+    options.blockSize = 64 * 1024;
+    options.storeBlobContentMD5 = YES;
+    options.useContentCRC64 = YES;
+    [blockBlob uploadFromStream:[NSInputStream inputStreamWithData:blobData] accessCondition:nil requestOptions:options operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        AZSCloudBlockBlob *downloadBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+        [downloadBlob downloadAttributesWithCompletionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in downloading attributes.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqualObjects(AZSCContentEncodingGzip, downloadBlob.properties.contentEncoding, @"Content encoding was not set.");
+            XCTAssertTrue(downloadBlob.properties.length.unsignedLongLongValue < blobData.length, @"Stored blob was not compressed.");
+            
+            // The checksums describe the compressed bytes, so they must not fail the download of the decoded body.
+            AZSOperationContext *downloadContext = [[AZSOperationContext alloc] init];
+            [downloadBlob downloadToDataWithAccessCondition:nil requestOptions:options operationContext:downloadContext completionHandler:^(NSError *error, NSData *data) {
+                XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                NSHTTPURLResponse *response = ((AZSRequestResult *)downloadContext.requestResults.lastObject).response;
+                XCTAssertEqualObjects(AZSCContentEncodingGzip, response.allHeaderFields[AZSCContentEncoding], @"Response was not gzip encoded.");
+                XCTAssertEqual(downloadBlob.properties.length.longLongValue, [response.allHeaderFields[@"Content-Length"] longLongValue], @"Response length is not the compressed length.");
+                XCTAssertTrue([blobData isEqualToData:data], @"Decompressed data does not match the data uploaded.");
+                [semaphore signal];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+-(void)testUploadAndDownloadWithTransformChains
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    unsigned int seed = (unsigned int)time(NULL);
+    NSData *blobData = [AZSTestHelpers generateSampleDataWithSeed:&seed length:(3 * 1024 * 1024 + 5)];
+    
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudBlockBlob *blockBlob = [self.blobContainer blockBlobReferenceFromName:blobName];
+    
+    AZSTransformChain *uploadChain = [[AZSTransformChain alloc] initWithStages:@[[[AZSBlockBlobXorStage alloc] init]]];
+    AZSBlobRequestOptions *uploadOptions = [[AZSBlobRequestOptions alloc] init];
+    uploadOptions.uploadTransformChain = uploadChain;
+    uploadOptions.blockSize = 1024 * 1024;
+    [blockBlob uploadFromStream:[NSInputStream inputStreamWithData:blobData] accessCondition:nil requestOptions:uploadOptions operationContext:nil completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        AZSTransformStageStatistics *uploadStatistics = uploadChain.statistics[0];
+        XCTAssertEqual(blobData.length, uploadStatistics.bytesIn, @"Upload stage did not see all the data.");
+        
+        [blockBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+            XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(blobData.length, data.length, @"Stored blob length incorrect.");
+            XCTAssertFalse([blobData isEqualToData:data], @"Stored blob was not transformed.");
+            
+            AZSTransformChain *downloadChain = [[AZSTransformChain alloc] initWithStages:@[[[AZSBlockBlobXorStage alloc] init]]];
+            AZSBlobRequestOptions *downloadOptions = [[AZSBlobRequestOptions alloc] init];
+            downloadOptions.downloadTransformChain = downloadChain;
+            [blockBlob downloadToDataWithAccessCondition:nil requestOptions:downloadOptions operationContext:nil completionHandler:^(NSError *error, NSData *data) {
+                XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                XCTAssertTrue([blobData isEqualToData:data], @"Transformed download does not match the data uploaded.");
+                XCTAssertEqual(blobData.length, ((AZSTransformStageStatistics *)downloadChain.statistics[0]).bytesOut, @"Download stage did not see all the data.");
+                [semaphore signal];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+@end
@@ -391,6 +391,59 @@
     [semaphore wait];
 }
 
+-(void)testUploadSparseFile
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    
+    // Data in pages 3 and 9-10; everything else is zero.
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    NSMutableData *fileData = [NSMutableData dataWithLength:40*self.pageSize];
+    memset(((uint8_t *)fileData.mutableBytes) + 3*self.pageSize + 100, 'a', 10);
+    memset(((uint8_t *)fileData.mutableBytes) + 9*self.pageSize, 'b', 2*self.pageSize);
+    XCTAssertTrue([fileData writeToFile:filePath atomically:YES], @"Error in writing initial file.");
+    
+    AZSCloudPageBlob *pageBlob = [self.blobContainer pageBlobReferenceFromName:@"pageBlob"];
+    [pageBlob createFromFileWithPath:filePath completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in uploading file.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        [pageBlob downloadPageRangesWithCompletionHandler:^(NSError *error, NSArray *results) {
+            XCTAssertNil(error, @"Error in downloading page ranges.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            XCTAssertEqual(2, results.count, @"Zero pages were written.");
+            XCTAssertEqual(3*self.pageSize, (((NSValue *)results[0]).rangeValue).location, @"Incorrect page range returned.");
+            XCTAssertEqual(9*self.pageSize, (((NSValue *)results[1]).rangeValue).location, @"Incorrect page range returned.");
+            XCTAssertEqual(2*self.pageSize, (((NSValue *)results[1]).rangeValue).length, @"Incorrect page range returned.");
+            
+            // Overwrite with a longer file where page 3 is now zero, and pages 20 and 44 have data.  Page 3 must be cleared, and the
+            // blob grown to fit page 44.
+            memset(((uint8_t *)fileData.mutableBytes) + 3*self.pageSize, 0, self.pageSize);
+            memset(((uint8_t *)fileData.mutableBytes) + 20*self.pageSize, 'c', 5);
+            [fileData setLength:48*self.pageSize];
+            memset(((uint8_t *)fileData.mutableBytes) + 44*self.pageSize, 'd', 7);
+            XCTAssertTrue([fileData writeToFile:filePath atomically:YES], @"Error in writing modified file.");
+            
+            [pageBlob uploadFromFileWithPath:filePath completionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in uploading file.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                
+                [pageBlob downloadPageRangesWithCompletionHandler:^(NSError *error, NSArray *results) {
+                    XCTAssertNil(error, @"Error in downloading page ranges.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    XCTAssertEqual(3, results.count, @"Incorrect number of page ranges downloaded.");
+                    XCTAssertEqual(9*self.pageSize, (((NSValue *)results[0]).rangeValue).location, @"Incorrect page range returned.");
+                    XCTAssertEqual(20*self.pageSize, (((NSValue *)results[1]).rangeValue).location, @"Incorrect page range returned.");
+                    XCTAssertEqual(44*self.pageSize, (((NSValue *)results[2]).rangeValue).location, @"Incorrect page range returned.");
+                    
+                    [pageBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                        XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                        XCTAssertTrue([fileData isEqualToData:data], @"Downloaded data does not match the file.");
+                        [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+                        [semaphore signal];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
 -(void)testResize
 {
     AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
@@ -0,0 +1,82 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSContentDefinedChunkerTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSContentDefinedChunker.h"
+
+@interface AZSContentDefinedChunkerTests : XCTestCase
+
+@end
+
+@implementation AZSContentDefinedChunkerTests
+
+-(NSMutableData *)sampleDataWithLength:(NSUInteger)length {
+    unsigned int seed = 7;
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    uint8_t *bytes = data.mutableBytes;
+    for (NSUInteger i = 0; i < length; i++) {
+        bytes[i] = rand_r(&seed) % 256;
+    }
+    return data;
+}
+
+-(NSSet *)chunksOfData:(NSData *)data ranges:(NSArray *)ranges {
+    NSMutableSet *chunks = [NSMutableSet setWithCapacity:ranges.count];
+    for (NSValue *range in ranges) {
+        [chunks addObject:[data subdataWithRange:range.rangeValue]];
+    }
+    return chunks;
+}
+
+-(void)testChunksCoverDataWithinBounds {
+    AZSContentDefinedChunker *chunker = [[AZSContentDefinedChunker alloc] initWithMinimumChunkSize:1024 averageChunkSize:4096 maximumChunkSize:16384];
+    NSData *data = [self sampleDataWithLength:1024 * 1024 + 13];
+
+    NSArray *ranges = [chunker chunkRangesForData:data];
+    NSUInteger expectedLocation = 0;
+    for (NSUInteger i = 0; i < ranges.count; i++) {
+        NSRange range = [ranges[i] rangeValue];
+        XCTAssertEqual(expectedLocation, range.location, @"Chunks are not contiguous.");
+        XCTAssertTrue(range.length <= 16384, @"Chunk larger than the maximum.");
+        if (i < ranges.count - 1) {
+            XCTAssertTrue(range.length >= 1024, @"Chunk smaller than the minimum.");
+        }
+        expectedLocation = NSMaxRange(range);
+    }
+    XCTAssertEqual(data.length, expectedLocation, @"Chunks do not cover the data.");
+
+    // Boundaries are content-defined, so most chunks should end before the maximum size.
+    XCTAssertTrue(ranges.count > data.length / 16384 * 2, @"Too few chunks; boundaries are not being found.");
+    XCTAssertEqualObjects(ranges, [chunker chunkRangesForData:data], @"Chunking is not deterministic.");
+}
+
+-(void)testInsertionOnlyChangesNearbyChunks {
+    AZSContentDefinedChunker *chunker = [[AZSContentDefinedChunker alloc] initWithMinimumChunkSize:1024 averageChunkSize:4096 maximumChunkSize:16384];
+    NSMutableData *data = [self sampleDataWithLength:1024 * 1024];
+    NSSet *originalChunks = [self chunksOfData:data ranges:[chunker chunkRangesForData:data]];
+
+    uint8_t insertedBytes[] = {1, 2, 3, 4, 5};
+    [data replaceBytesInRange:NSMakeRange(data.length / 2, 0) withBytes:insertedBytes length:sizeof(insertedBytes)];
+    NSArray *modifiedRanges = [chunker chunkRangesForData:data];
+    NSMutableSet *newChunks = [[self chunksOfData:data ranges:modifiedRanges] mutableCopy];
+    [newChunks minusSet:originalChunks];
+
+    // With fixed-size blocks, every block after the insertion would change.
+    XCTAssertTrue(newChunks.count <= 3, @"Insertion changed %lu chunks.", (unsigned long)newChunks.count);
+}
+
+@end
@@ -0,0 +1,70 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSMemoryGovernorTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSMemoryGovernor.h"
+
+@interface AZSMemoryGovernorTests : XCTestCase
+
+@end
+
+@implementation AZSMemoryGovernorTests
+
+-(void)testReserveAndRelease {
+    AZSMemoryGovernor *governor = [[AZSMemoryGovernor alloc] initWithMaximumBytes:1000];
+
+    XCTAssertEqual(400, [governor reserveBytes:400 minimumBytes:400], @"Full reservation not granted.");
+    XCTAssertEqual(400, governor.reservedBytes, @"Reserved bytes incorrect.");
+
+    // Only 600 bytes remain, so a request that can shrink gets what's left.
+    XCTAssertEqual(600, [governor reserveBytes:800 minimumBytes:100], @"Reservation did not shrink to the remaining budget.");
+    XCTAssertEqual(1000, governor.reservedBytes, @"Reserved bytes incorrect.");
+
+    [governor releaseBytes:600];
+    [governor releaseBytes:400];
+    XCTAssertEqual(0, governor.reservedBytes, @"Reserved bytes incorrect after release.");
+    XCTAssertEqual(1000, governor.peakReservedBytes, @"Peak reserved bytes incorrect.");
+    XCTAssertEqual(0, governor.waitCount, @"No reservation should have waited.");
+}
+
+-(void)testOversizedReservationIsClamped {
+    AZSMemoryGovernor *governor = [[AZSMemoryGovernor alloc] initWithMaximumBytes:1000];
+
+    XCTAssertEqual(1000, [governor reserveBytes:5000 minimumBytes:5000], @"Oversized reservation was not clamped to the budget.");
+    [governor releaseBytes:1000];
+    XCTAssertEqual(0, governor.reservedBytes, @"Reserved bytes incorrect after release.");
+}
+
+-(void)testReservationBlocksUntilReleased {
+    AZSMemoryGovernor *governor = [[AZSMemoryGovernor alloc] initWithMaximumBytes:1000];
+    [governor reserveBytes:900 minimumBytes:900];
+
+    dispatch_semaphore_t reservedSemaphore = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [governor reserveBytes:500 minimumBytes:500];
+        dispatch_semaphore_signal(reservedSemaphore);
+    });
+
+    XCTAssertNotEqual(0, dispatch_semaphore_wait(reservedSemaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.2 * NSEC_PER_SEC))), @"Reservation did not block when the budget was exhausted.");
+
+    [governor releaseBytes:900];
+    XCTAssertEqual(0, dispatch_semaphore_wait(reservedSemaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(5 * NSEC_PER_SEC))), @"Reservation did not proceed after memory was released.");
+    XCTAssertEqual(500, governor.reservedBytes, @"Reserved bytes incorrect.");
+    XCTAssertEqual(1, governor.waitCount, @"Wait count incorrect.");
+}
+
+@end
@@ -0,0 +1,125 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSPageBlobWriterTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSBlobTestBase.h"
+#import "AZSClient.h"
+#import "AZSPageBlobWriter.h"
+#import "AZSConstants.h"
+#import "AZSTestHelpers.h"
+#import "AZSTestSemaphore.h"
+
+@interface AZSPageBlobWriterTests : AZSBlobTestBase
+@property NSString *containerName;
+@property AZSCloudBlobContainer *blobContainer;
+@end
+
+@implementation AZSPageBlobWriterTests
+
+- (void)setUp
+{
+    [super setUp];
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    self.containerName = [NSString stringWithFormat:@"sampleioscontainer%@", [AZSTestHelpers uniqueName]];
+
+    self.blobContainer = [self.blobClient containerReferenceFromName:self.containerName];
+    [self.blobContainer createContainerIfNotExistsWithCompletionHandler:^(NSError *error, BOOL exists) {
+        XCTAssertNil(error, @"Error in test setup, in creating container.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        [semaphore signal];
+    }];
+    [semaphore wait];
+}
+
+- (void)tearDown
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+
+    AZSCloudBlobContainer *blobContainer = [self.blobClient containerReferenceFromName:self.containerName];
+    [blobContainer deleteContainerIfExistsWithCompletionHandler:^(NSError * error, BOOL exists) {
+        [semaphore signal];
+    }];
+    [semaphore wait];
+    [super tearDown];
+}
+
+-(void)testCoalescedWrites
+{
+    AZSTestSemaphore *semaphore = [[AZSTestSemaphore alloc] init];
+    NSString *blobName = [NSString stringWithFormat:@"sampleblob%@", [AZSTestHelpers uniqueName]];
+    AZSCloudPageBlob *pageBlob = [self.blobContainer pageBlobReferenceFromName:blobName];
+    
+    NSUInteger blobLength = 1024 * 1024;
+    NSMutableData *expectedData = [NSMutableData dataWithLength:blobLength];
+    unsigned int __block randSeed = (unsigned int)time(NULL);
+    
+    [pageBlob createWithSize:[NSNumber numberWithUnsignedInteger:blobLength] completionHandler:^(NSError *error) {
+        XCTAssertNil(error, @"Error in creating blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+        
+        AZSPageBlobWriter *writer = [[AZSPageBlobWriter alloc] initWithBlob:pageBlob maximumDirtyBytes:blobLength requestOptions:nil operationContext:nil];
+        writer.flushInterval = 0;
+        [writer openWithCompletionHandler:^(NSError *error) {
+            XCTAssertNil(error, @"Error in opening writer.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+            
+            NSError *writeError = nil;
+            XCTAssertFalse([writer writeData:[NSData dataWithBytes:"a" length:1] atOffset:0 error:&writeError], @"Unaligned write was accepted.");
+            XCTAssertEqual(AZSEInvalidArgument, writeError.code, @"Incorrect error code.");
+            
+            // Out-of-order 4 KB writes covering the first 256 KB, then an overwrite spanning two of them, and a separate run further on.
+            NSMutableArray *writes = [NSMutableArray array];
+            for (NSUInteger i = 0; i < 64; i++)
+            {
+                [writes addObject:[NSNumber numberWithUnsignedInteger:((i * 37) % 64) * 4096]];
+            }
+            [writes addObject:[NSNumber numberWithUnsignedInteger:(6 * 4096 + 2048)]];
+            [writes addObject:[NSNumber numberWithUnsignedInteger:(512 * 1024)]];
+            for (NSNumber *offset in writes)
+            {
+                NSData *data = [AZSTestHelpers generateSampleDataWithSeed:&randSeed length:4096];
+                XCTAssertTrue([writer writeData:data atOffset:offset.unsignedLongLongValue error:&writeError], @"Write failed.  Error = %@", writeError);
+                [expectedData replaceBytesInRange:NSMakeRange(offset.unsignedIntegerValue, data.length) withBytes:data.bytes];
+            }
+            XCTAssertEqual(256 * 1024 + 4096, writer.dirtyBytes, @"Overlapping writes were not merged.");
+            
+            [writer flushWithCompletionHandler:^(NSError *error) {
+                XCTAssertNil(error, @"Error in flushing writer.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                XCTAssertEqual(2, writer.requestCount, @"Writes were not coalesced.");
+                XCTAssertEqual(66, writer.writeCount, @"Incorrect write count.");
+                XCTAssertEqual(0, writer.dirtyBytes, @"Cache was not emptied.");
+                
+                [pageBlob downloadToDataWithCompletionHandler:^(NSError *error, NSData *data) {
+                    XCTAssertNil(error, @"Error in downloading blob.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                    XCTAssertTrue([expectedData isEqualToData:data], @"Blob contents do not match the writes.");
+                    
+                    // Another writer takes over by changing the sequence number; this writer's uploads must now fail.
+                    [pageBlob setSequenceNumberWithNumber:[NSNumber numberWithLongLong:(writer.sequenceNumber.longLongValue + 1)] useMaximum:NO completionHandler:^(NSError *error) {
+                        XCTAssertNil(error, @"Error in setting sequence number.  Error code = %ld, error domain = %@, error userinfo = %@", (long)error.code, error.domain, error.userInfo);
+                        NSError *writeError = nil;
+                        XCTAssertTrue([writer writeData:[NSMutableData dataWithLength:512] atOffset:0 error:&writeError], @"Write failed.  Error = %@", writeError);
+                        [writer flushWithCompletionHandler:^(NSError *error) {
+                            XCTAssertNotNil(error, @"Flush after the sequence number changed did not fail.");
+                            XCTAssertEqual(412, ((NSNumber *)error.userInfo[AZSCHttpStatusCode]).integerValue, @"Incorrect HTTP status code.");
+                            [semaphore signal];
+                        }];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [semaphore wait];
+}
+
+@end
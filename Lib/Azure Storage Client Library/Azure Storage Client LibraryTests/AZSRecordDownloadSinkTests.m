@@ -0,0 +1,78 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSRecordDownloadSinkTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSDownloadSink.h"
+#import "AZSErrors.h"
+
+@interface AZSRecordDownloadSinkTests : XCTestCase
+
+@end
+
+@implementation AZSRecordDownloadSinkTests
+
+-(NSArray *)recordsFromText:(NSString *)text delimiter:(NSString *)delimiter chunkSize:(NSUInteger)chunkSize {
+    NSMutableArray *records = [NSMutableArray array];
+    AZSRecordDownloadSink *sink = [[AZSRecordDownloadSink alloc] initWithDelimiter:[delimiter dataUsingEncoding:NSUTF8StringEncoding] maximumBatchSize:2 batchHandler:^(NSArray *batch, BOOL *stop) {
+        XCTAssertTrue(batch.count <= 2, @"Batch larger than the maximum batch size.");
+        for (NSData *record in batch)
+        {
+            [records addObject:[[NSString alloc] initWithData:record encoding:NSUTF8StringEncoding]];
+        }
+    }];
+
+    NSData *data = [text dataUsingEncoding:NSUTF8StringEncoding];
+    for (NSUInteger offset = 0; offset < data.length; offset += chunkSize) {
+        NSError *error = nil;
+        XCTAssertTrue([sink consumeData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkSize, data.length - offset))] error:&error], @"Consuming data failed.");
+    }
+    [sink finish];
+
+    XCTAssertEqual(records.count, sink.recordCount, @"Record count incorrect.");
+    return records;
+}
+
+-(void)testRecordsAcrossChunkBoundaries {
+    NSString *text = @"alpha\r\nbeta\r\n\r\ngamma-delta\r\nepsilon";
+    NSArray *expected = @[@"alpha", @"beta", @"", @"gamma-delta", @"epsilon"];
+
+    // Every chunk size splits records, and for a two-byte delimiter, the delimiter itself, at different places.
+    for (NSUInteger chunkSize = 1; chunkSize <= text.length; chunkSize++) {
+        XCTAssertEqualObjects(expected, [self recordsFromText:text delimiter:@"\r\n" chunkSize:chunkSize], @"Records incorrect for chunk size %lu.", (unsigned long)chunkSize);
+    }
+}
+
+-(void)testTrailingDelimiter {
+    NSArray *expected = @[@"one", @"two"];
+    XCTAssertEqualObjects(expected, [self recordsFromText:@"one\ntwo\n" delimiter:@"\n" chunkSize:3], @"A trailing delimiter should not produce an extra record.");
+}
+
+-(void)testStop {
+    NSMutableArray *records = [NSMutableArray array];
+    AZSRecordDownloadSink *sink = [[AZSRecordDownloadSink alloc] initWithDelimiter:[@"\n" dataUsingEncoding:NSUTF8StringEncoding] maximumBatchSize:1 batchHandler:^(NSArray *batch, BOOL *stop) {
+        [records addObjectsFromArray:batch];
+        *stop = YES;
+    }];
+
+    NSError *error = nil;
+    XCTAssertFalse([sink consumeData:[@"a\nb\nc\n" dataUsingEncoding:NSUTF8StringEncoding] error:&error], @"Consuming data after stopping should fail.");
+    XCTAssertEqual(AZSEOperationCanceled, error.code, @"Incorrect error code.");
+    XCTAssertEqual(1, records.count, @"Records were delivered after stopping.");
+    XCTAssertTrue(sink.stopped, @"Sink not marked as stopped.");
+}
+
+@end
@@ -0,0 +1,74 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSSparsePageScannerTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSSparsePageScanner.h"
+
+@interface AZSSparsePageScannerTests : XCTestCase
+
+@end
+
+@implementation AZSSparsePageScannerTests
+
+-(void)testNonZeroPagesAreMergedAndSplit {
+    NSMutableData *data = [NSMutableData dataWithLength:20 * 512 + 100];
+    uint8_t *bytes = data.mutableBytes;
+    bytes[2 * 512 + 511] = 1;
+    memset(bytes + 5 * 512, 2, 4 * 512);
+    bytes[20 * 512 + 99] = 3;
+
+    NSArray *extents = @[[NSValue valueWithAZSULLRange:AZSULLMakeRange(0, data.length)]];
+    NSArray *ranges = [AZSSparsePageScanner nonZeroPageRangesInData:data extents:extents maximumRangeLength:3 * 512];
+
+    XCTAssertEqual(4, ranges.count, @"Incorrect number of ranges.");
+    XCTAssertTrue(AZSULLEqualRanges(AZSULLMakeRange(2 * 512, 512), ((NSValue *)ranges[0]).AZSULLRangeValue), @"Incorrect range.");
+    XCTAssertTrue(AZSULLEqualRanges(AZSULLMakeRange(5 * 512, 3 * 512), ((NSValue *)ranges[1]).AZSULLRangeValue), @"Run was not split at the maximum length.");
+    XCTAssertTrue(AZSULLEqualRanges(AZSULLMakeRange(8 * 512, 512), ((NSValue *)ranges[2]).AZSULLRangeValue), @"Incorrect range.");
+    XCTAssertTrue(AZSULLEqualRanges(AZSULLMakeRange(20 * 512, 100), ((NSValue *)ranges[3]).AZSULLRangeValue), @"Final partial page incorrect.");
+}
+
+-(void)testExtentsLimitScanning {
+    NSMutableData *data = [NSMutableData dataWithLength:10 * 512];
+    memset(data.mutableBytes, 1, data.length);
+
+    // Unaligned extents are widened to whole pages.
+    NSArray *extents = @[[NSValue valueWithAZSULLRange:AZSULLMakeRange(600, 10)], [NSValue valueWithAZSULLRange:AZSULLMakeRange(4 * 512, 1024)]];
+    NSArray *ranges = [AZSSparsePageScanner nonZeroPageRangesInData:data extents:extents maximumRangeLength:4 * 1024 * 1024];
+
+    XCTAssertEqual(2, ranges.count, @"Incorrect number of ranges.");
+    XCTAssertTrue(AZSULLEqualRanges(AZSULLMakeRange(512, 512), ((NSValue *)ranges[0]).AZSULLRangeValue), @"Incorrect range.");
+    XCTAssertTrue(AZSULLEqualRanges(AZSULLMakeRange(4 * 512, 1024), ((NSValue *)ranges[1]).AZSULLRangeValue), @"Incorrect range.");
+
+    NSArray *complement = [AZSSparsePageScanner rangesComplementingRanges:ranges length:data.length];
+    XCTAssertEqual(3, complement.count, @"Incorrect number of complementary ranges.");
+    XCTAssertTrue(AZSULLEqualRanges(AZSULLMakeRange(1024, 1024), ((NSValue *)complement[1]).AZSULLRangeValue), @"Incorrect complementary range.");
+}
+
+-(void)testDataExtentsCoverFile {
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    NSMutableData *data = [NSMutableData dataWithLength:64 * 1024];
+    memset(data.mutableBytes, 1, 512);
+    XCTAssertTrue([data writeToFile:filePath atomically:YES], @"Error in writing file.");
+
+    // Whether or not the file system reports holes, the data must lie within the extents.
+    NSArray *extents = [AZSSparsePageScanner dataExtentsOfFileAtPath:filePath length:data.length];
+    XCTAssertTrue(extents.count > 0, @"No data extents found.");
+    XCTAssertEqual(0, ((NSValue *)extents[0]).AZSULLRangeValue.location, @"The start of the file is not data.");
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+@end
@@ -0,0 +1,145 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSTransformChainTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSTransformChain.h"
+#import "AZSErrors.h"
+
+// XORs each byte with a key, in place.
+@interface AZSTestXorStage : NSObject <AZSTransformStage>
+@end
+
+@implementation AZSTestXorStage
+
+-(BOOL)transformsInPlace {
+    return YES;
+}
+
+-(NSData *)transformData:(NSData *)data final:(BOOL)final chain:(AZSTransformChain *)chain error:(NSError **)error {
+    NSMutableData *mutableData = (NSMutableData *)data;
+    uint8_t *bytes = mutableData.mutableBytes;
+    for (NSUInteger i = 0; i < mutableData.length; i++) {
+        bytes[i] ^= 0x5a;
+    }
+    return mutableData;
+}
+
+@end
+
+// Holds all data back until the final slice, then returns it in a pooled buffer.
+@interface AZSTestHoldingStage : NSObject <AZSTransformStage>
+@property (strong) NSMutableData *heldData;
+@end
+
+@implementation AZSTestHoldingStage
+
+-(NSData *)transformData:(NSData *)data final:(BOOL)final chain:(AZSTransformChain *)chain error:(NSError **)error {
+    if (!self.heldData) {
+        self.heldData = [NSMutableData data];
+    }
+    [self.heldData appendData:data];
+    if (!final) {
+        return [NSData data];
+    }
+    
+    NSMutableData *output = [chain outputBufferWithLength:self.heldData.length];
+    memcpy(output.mutableBytes, self.heldData.bytes, self.heldData.length);
+    return output;
+}
+
+@end
+
+// Always fails.
+@interface AZSTestFailingStage : NSObject <AZSTransformStage>
+@end
+
+@implementation AZSTestFailingStage
+
+-(NSData *)transformData:(NSData *)data final:(BOOL)final chain:(AZSTransformChain *)chain error:(NSError **)error {
+    *error = [NSError errorWithDomain:@"AZSTestDomain" code:42 userInfo:nil];
+    return nil;
+}
+
+@end
+
+@interface AZSTransformChainTests : XCTestCase
+
+@end
+
+@implementation AZSTransformChainTests
+
+-(void)testInPlaceStageOnMutableData {
+    AZSTransformChain *chain = [[AZSTransformChain alloc] initWithStages:@[[[AZSTestXorStage alloc] init]]];
+    NSMutableData *data = [NSMutableData dataWithBytes:"abc" length:3];
+    
+    NSError *error = nil;
+    NSData *output = [chain transformData:data mutable:YES final:NO error:&error];
+    XCTAssertNil(error, @"Transform failed.");
+    XCTAssertTrue(output == data, @"Mutable data was not transformed in place.");
+    XCTAssertEqual(('a' ^ 0x5a), ((const uint8_t *)output.bytes)[0], @"Data was not transformed.");
+}
+
+-(void)testInPlaceStageCopiesImmutableData {
+    AZSTransformChain *chain = [[AZSTransformChain alloc] initWithStages:@[[[AZSTestXorStage alloc] init], [[AZSTestXorStage alloc] init]]];
+    NSData *data = [NSData dataWithBytes:"abcdef" length:6];
+    
+    NSError *error = nil;
+    NSData *output = [chain transformData:data mutable:NO final:NO error:&error];
+    XCTAssertNil(error, @"Transform failed.");
+    XCTAssertFalse(output == data, @"Immutable data was modified.");
+    XCTAssertEqualObjects(data, output, @"Applying the XOR twice should restore the data.");
+    [chain recycleBuffer:output];
+    
+    for (AZSTransformStageStatistics *statistics in chain.statistics) {
+        XCTAssertEqual(1, statistics.sliceCount, @"Slice count incorrect.");
+        XCTAssertEqual(6, statistics.bytesIn, @"Bytes in incorrect.");
+        XCTAssertEqual(6, statistics.bytesOut, @"Bytes out incorrect.");
+        XCTAssertTrue(statistics.cpuTime >= 0, @"CPU time should not be negative.");
+    }
+}
+
+-(void)testStageHoldingDataBack {
+    AZSTestHoldingStage *holdingStage = [[AZSTestHoldingStage alloc] init];
+    AZSTransformChain *chain = [[AZSTransformChain alloc] initWithStages:@[holdingStage, [[AZSTestXorStage alloc] init]]];
+    
+    NSError *error = nil;
+    NSData *output = [chain transformData:[NSData dataWithBytes:"abc" length:3] mutable:NO final:NO error:&error];
+    XCTAssertEqual(0, output.length, @"Held data was returned early.");
+    output = [chain transformData:[NSData dataWithBytes:"def" length:3] mutable:NO final:NO error:&error];
+    XCTAssertEqual(0, output.length, @"Held data was returned early.");
+    output = [chain transformData:[NSData data] mutable:NO final:YES error:&error];
+    XCTAssertNil(error, @"Transform failed.");
+    XCTAssertEqual(6, output.length, @"Held data was not returned by the final slice.");
+    XCTAssertEqual(('f' ^ 0x5a), ((const uint8_t *)output.bytes)[5], @"Data was not transformed.");
+    
+    AZSTransformStageStatistics *holdingStatistics = chain.statistics[0];
+    XCTAssertEqual(3, holdingStatistics.sliceCount, @"Slice count incorrect.");
+    XCTAssertEqual(6, holdingStatistics.bytesIn, @"Bytes in incorrect.");
+    XCTAssertEqual(6, holdingStatistics.bytesOut, @"Bytes out incorrect.");
+}
+
+-(void)testFailingStage {
+    AZSTransformChain *chain = [[AZSTransformChain alloc] initWithStages:@[[[AZSTestXorStage alloc] init], [[AZSTestFailingStage alloc] init]]];
+    
+    NSError *error = nil;
+    NSData *output = [chain transformData:[NSData dataWithBytes:"abc" length:3] mutable:NO final:NO error:&error];
+    XCTAssertNil(output, @"Failed transform returned data.");
+    XCTAssertEqual(AZSETransformError, error.code, @"Incorrect error code.");
+    XCTAssertEqual(42, ((NSError *)error.userInfo[AZSInnerErrorString]).code, @"Stage error was not included.");
+}
+
+@end
@@ -0,0 +1,136 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="AZSULLRangeSetTests.m" company="Microsoft">
+//    Copyright 2015 Microsoft Corporation
+//
+//    Licensed under the MIT License;
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://spdx.org/licenses/MIT
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#import <XCTest/XCTest.h>
+#import "AZSULLRangeSet.h"
+
+@interface AZSULLRangeSetTests : XCTestCase
+
+@end
+
+@implementation AZSULLRangeSetTests
+
+-(AZSULLRangeSet *)rangeSetWithLocationsAndLengths:(NSArray *)locationsAndLengths {
+    AZSULLRangeSet *rangeSet = [[AZSULLRangeSet alloc] init];
+    for (NSUInteger i = 0; i + 1 < locationsAndLengths.count; i += 2) {
+        [rangeSet addRange:AZSULLMakeRange([locationsAndLengths[i] unsignedLongLongValue], [locationsAndLengths[i + 1] unsignedLongLongValue])];
+    }
+    return rangeSet;
+}
+
+-(void)assertRangeSet:(AZSULLRangeSet *)rangeSet equals:(AZSULLRangeSet *)expected {
+    XCTAssertEqualObjects(expected, rangeSet, @"Range sets do not match.");
+    XCTAssertEqual(expected.totalLength, rangeSet.totalLength, @"Total length incorrect.");
+}
+
+-(void)testAddMergesOverlappingAndAdjacentRanges {
+    AZSULLRangeSet *rangeSet = [[AZSULLRangeSet alloc] init];
+    [rangeSet addRange:AZSULLMakeRange(100, 10)];
+    [rangeSet addRange:AZSULLMakeRange(0, 10)];
+    [rangeSet addRange:AZSULLMakeRange(50, 10)];
+    [rangeSet addRange:AZSULLMakeRange(200, 0)];
+    XCTAssertEqual(3, rangeSet.count, @"Incorrect range count.");
+    XCTAssertEqual(30, rangeSet.totalLength, @"Incorrect total length.");
+
+    // Touches the first range, and overlaps the second.
+    [rangeSet addRange:AZSULLMakeRange(10, 45)];
+    [self assertRangeSet:rangeSet equals:[self rangeSetWithLocationsAndLengths:@[@0, @60, @100, @10]]];
+
+    // Spans everything.
+    [rangeSet addRange:AZSULLMakeRange(5, 200)];
+    [self assertRangeSet:rangeSet equals:[self rangeSetWithLocationsAndLengths:@[@0, @205]]];
+}
+
+-(void)testInitSortsAndCoalesces {
+    AZSULLRange ranges[] = { AZSULLMakeRange(40, 10), AZSULLMakeRange(0, 5), AZSULLMakeRange(3, 4), AZSULLMakeRange(20, 0), AZSULLMakeRange(50, 1) };
+    AZSULLRangeSet *rangeSet = [[AZSULLRangeSet alloc] initWithRanges:ranges count:5];
+    [self assertRangeSet:rangeSet equals:[self rangeSetWithLocationsAndLengths:@[@0, @7, @40, @11]]];
+
+    AZSULLRangeSet *fromValues = [[AZSULLRangeSet alloc] initWithRangeValues:rangeSet.rangeValues];
+    [self assertRangeSet:fromValues equals:rangeSet];
+    [self assertRangeSet:[rangeSet copy] equals:rangeSet];
+}
+
+-(void)testRemoveTrimsAndSplits {
+    AZSULLRangeSet *rangeSet = [self rangeSetWithLocationsAndLengths:@[@0, @100, @200, @100, @400, @100]];
+
+    // Splits the first range.
+    [rangeSet removeRange:AZSULLMakeRange(40, 20)];
+    [self assertRangeSet:rangeSet equals:[self rangeSetWithLocationsAndLengths:@[@0, @40, @60, @40, @200, @100, @400, @100]]];
+
+    // Trims the end of one range, removes another entirely, and trims the start of a third.
+    [rangeSet removeRange:AZSULLMakeRange(80, 350)];
+    [self assertRangeSet:rangeSet equals:[self rangeSetWithLocationsAndLengths:@[@0, @40, @60, @20, @430, @70]]];
+
+    // Removing a gap changes nothing.
+    [rangeSet removeRange:AZSULLMakeRange(100, 300)];
+    [self assertRangeSet:rangeSet equals:[self rangeSetWithLocationsAndLengths:@[@0, @40, @60, @20, @430, @70]]];
+
+    [rangeSet removeAllRanges];
+    XCTAssertEqual(0, rangeSet.count, @"Ranges not removed.");
+    XCTAssertEqual(0, rangeSet.totalLength, @"Total length not reset.");
+}
+
+-(void)testSetOperations {
+    AZSULLRangeSet *first = [self rangeSetWithLocationsAndLengths:@[@0, @10, @20, @10, @40, @10]];
+    AZSULLRangeSet *second = [self rangeSetWithLocationsAndLengths:@[@5, @20, @45, @100]];
+
+    AZSULLRangeSet *unionSet = [first copy];
+    [unionSet unionRangeSet:second];
+    [self assertRangeSet:unionSet equals:[self rangeSetWithLocationsAndLengths:@[@0, @30, @40, @105]]];
+
+    AZSULLRangeSet *intersection = [first copy];
+    [intersection intersectRangeSet:second];
+    [self assertRangeSet:intersection equals:[self rangeSetWithLocationsAndLengths:@[@5, @5, @20, @5, @45, @5]]];
+
+    AZSULLRangeSet *difference = [first copy];
+    [difference subtractRangeSet:second];
+    [self assertRangeSet:difference equals:[self rangeSetWithLocationsAndLengths:@[@0, @5, @25, @5, @40, @5]]];
+
+    [self assertRangeSet:[unionSet rangeSetByIntersectingRange:AZSULLMakeRange(25, 20)] equals:[self rangeSetWithLocationsAndLengths:@[@25, @5, @40, @5]]];
+}
+
+-(void)testQueries {
+    AZSULLRangeSet *rangeSet = [self rangeSetWithLocationsAndLengths:@[@10, @10, @30, @10]];
+
+    XCTAssertFalse([rangeSet containsLocation:9], @"Location before the set reported as contained.");
+    XCTAssertTrue([rangeSet containsLocation:10], @"Start of range not contained.");
+    XCTAssertTrue([rangeSet containsLocation:19], @"End of range not contained.");
+    XCTAssertFalse([rangeSet containsLocation:20], @"Location after a range reported as contained.");
+
+    XCTAssertTrue([rangeSet containsRange:AZSULLMakeRange(32, 8)], @"Range not contained.");
+    XCTAssertFalse([rangeSet containsRange:AZSULLMakeRange(15, 20)], @"Range spanning a gap reported as contained.");
+    XCTAssertTrue([rangeSet intersectsRange:AZSULLMakeRange(15, 20)], @"Overlapping range reported as not intersecting.");
+    XCTAssertFalse([rangeSet intersectsRange:AZSULLMakeRange(20, 10)], @"Range in a gap reported as intersecting.");
+
+    XCTAssertEqual(0, [rangeSet indexOfRangeEndingAfterLocation:0], @"Incorrect index.");
+    XCTAssertEqual(1, [rangeSet indexOfRangeEndingAfterLocation:20], @"Incorrect index.");
+    XCTAssertEqual(2, [rangeSet indexOfRangeEndingAfterLocation:40], @"Incorrect index.");
+}
+
+-(void)testManyRangesAppendedInOrder {
+    AZSULLRangeSet *rangeSet = [[AZSULLRangeSet alloc] init];
+    for (uint64_t i = 0; i < 200000; i++) {
+        [rangeSet addRange:AZSULLMakeRange(i * 1024, 512)];
+    }
+    XCTAssertEqual(200000, rangeSet.count, @"Incorrect range count.");
+    XCTAssertEqual(200000 * 512, rangeSet.totalLength, @"Incorrect total length.");
+    XCTAssertTrue([rangeSet containsLocation:(123456 * 1024) + 100], @"Location not found.");
+    XCTAssertFalse([rangeSet containsLocation:(123456 * 1024) + 600], @"Location in a gap found.");
+}
+
+@end